@@ -0,0 +1,232 @@
+// Compares the stored benchmark results of two commits and flags the
+// metrics whose change is significant, not just different.
+//
+//   ./build/GLBenchCompare [bench-results.jsonl] [--baseline <commit>] [--candidate <commit>]
+//                          [--machine <fingerprint>] [--build-type <type>]
+//                          [--threshold <percent>] [--confidence <0..1>]
+//
+// A commit measured from a tree with local changes is <commit>+dirty and
+// compares as a build of its own. Without commits the last one stored is the
+// candidate and the one before it the baseline. Every stored record is one
+// run, repeated runs give the tighter intervals. Exits with 1 when a metric
+// regressed.
+
+#include "Renderer/Results.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace renderer;
+
+namespace {
+
+constexpr unsigned int RESAMPLES = 2000;
+
+double median(std::vector<double> values) {
+    if (values.empty())
+        return 0.0;
+
+    const size_t middle = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + middle, values.end());
+    return values[middle];
+}
+
+// Frames of one run are correlated, so they are resampled in blocks, and runs
+// are resampled as a whole first: a single run can't claim the confidence of
+// its frame count.
+double resampledMedian(const std::vector<std::vector<double>>& runs, std::mt19937& random) {
+    std::uniform_int_distribution<size_t> pick_run(0, runs.size() - 1);
+
+    double sum = 0.0;
+    std::vector<double> resampled;
+
+    for (size_t r = 0; r < runs.size(); r++) {
+        const std::vector<double>& run = runs[pick_run(random)];
+        const size_t block = std::max<size_t>(1, static_cast<size_t>(std::sqrt(run.size())));
+        std::uniform_int_distribution<size_t> pick_block(0, run.size() - 1);
+
+        resampled.clear();
+        while (resampled.size() < run.size()) {
+            const size_t start = pick_block(random);
+            for (size_t i = 0; i < block && resampled.size() < run.size(); i++)
+                resampled.push_back(run[(start + i) % run.size()]);
+        }
+
+        sum += median(resampled);
+    }
+
+    return sum / runs.size();
+}
+
+double centralValue(const std::vector<std::vector<double>>& runs) {
+    double sum = 0.0;
+    for (const std::vector<double>& run : runs)
+        sum += median(run);
+    return sum / runs.size();
+}
+
+struct Metric {
+    std::string unit;
+    std::vector<std::vector<double>> baseline, candidate;
+};
+
+}
+
+int main(int argc, char* argv[])
+{
+    std::string path = results::DEFAULT_STORE;
+    std::string baseline, candidate, machine, buildType;
+    double threshold = 0.0;
+    double confidence = 0.95;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (arg == "--baseline" && has_value)
+            baseline = argv[++i];
+        else if (arg == "--candidate" && has_value)
+            candidate = argv[++i];
+        else if (arg == "--machine" && has_value)
+            machine = argv[++i];
+        else if (arg == "--build-type" && has_value)
+            buildType = argv[++i];
+        else if (arg == "--threshold" && has_value)
+            threshold = std::stod(argv[++i]) / 100.0;
+        else if (arg == "--confidence" && has_value)
+            confidence = std::clamp(std::stod(argv[++i]), 0.5, 0.999);
+        else if (arg[0] != '-')
+            path = arg;
+        else {
+            std::cerr << "usage: " << argv[0] << " [results.jsonl] [--baseline <commit>] [--candidate <commit>]"
+                " [--machine <fingerprint>] [--build-type <type>] [--threshold <percent>] [--confidence <0..1>]"
+                << std::endl;
+            return 2;
+        }
+    }
+
+    std::vector<results::Entry> entries;
+    if (!results::load(path, entries))
+        return 2;
+
+    // timings from different machines or build types never compare, the newest entry decides by default
+    if (machine.empty() && !entries.empty())
+        machine = entries.back().context.machine;
+    if (buildType.empty() && !entries.empty())
+        buildType = entries.back().context.buildType;
+
+    const auto comparable = [&](const results::Entry& entry) {
+        return entry.context.machine == machine && entry.context.buildType == buildType;
+    };
+
+    // ordered by their latest run, a build measured again becomes the newest
+    std::vector<std::string> commits;
+    for (const results::Entry& entry : entries) {
+        if (!comparable(entry))
+            continue;
+
+        const std::string id = results::buildId(entry.context);
+        std::erase(commits, id);
+        commits.push_back(id);
+    }
+
+    if (candidate.empty() && !commits.empty())
+        candidate = commits.back();
+    if (baseline.empty()) {
+        for (auto it = commits.rbegin(); it != commits.rend(); ++it) {
+            if (*it != candidate) {
+                baseline = *it;
+                break;
+            }
+        }
+    }
+
+    if (baseline.empty() || candidate.empty()) {
+        std::cerr << "ERROR::COMPARE::NEEDS_TWO_COMMITS::machine " << machine << ", build type " << buildType << std::endl;
+        return 2;
+    }
+
+    std::map<std::string, Metric> metrics;
+    for (const results::Entry& entry : entries) {
+        if (!comparable(entry) || entry.record.samples.empty())
+            continue;
+
+        const std::string key = entry.record.suite + " " + entry.record.name;
+        const std::string id = results::buildId(entry.context);
+        if (id == baseline)
+            metrics[key].baseline.push_back(entry.record.samples);
+        else if (id == candidate)
+            metrics[key].candidate.push_back(entry.record.samples);
+        else
+            continue;
+
+        metrics[key].unit = entry.record.unit;
+    }
+
+    std::cout << "baseline " << baseline << ", candidate " << candidate << ", machine " << machine
+        << ", " << buildType << " build, " << confidence * 100.0 << "% intervals" << std::endl;
+
+    std::cout << std::left << std::setw(52) << "metric" << std::right
+        << std::setw(12) << "baseline" << std::setw(12) << "candidate"
+        << std::setw(9) << "change" << std::setw(22) << "interval" << std::setw(8) << "runs" << "  verdict" << std::endl;
+
+    std::mt19937 random(42);
+    const double tail = (1.0 - confidence) / 2.0;
+    unsigned int regressions = 0;
+
+    for (const auto& [name, metric] : metrics) {
+        if (metric.baseline.empty() || metric.candidate.empty())
+            continue;
+
+        const double base = centralValue(metric.baseline);
+        const double cand = centralValue(metric.candidate);
+
+        std::vector<double> changes;
+        changes.reserve(RESAMPLES);
+        for (unsigned int i = 0; i < RESAMPLES; i++) {
+            const double b = resampledMedian(metric.baseline, random);
+            const double c = resampledMedian(metric.candidate, random);
+            if (b > 0.0)
+                changes.push_back(c / b - 1.0);
+        }
+
+        if (changes.empty() || base <= 0.0)
+            continue;
+
+        std::sort(changes.begin(), changes.end());
+        const double low = changes[static_cast<size_t>(tail * (changes.size() - 1))];
+        const double high = changes[static_cast<size_t>((1.0 - tail) * (changes.size() - 1))];
+
+        // every stored metric is a time, lower is better
+        std::string verdict = "unchanged";
+        if (low > threshold) {
+            verdict = "REGRESSION";
+            regressions++;
+        } else if (high < -threshold) {
+            verdict = "improvement";
+        }
+
+        std::ostringstream interval;
+        interval << std::fixed << std::setprecision(1) << "[" << low * 100.0 << "%, " << high * 100.0 << "%]";
+
+        std::cout << std::left << std::setw(52) << name << std::right << std::fixed << std::setprecision(3)
+            << std::setw(9) << base << " " << std::setw(2) << metric.unit
+            << std::setw(9) << cand << " " << std::setw(2) << metric.unit
+            << std::setprecision(1) << std::setw(8) << (cand / base - 1.0) * 100.0 << "%"
+            << std::setw(22) << interval.str()
+            << std::setw(4) << metric.baseline.size() << "/" << std::left << std::setw(3) << metric.candidate.size()
+            << std::right << "  " << verdict << std::endl;
+    }
+
+    if (regressions > 0)
+        std::cout << regressions << " significant regression(s)" << std::endl;
+
+    return regressions > 0 ? 1 : 0;
+}
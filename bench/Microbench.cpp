@@ -0,0 +1,323 @@
+// CPU microbenchmarks of the loader and submission hot paths. GL calls go to
+// the same surfaceless context --headless uses, so no GPU is needed.
+//
+//   ./build/GLRendererBench [--filter <substring>] [--min-time <ms>] [--output <file.json>]
+//                           [--store <results.jsonl> | --no-store]
+
+#include "Core/Shapes/Sphere.hpp"
+#include "Core/Vertex.hpp"
+#include "Model/Model.hpp"
+#include "Renderer/Renderer.hpp"
+#include "Renderer/Results.hpp"
+#include "Renderer/Window.hpp"
+#include "Lighting/SpotLight.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace renderer;
+
+namespace {
+
+struct Result {
+    std::string name;
+    uint64_t iterations;
+    // per call of the benchmark body, median of the repetitions
+    double ns;
+    double minNs, maxNs;
+    // vertices, uniforms or lights handled per call
+    uint64_t items;
+    // ns per call of every repetition, in the order they ran
+    std::vector<double> samples;
+};
+
+constexpr unsigned int REPETITIONS = 5;
+
+// keeps results alive so the optimizer can't drop the work producing them
+volatile size_t g_Sink = 0;
+
+double g_MinTimeNs = 50e6;
+std::string g_Filter;
+std::vector<Result> g_Results;
+
+double nowNs() {
+    using namespace std::chrono;
+    return duration<double, std::nano>(steady_clock::now().time_since_epoch()).count();
+}
+
+// doubles the iterations until a batch takes min time, then times REPETITIONS batches
+void measure(const std::string& name, uint64_t items, const std::function<void()>& body) {
+    if (!g_Filter.empty() && name.find(g_Filter) == std::string::npos)
+        return;
+
+    uint64_t iterations = 1;
+    for (;;) {
+        const double start = nowNs();
+        for (uint64_t i = 0; i < iterations; i++)
+            body();
+        const double elapsed = nowNs() - start;
+
+        if (elapsed >= g_MinTimeNs / REPETITIONS || iterations >= (1ull << 30))
+            break;
+
+        iterations *= elapsed > 0.0
+            ? std::clamp<uint64_t>(static_cast<uint64_t>(g_MinTimeNs / REPETITIONS / elapsed) + 1, 2, 10)
+            : 10;
+    }
+
+    std::vector<double> samples;
+    for (unsigned int r = 0; r < REPETITIONS; r++) {
+        const double start = nowNs();
+        for (uint64_t i = 0; i < iterations; i++)
+            body();
+        samples.push_back((nowNs() - start) / iterations);
+    }
+
+    std::vector<double> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+
+    Result result {name, iterations, sorted[REPETITIONS / 2], sorted.front(), sorted.back(), items, samples};
+    g_Results.push_back(result);
+
+    std::cout << std::left << std::setw(48) << name << std::right << std::fixed << std::setprecision(1)
+        << std::setw(14) << result.ns << " ns" << std::setw(12) << iterations << " it" << std::endl;
+}
+
+// a mesh as Assimp hands it over, with every attribute processMesh() reads
+void fillMesh(aiMesh& mesh, unsigned int vertices) {
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> value(-1.f, 1.f);
+
+    const auto fill = [&](unsigned int count) {
+        aiVector3D* array = new aiVector3D[count];
+        for (unsigned int i = 0; i < count; i++)
+            array[i] = aiVector3D(value(random), value(random), value(random));
+        return array;
+    };
+
+    mesh.mNumVertices = vertices;
+    mesh.mVertices = fill(vertices);
+    mesh.mNormals = fill(vertices);
+    mesh.mTangents = fill(vertices);
+    mesh.mBitangents = fill(vertices);
+    mesh.mTextureCoords[0] = fill(vertices);
+    mesh.mNumUVComponents[0] = 2;
+}
+
+std::vector<Vertex> triangleSoup(unsigned int vertices) {
+    std::mt19937 random(2);
+    std::uniform_real_distribution<float> value(-1.f, 1.f);
+
+    std::vector<Vertex> soup(vertices);
+    for (Vertex& vertex : soup) {
+        vertex.Position = glm::vec3(value(random), value(random), value(random));
+        vertex.TexCoords = glm::vec2(value(random), value(random));
+    }
+    return soup;
+}
+
+// half point, half spot lights scattered around the camera
+void fillLights(unsigned int count) {
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> position(-30.f, 30.f);
+    std::uniform_real_distribution<float> color(0.f, 4.f);
+
+    const Attenuation attenuation {1.f, 0.09f, 0.032f};
+
+    g_Lights.clear();
+    for (unsigned int i = 0; i < count; i++) {
+        const glm::vec3 at(position(random), position(random) * .2f, position(random));
+        const glm::vec3 rgb(color(random), color(random), color(random));
+
+        if (i % 2 == 0)
+            g_Lights.push_back(PointLight::New(at, attenuation, rgb * .05f, rgb, rgb));
+        else
+            g_Lights.push_back(SpotLight::New(at, glm::vec3(0.f, -1.f, 0.f), attenuation, rgb, 12.5f, 17.5f));
+    }
+}
+
+void loaderBenchmarks() {
+    for (unsigned int vertices : {10000u, 100000u}) {
+        aiMesh mesh;
+        fillMesh(mesh, vertices);
+
+        measure("Model::convertVertices/" + std::to_string(vertices), vertices, [&] {
+            g_Sink += Model::convertVertices(&mesh).size();
+        });
+    }
+
+    for (unsigned int vertices : {3000u, 300000u}) {
+        std::vector<Vertex> soup = triangleSoup(vertices);
+
+        measure("generateNormals/" + std::to_string(vertices), vertices, [&] {
+            g_Sink += generateNormals(soup).size();
+        });
+        measure("generateTangentBitangents/" + std::to_string(vertices), vertices, [&] {
+            g_Sink += generateTangentBitangents(soup).size();
+        });
+    }
+
+    for (unsigned int segments : {32u, 128u}) {
+        const uint64_t vertices = (segments + 1) * (segments + 1);
+
+        measure("genSphereVertices/" + std::to_string(segments), vertices, [&] {
+            g_Sink += genSphereVertices(segments, segments).size();
+        });
+    }
+}
+
+void submissionBenchmarks() {
+    Shader::Ptr shader = Shader::New("./src/GLSL/Phong.vert.glsl", "./src/GLSL/Phong.frag.glsl");
+    Shader::finishAll();
+    shader->use();
+
+    // the per light members sendLightUniforms() sets, every array element
+    std::vector<std::string> names;
+    for (unsigned int i = 0; i < NR_MAX_LIGHTS; i++) {
+        for (const char* member : {".position", ".ambient", ".diffuse", ".specular"})
+            names.push_back("pointLights[" + std::to_string(i) + "]" + member);
+    }
+
+    const glm::vec3 value(.5f);
+
+    measure("uniforms/setVec3/uncached", names.size(), [&] {
+        for (const std::string& name : names)
+            shader->setVec3(name, value);
+    });
+
+    std::vector<GLint> locations;
+    for (const std::string& name : names)
+        locations.push_back(glGetUniformLocation(shader->ID, name.c_str()));
+
+    measure("uniforms/setVec3/cached", names.size(), [&] {
+        for (GLint location : locations)
+            glUniform3fv(location, 1, &value[0]);
+    });
+
+    g_SunLight = DirectionalLight::New(
+        g_Engine.LIGHT_DIR,
+        g_Engine.LIGHT_AMBIENT,
+        g_Engine.LIGHT_DIFFUSE,
+        g_Engine.LIGHT_SPECULAR
+    );
+
+    camera::g_Camera.Position = glm::vec3(0.f, 2.f, 0.f);
+
+    // the shader light arrays hold NR_MAX_LIGHTS, lights past them are never uploaded
+    fillLights(NR_MAX_LIGHTS);
+
+    measure("sendLightUniforms/" + std::to_string(NR_MAX_LIGHTS), NR_MAX_LIGHTS, [&] {
+        sendLightUniforms(shader);
+    });
+
+    // CPU only, so it scales past the shader limit
+    for (unsigned int lights : {10u, 100u, 1000u}) {
+        fillLights(lights);
+
+        measure("pointShadowCandidates/" + std::to_string(lights), lights, [&] {
+            g_Sink += pointShadowCandidates(g_Engine.POINT_SHADOW_BUDGET).size();
+        });
+    }
+
+    glFinish();
+    g_Lights.clear();
+    g_SunLight = nullptr;
+}
+
+std::string glString(GLenum name) {
+    const GLubyte* value = glGetString(name);
+    std::string result = value ? reinterpret_cast<const char*>(value) : "";
+    std::replace(result.begin(), result.end(), '"', '\'');
+    return result;
+}
+
+bool writeReport(const std::string& path) {
+    std::ofstream out(path);
+    if (!out)
+        return false;
+
+    out << std::fixed << std::setprecision(2);
+    out << "{\n";
+    out << "  \"context\": {\"gl_renderer\": \"" << glString(GL_RENDERER)
+        << "\", \"gl_version\": \"" << glString(GL_VERSION)
+        << "\", \"repetitions\": " << REPETITIONS << "},\n";
+    out << "  \"benchmarks\": [\n";
+
+    for (size_t i = 0; i < g_Results.size(); i++) {
+        const Result& result = g_Results[i];
+        out << "    {\"name\": \"" << result.name << "\""
+            << ", \"iterations\": " << result.iterations
+            << ", \"ns_per_op\": " << result.ns
+            << ", \"min_ns\": " << result.minNs
+            << ", \"max_ns\": " << result.maxNs
+            << ", \"items_per_op\": " << result.items
+            << ", \"items_per_second\": " << (result.ns > 0.0 ? result.items * 1e9 / result.ns : 0.0)
+            << "}" << (i + 1 < g_Results.size() ? "," : "") << "\n";
+    }
+
+    out << "  ]\n";
+    out << "}\n";
+    return out.good();
+}
+
+bool storeResults(const std::string& path) {
+    std::vector<results::Record> records;
+    for (const Result& result : g_Results)
+        records.push_back({"microbench", result.name, "ns", result.samples});
+
+    return results::append(path, results::context(glString(GL_RENDERER)), records);
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    std::string output = "microbench.json";
+    std::string store = results::DEFAULT_STORE;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (arg == "--filter" && has_value)
+            g_Filter = argv[++i];
+        else if (arg == "--min-time" && has_value)
+            g_MinTimeNs = std::stod(argv[++i]) * 1e6;
+        else if (arg == "--output" && has_value)
+            output = argv[++i];
+        else if (arg == "--store" && has_value)
+            store = argv[++i];
+        else if (arg == "--no-store")
+            store.clear();
+        else {
+            std::cerr << "usage: " << argv[0] << " [--filter <substring>] [--min-time <ms>] [--output <file.json>]"
+                " [--store <results.jsonl> | --no-store]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (window::init(true, 64, 64) != 0)
+        return -1;
+
+    loaderBenchmarks();
+    submissionBenchmarks();
+
+    const bool written = writeReport(output);
+    if (!written)
+        std::cerr << "ERROR::MICROBENCH::REPORT_NOT_WRITTEN::" << output << std::endl;
+
+    if (!store.empty())
+        storeResults(store);
+
+    window::terminate();
+
+    return written ? 0 : -1;
+}
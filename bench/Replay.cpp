@@ -0,0 +1,187 @@
+// Replays a GL capture written by GLRenderer --capture, without the renderer,
+// and reports the time every frame took to submit and to finish on the GPU.
+//
+//   ./build/GLReplay <file.glcapture> [--headless] [--loops N] [--report <file.json>]
+
+#include "Core/Capture.hpp"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+GLFWwindow* g_Window = nullptr;
+
+void present() {
+    glfwSwapBuffers(g_Window);
+    glfwPollEvents();
+}
+
+// same contexts as window::init(), at the size the capture was made at
+bool createContext(bool headless, unsigned int width, unsigned int height) {
+    if (headless)
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+
+    if (!glfwInit())
+        return false;
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_COCOA_RETINA_FRAMEBUFFER, GLFW_FALSE);
+#endif
+
+    if (headless) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+        g_Window = glfwCreateWindow(width, height, "GLReplay", NULL, NULL);
+
+        if (g_Window == NULL) {
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+            g_Window = glfwCreateWindow(width, height, "GLReplay", NULL, NULL);
+        }
+    } else
+        g_Window = glfwCreateWindow(width, height, "GLReplay", NULL, NULL);
+
+    if (g_Window == NULL)
+        return false;
+
+    glfwMakeContextCurrent(g_Window);
+    glfwSwapInterval(0);
+
+    return gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+}
+
+struct Distribution {
+    double mean, p50, p95, p99, max;
+};
+
+Distribution distribution(std::vector<double> samples) {
+    if (samples.empty())
+        return {};
+
+    std::sort(samples.begin(), samples.end());
+
+    const auto percentile = [&](double p) {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()))];
+    };
+
+    double sum = 0.0;
+    for (double sample : samples)
+        sum += sample;
+
+    return {sum / samples.size(), percentile(.5), percentile(.95), percentile(.99), samples.back()};
+}
+
+bool writeReport(const std::string& path, const std::string& capture, const CaptureReplayer& replayer,
+                 unsigned int loops, const std::vector<CaptureReplayer::Frame>& frames) {
+    std::ofstream out(path);
+    if (!out)
+        return false;
+
+    const GLubyte* value = glGetString(GL_RENDERER);
+    std::string renderer = value ? reinterpret_cast<const char*>(value) : "";
+    std::replace(renderer.begin(), renderer.end(), '"', '\'');
+
+    std::vector<double> submit, finish;
+    for (const CaptureReplayer::Frame& frame : frames) {
+        submit.push_back(frame.submitMs);
+        finish.push_back(frame.finishMs);
+    }
+
+    const auto write = [&](const char* name, const Distribution& d) {
+        out << "  \"" << name << "\": {\"mean\": " << d.mean << ", \"p50\": " << d.p50
+            << ", \"p95\": " << d.p95 << ", \"p99\": " << d.p99 << ", \"max\": " << d.max << "}";
+    };
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\n";
+    out << "  \"capture\": \"" << capture << "\",\n";
+    out << "  \"gl_renderer\": \"" << renderer << "\",\n";
+    out << "  \"width\": " << replayer.getWidth() << ", \"height\": " << replayer.getHeight() << ",\n";
+    out << "  \"loops\": " << loops << ", \"frames\": " << frames.size() << ",\n";
+    out << "  \"calls\": " << replayer.getCallCount() << ", \"skipped\": " << replayer.getSkippedCount() << ",\n";
+    write("submit_ms", distribution(submit));
+    out << ",\n";
+    write("frame_ms", distribution(finish));
+    out << "\n}\n";
+
+    return out.good();
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    std::string capture;
+    bool headless = false;
+    unsigned int loops = 1;
+    std::string report = "replay.json";
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (arg == "--headless")
+            headless = true;
+        else if (arg == "--loops" && has_value)
+            loops = std::max(1ul, std::stoul(argv[++i]));
+        else if (arg == "--report" && has_value)
+            report = argv[++i];
+        else if (capture.empty() && arg[0] != '-')
+            capture = arg;
+        else {
+            capture.clear();
+            break;
+        }
+    }
+
+    if (capture.empty()) {
+        std::cerr << "usage: " << argv[0] << " <file.glcapture> [--headless] [--loops N] [--report <file.json>]" << std::endl;
+        return 1;
+    }
+
+    CaptureReplayer replayer;
+    if (!replayer.load(capture))
+        return -1;
+
+    if (!createContext(headless, replayer.getWidth(), replayer.getHeight())) {
+        std::cerr << "ERROR::REPLAY::CONTEXT_NOT_CREATED" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    replayer.prepare();
+
+    // later loops draw the same frames again on the resources the first created
+    std::vector<CaptureReplayer::Frame> frames;
+    for (unsigned int loop = 0; loop < loops; loop++) {
+        const std::vector<CaptureReplayer::Frame> played = replayer.replayFrames(headless ? nullptr : present);
+        frames.insert(frames.end(), played.begin(), played.end());
+    }
+
+    std::vector<double> finish;
+    for (const CaptureReplayer::Frame& played : frames)
+        finish.push_back(played.finishMs);
+    const Distribution frame = distribution(finish);
+
+    std::cout << std::fixed << std::setprecision(3) << "REPLAY::" << frames.size() << " frames, "
+        << replayer.getCallCount() << " calls, " << replayer.getSkippedCount() << " skipped, "
+        << frame.mean << " ms mean, " << frame.p95 << " ms p95" << std::endl;
+
+    const bool written = writeReport(report, capture, replayer, loops, frames);
+    if (!written)
+        std::cerr << "ERROR::REPLAY::REPORT_NOT_WRITTEN::" << report << std::endl;
+
+    glfwTerminate();
+
+    return written ? 0 : -1;
+}
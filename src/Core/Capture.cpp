@@ -0,0 +1,608 @@
+#include "Capture.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+// function names as template arguments, so each recorder knows its entry
+template<size_t N>
+struct Name {
+    char value[N];
+    constexpr Name(const char (&name)[N]) { std::copy_n(name, N, value); }
+};
+
+template<Name name, typename F>
+struct Recorder;
+
+template<Name name, typename R, typename... A>
+struct Recorder<name, R (APIENTRYP)(A...)> {
+    static R APIENTRY call(A... args) {
+        using F = R (APIENTRYP)(A...);
+
+        static const unsigned int index = Capture::indexOf(name.value);
+        const F real = reinterpret_cast<F>(Capture::getFunctions()[index].real);
+        const uint64_t words[] = {Capture::toWord(args)..., 0};
+
+        // after the call, so the names it generated are known
+        if constexpr (std::is_void_v<R>) {
+            real(args...);
+            Capture::record(index, words, 0);
+        } else {
+            const R result = real(args...);
+            Capture::record(index, words, Capture::toWord(result));
+            return result;
+        }
+    }
+};
+
+template<typename F>
+struct Playback;
+
+template<typename R, typename... A>
+struct Playback<R (APIENTRYP)(A...)> {
+    constexpr static uint8_t SIZES[] = {static_cast<uint8_t>(sizeof(A))..., 0};
+
+    template<size_t... I>
+    static uint64_t call(void* function, [[maybe_unused]] const uint64_t* words, std::index_sequence<I...>) {
+        const auto fn = reinterpret_cast<R (APIENTRYP)(A...)>(function);
+
+        if constexpr (std::is_void_v<R>) {
+            fn(Capture::fromWord<A>(words[I])...);
+            return 0;
+        } else {
+            return Capture::toWord(fn(Capture::fromWord<A>(words[I])...));
+        }
+    }
+
+    static uint64_t call(void* function, const uint64_t* words) {
+        static_assert(sizeof...(A) <= Capture::MAX_ARGUMENTS);
+        return call(function, words, std::index_sequence_for<A...>());
+    }
+};
+
+// GL_UNPACK_ALIGNMENT as last set by the app
+unsigned int g_UnpackAlignment = 4;
+
+size_t bufferData(const uint64_t* w) { return w[1]; }
+size_t bufferSubData(const uint64_t* w) { return w[2]; }
+size_t texImage2D(const uint64_t* w) { return Capture::imageSize(w[3], w[4], 1, w[6], w[7], g_UnpackAlignment); }
+size_t texImage3D(const uint64_t* w) { return Capture::imageSize(w[3], w[4], w[5], w[7], w[8], g_UnpackAlignment); }
+size_t texSubImage2D(const uint64_t* w) { return Capture::imageSize(w[4], w[5], 1, w[6], w[7], g_UnpackAlignment); }
+// large enough for any pack alignment
+size_t readPixels(const uint64_t* w) { return Capture::imageSize(w[2], w[3], 1, w[4], w[5], 8); }
+size_t texParameterfv(const uint64_t* w) { return w[1] == GL_TEXTURE_BORDER_COLOR ? 4 * sizeof(GLfloat) : sizeof(GLfloat); }
+size_t drawBuffers(const uint64_t* w) { return static_cast<uint32_t>(w[0]) * sizeof(GLenum); }
+size_t programBinary(const uint64_t* w) { return static_cast<uint32_t>(w[3]); }
+
+// count is the second argument of every vector and matrix uniform call
+template<unsigned int COMPONENTS>
+size_t uniformv(const uint64_t* w) { return static_cast<uint32_t>(w[1]) * COMPONENTS * 4; }
+
+Capture::Sizer sizerFor(const std::string& name) {
+    static const std::unordered_map<std::string, Capture::Sizer> sizers = {
+        {"glBufferData", bufferData},
+        {"glBufferSubData", bufferSubData},
+        {"glTexImage2D", texImage2D},
+        {"glTexImage3D", texImage3D},
+        {"glTexSubImage2D", texSubImage2D},
+        {"glReadPixels", readPixels},
+        {"glTexParameterfv", texParameterfv},
+        {"glDrawBuffers", drawBuffers},
+        {"glProgramBinary", programBinary},
+        {"glUniform1fv", uniformv<1>}, {"glUniform1iv", uniformv<1>}, {"glUniform1uiv", uniformv<1>},
+        {"glUniform2fv", uniformv<2>}, {"glUniform2iv", uniformv<2>}, {"glUniform2uiv", uniformv<2>},
+        {"glUniform3fv", uniformv<3>}, {"glUniform3iv", uniformv<3>}, {"glUniform3uiv", uniformv<3>},
+        {"glUniform4fv", uniformv<4>}, {"glUniform4iv", uniformv<4>}, {"glUniform4uiv", uniformv<4>},
+        {"glUniformMatrix2fv", uniformv<4>},
+        {"glUniformMatrix3fv", uniformv<9>},
+        {"glUniformMatrix4fv", uniformv<16>},
+    };
+
+    auto it = sizers.find(name);
+    return it != sizers.end() ? it->second : nullptr;
+}
+
+int kindIndex(char kind) {
+    const char* found = std::strchr(Capture::KINDS, kind);
+    return found && kind ? found - Capture::KINDS : -1;
+}
+
+double nowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+constexpr char MAGIC[4] = {'G', 'L', 'R', 'C'};
+constexpr size_t FLUSH_SIZE = 16 << 20;
+
+}
+
+// stringizing and pasting don't expand the argument, so glad's macro names stay intact
+#define GLR_CAPTURE_ENTRY(function, spec) { \
+    #function, spec, \
+    reinterpret_cast<void**>(&glad_##function), \
+    reinterpret_cast<void*>(&Recorder<#function, decltype(glad_##function)>::call), \
+    &Playback<decltype(glad_##function)>::call, \
+    sizerFor(#function), \
+    Playback<decltype(glad_##function)>::SIZES, \
+    nullptr \
+},
+
+std::vector<Capture::Function> Capture::s_Functions = { GLR_CAPTURED_FUNCTIONS(GLR_CAPTURE_ENTRY) };
+std::unordered_map<std::string, unsigned int> Capture::s_Indices;
+
+bool Capture::s_Recording = false;
+std::ofstream Capture::s_File;
+std::string Capture::s_Path;
+std::vector<uint8_t> Capture::s_Buffer;
+std::vector<bool> Capture::s_Declared;
+unsigned int Capture::s_FramesLeft = 0;
+unsigned int Capture::s_Frames = 0;
+uint64_t Capture::s_Bytes = 0;
+
+size_t Capture::imageSize(uint64_t width, uint64_t height, uint64_t depth, GLenum format, GLenum type, unsigned int alignment)
+{
+    if (width == 0 || height == 0 || depth == 0)
+        return 0;
+
+    size_t channels = 1;
+    switch (format) {
+        case GL_RG: case GL_RG_INTEGER: channels = 2; break;
+        case GL_RGB: case GL_BGR: case GL_RGB_INTEGER: channels = 3; break;
+        case GL_RGBA: case GL_BGRA: case GL_RGBA_INTEGER: channels = 4; break;
+    }
+
+    size_t pixel = channels;
+    switch (type) {
+        case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT: pixel = channels * 2; break;
+        case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT: pixel = channels * 4; break;
+        // packed, one value holds every channel
+        case GL_UNSIGNED_INT_24_8: case GL_UNSIGNED_INT_10F_11F_11F_REV:
+        case GL_UNSIGNED_INT_2_10_10_10_REV: case GL_UNSIGNED_INT_5_9_9_9_REV: pixel = 4; break;
+        case GL_FLOAT_32_UNSIGNED_INT_24_8_REV: pixel = 8; break;
+    }
+
+    alignment = std::max(alignment, 1u);
+    const size_t row = width * pixel;
+    const size_t stride = (row + alignment - 1) / alignment * alignment;
+
+    // the last row isn't padded
+    return (stride * (height - 1) + row) * depth;
+}
+
+const std::vector<Capture::Function>& Capture::getFunctions()
+{
+    return s_Functions;
+}
+
+unsigned int Capture::indexOf(const std::string& name)
+{
+    if (s_Indices.empty()) {
+        for (unsigned int i = 0; i < s_Functions.size(); i++)
+            s_Indices[s_Functions[i].name] = i;
+    }
+
+    auto it = s_Indices.find(name);
+    return it != s_Indices.end() ? it->second : s_Functions.size();
+}
+
+bool Capture::begin(const std::string& path, unsigned int frames, unsigned int width, unsigned int height)
+{
+    s_File.open(path, std::ios::binary);
+    if (!s_File) {
+        std::cerr << "ERROR::CAPTURE::FILE_NOT_OPENED::" << path << std::endl;
+        return false;
+    }
+
+    s_Path = path;
+    s_FramesLeft = std::max(frames, 1u);
+    s_Frames = 0;
+    s_Bytes = 0;
+    s_Declared.assign(s_Functions.size(), false);
+
+    put(MAGIC, sizeof(MAGIC));
+    putWord(VERSION, 4);
+    putWord(width, 4);
+    putWord(height, 4);
+
+    s_Recording = true;
+    return true;
+}
+
+void Capture::install()
+{
+    if (!s_Recording) return;
+
+    for (Function& function : s_Functions) {
+        function.real = *function.pointer;
+        if (function.real)
+            *function.pointer = function.recorder;
+    }
+}
+
+bool Capture::isRecording()
+{
+    return s_Recording;
+}
+
+void Capture::put(const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    s_Buffer.insert(s_Buffer.end(), bytes, bytes + size);
+}
+
+void Capture::putWord(uint64_t word, size_t size)
+{
+    // little endian hosts only, like the replays
+    put(&word, size);
+}
+
+void Capture::flush(bool force)
+{
+    if (!force && s_Buffer.size() < FLUSH_SIZE)
+        return;
+
+    s_File.write(reinterpret_cast<const char*>(s_Buffer.data()), s_Buffer.size());
+    s_Bytes += s_Buffer.size();
+    s_Buffer.clear();
+}
+
+void Capture::beginFrame()
+{
+    if (s_Recording)
+        putWord(FRAME_BEGIN, 2);
+}
+
+void Capture::endFrame()
+{
+    if (!s_Recording) return;
+
+    putWord(FRAME_END, 2);
+    s_Frames++;
+
+    if (--s_FramesLeft == 0)
+        end();
+}
+
+void Capture::end()
+{
+    if (!s_Recording) return;
+
+    s_Recording = false;
+    flush(true);
+    s_File.close();
+
+    std::cout << "CAPTURE::WROTE::" << s_Path << "::" << s_Frames << " frames, "
+        << s_Bytes / (1024.0 * 1024.0) << " MB" << std::endl;
+}
+
+void Capture::record(unsigned int index, const uint64_t* words, uint64_t result)
+{
+    if (!s_Recording) return;
+
+    static const unsigned int PIXEL_STORE = indexOf("glPixelStorei");
+    if (index == PIXEL_STORE && words[0] == GL_UNPACK_ALIGNMENT)
+        g_UnpackAlignment = words[1];
+
+    const Function& function = s_Functions[index];
+
+    if (!s_Declared[index]) {
+        putWord(DECLARE, 2);
+        putWord(index, 2);
+        putWord(std::strlen(function.name), 2);
+        put(function.name, std::strlen(function.name));
+        putWord(std::strlen(function.spec), 2);
+        put(function.spec, std::strlen(function.spec));
+        s_Declared[index] = true;
+    }
+
+    putWord(index, 2);
+
+    const char* spec = function.spec;
+    for (unsigned int i = 0; *spec && *spec != '='; i++) {
+        const char code = *spec++;
+
+        switch (code) {
+            case '.':
+                putWord(words[i], function.sizes[i]);
+                break;
+            case 'L':
+                putWord(words[i], 4);
+                break;
+            case 'D': {
+                const void* data = fromWord<const void*>(words[i]);
+                const size_t size = data ? function.sizer(words) : 0;
+                putWord(data != nullptr, 1);
+                putWord(size, 4);
+                put(data, size);
+                break;
+            }
+            case 'C': {
+                const char* string = fromWord<const char*>(words[i]);
+                putWord(std::strlen(string), 4);
+                put(string, std::strlen(string));
+                break;
+            }
+            case 'g':
+            case 'a': {
+                spec++;
+                const uint32_t count = static_cast<uint32_t>(words[i - 1]);
+                put(fromWord<const GLuint*>(words[i]), count * sizeof(GLuint));
+                break;
+            }
+            case 'Z': {
+                const uint32_t count = static_cast<uint32_t>(words[i - 1]);
+                const GLchar* const* strings = fromWord<const GLchar* const*>(words[i]);
+                const GLint* lengths = fromWord<const GLint*>(words[i + 1]);
+
+                std::string source;
+                for (uint32_t k = 0; k < count; k++) {
+                    if (lengths && lengths[k] >= 0)
+                        source.append(strings[k], lengths[k]);
+                    else
+                        source.append(strings[k]);
+                }
+
+                putWord(source.size(), 4);
+                put(source.data(), source.size());
+                break;
+            }
+            case 'N':
+                break;
+            case 'W':
+                putWord(function.sizer(words), 4);
+                break;
+            default:
+                putWord(words[i], 4);
+        }
+    }
+
+    if (*spec == '=')
+        putWord(result, 4);
+
+    flush(false);
+}
+
+bool CaptureReplayer::load(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "ERROR::CAPTURE::FILE_NOT_FOUND::" << path << std::endl;
+        return false;
+    }
+
+    m_Data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    if (m_Data.size() < 16 || std::memcmp(m_Data.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        std::cerr << "ERROR::CAPTURE::NOT_A_CAPTURE::" << path << std::endl;
+        return false;
+    }
+
+    m_Cursor = sizeof(MAGIC);
+    if (read<uint32_t>() != Capture::VERSION) {
+        std::cerr << "ERROR::CAPTURE::UNSUPPORTED_VERSION::" << path << std::endl;
+        return false;
+    }
+
+    m_Width = read<uint32_t>();
+    m_Height = read<uint32_t>();
+
+    m_Names.assign(std::strlen(Capture::KINDS), {});
+    return true;
+}
+
+uint32_t CaptureReplayer::mapName(char kind, uint32_t name) const
+{
+    const auto& names = m_Names[kindIndex(kind)];
+    auto it = names.find(name);
+    return it != names.end() ? it->second : name;
+}
+
+int32_t CaptureReplayer::mapLocation(int32_t location) const
+{
+    auto it = m_Locations.find((uint64_t(m_Program) << 32) | uint32_t(location));
+    return it != m_Locations.end() ? it->second : location;
+}
+
+CaptureReplayer::Step CaptureReplayer::step()
+{
+    if (m_Cursor + 2 > m_Data.size())
+        return Step::End;
+
+    const uint16_t id = read<uint16_t>();
+
+    if (id == Capture::FRAME_BEGIN) return Step::FrameBegin;
+    if (id == Capture::FRAME_END) return Step::FrameEnd;
+
+    const auto readString = [&](size_t size) {
+        std::string string(reinterpret_cast<const char*>(m_Data.data() + m_Cursor), size);
+        m_Cursor += size;
+        return string;
+    };
+
+    if (id == Capture::DECLARE) {
+        const uint16_t captured = read<uint16_t>();
+        const std::string name = readString(read<uint16_t>());
+        const std::string spec = readString(read<uint16_t>());
+
+        const unsigned int local = Capture::indexOf(name);
+        const bool known = local < Capture::getFunctions().size() && spec == Capture::getFunctions()[local].spec;
+
+        if (!known) {
+            std::cerr << "ERROR::CAPTURE::UNKNOWN_FUNCTION::" << name << std::endl;
+            m_Cursor = m_Data.size();
+            return Step::End;
+        }
+
+        if (m_Functions.size() <= captured)
+            m_Functions.resize(captured + 1, -1);
+        m_Functions[captured] = local;
+        return Step::Call;
+    }
+
+    if (id >= m_Functions.size() || m_Functions[id] < 0) {
+        std::cerr << "ERROR::CAPTURE::CORRUPT_STREAM::" << m_Cursor << std::endl;
+        m_Cursor = m_Data.size();
+        return Step::End;
+    }
+
+    static const unsigned int USE_PROGRAM = Capture::indexOf("glUseProgram");
+
+    const Capture::Function& function = Capture::getFunctions()[m_Functions[id]];
+
+    uint64_t words[Capture::MAX_ARGUMENTS] = {};
+
+    // storage the arguments point into until the call returned
+    std::string string;
+    const GLchar* source = nullptr;
+    GLint sourceLength = 0;
+    std::vector<GLuint> names;
+    std::vector<GLuint> generated;
+    char generatedKind = 0;
+    const uint8_t* captured = nullptr;
+
+    const char* spec = function.spec;
+    for (unsigned int i = 0; *spec && *spec != '='; i++) {
+        const char code = *spec++;
+
+        switch (code) {
+            case '.': {
+                uint64_t word = 0;
+                std::memcpy(&word, m_Data.data() + m_Cursor, function.sizes[i]);
+                m_Cursor += function.sizes[i];
+                words[i] = word;
+                break;
+            }
+            case 'L':
+                words[i] = Capture::toWord(mapLocation(read<int32_t>()));
+                break;
+            case 'D': {
+                const bool present = read<uint8_t>();
+                const uint32_t size = read<uint32_t>();
+                words[i] = present ? Capture::toWord(m_Data.data() + m_Cursor) : 0;
+                m_Cursor += size;
+                break;
+            }
+            case 'C':
+                string = readString(read<uint32_t>());
+                words[i] = Capture::toWord(string.c_str());
+                break;
+            case 'g':
+            case 'a': {
+                const char kind = *spec++;
+                const uint32_t count = static_cast<uint32_t>(words[i - 1]);
+
+                if (code == 'g') {
+                    captured = m_Data.data() + m_Cursor;
+                    generated.resize(count);
+                    generatedKind = kind;
+                    words[i] = Capture::toWord(generated.data());
+                } else {
+                    names.resize(count);
+                    for (uint32_t k = 0; k < count; k++) {
+                        GLuint name;
+                        std::memcpy(&name, m_Data.data() + m_Cursor + k * sizeof(GLuint), sizeof(GLuint));
+                        names[k] = mapName(kind, name);
+                    }
+                    words[i] = Capture::toWord(names.data());
+                }
+
+                m_Cursor += count * sizeof(GLuint);
+                break;
+            }
+            case 'Z': {
+                sourceLength = read<uint32_t>();
+                source = reinterpret_cast<const GLchar*>(m_Data.data() + m_Cursor);
+                m_Cursor += sourceLength;
+
+                words[i - 1] = 1;
+                words[i] = Capture::toWord(&source);
+                words[i + 1] = Capture::toWord(&sourceLength);
+                break;
+            }
+            case 'N':
+                break;
+            case 'W': {
+                const uint32_t size = read<uint32_t>();
+                if (m_Output.size() < size)
+                    m_Output.resize(size);
+                words[i] = Capture::toWord(m_Output.data());
+                break;
+            }
+            default:
+                words[i] = mapName(code, read<uint32_t>());
+        }
+    }
+
+    const char returned = *spec == '=' ? spec[1] : 0;
+    const uint32_t capturedResult = returned ? read<uint32_t>() : 0;
+
+    void* real = *function.pointer;
+    if (real == nullptr) {
+        m_Skipped++;
+        return Step::Call;
+    }
+
+    const uint64_t result = function.player(real, words);
+    m_Calls++;
+
+    if (m_Functions[id] == int(USE_PROGRAM))
+        m_Program = static_cast<uint32_t>(words[0]);
+
+    for (size_t k = 0; k < generated.size(); k++) {
+        GLuint name;
+        std::memcpy(&name, captured + k * sizeof(GLuint), sizeof(GLuint));
+        m_Names[kindIndex(generatedKind)][name] = generated[k];
+    }
+
+    // locations belong to the program they were asked for, the first argument
+    if (returned == 'L')
+        m_Locations[(words[0] << 32) | capturedResult] = static_cast<int32_t>(result);
+    else if (returned)
+        m_Names[kindIndex(returned)][capturedResult] = static_cast<uint32_t>(result);
+
+    return Step::Call;
+}
+
+void CaptureReplayer::prepare()
+{
+    for (;;) {
+        const size_t start = m_Cursor;
+        const Step step = this->step();
+
+        if (step == Step::FrameBegin) {
+            m_FramesStart = start;
+            return;
+        }
+        if (step == Step::End) {
+            m_FramesStart = m_Cursor;
+            return;
+        }
+    }
+}
+
+std::vector<CaptureReplayer::Frame> CaptureReplayer::replayFrames(void (*present)())
+{
+    std::vector<Frame> frames;
+    m_Cursor = m_FramesStart;
+
+    double start = 0.0;
+    for (Step step = this->step(); step != Step::End; step = this->step()) {
+        if (step == Step::FrameBegin) {
+            start = nowMs();
+        } else if (step == Step::FrameEnd) {
+            const double submitted = nowMs();
+            glFinish();
+            const double finished = nowMs();
+
+            frames.push_back({submitted - start, finished - start});
+
+            if (present)
+                present();
+        }
+    }
+
+    return frames;
+}
@@ -0,0 +1,281 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <glad/glad.h>
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Every GL function the renderer calls, with how its arguments are stored:
+//   .        plain value, pointers that are buffer offsets included
+//   B T F R V Q S  buffer, texture, framebuffer, renderbuffer, vertex array,
+//            query, shader or program name, remapped on replay
+//   L        uniform location of the current program, remapped on replay
+//   D        payload read by the call, sized from the other arguments
+//   C        string
+//   g? a?    n names of kind ? generated by / passed to the call, n is the argument before
+//   Z N      shader sources and their lengths
+//   W        output the call writes, only its size is stored
+//   =?       return value, remapped like an argument
+// Queries are left out, replays don't need their answers.
+#define GLR_CAPTURED_FUNCTIONS(X) \
+    X(glActiveTexture, ".") \
+    X(glAttachShader, "SS") \
+    X(glBindBuffer, ".B") \
+    X(glBindFramebuffer, ".F") \
+    X(glBindImageTexture, ".T.....") \
+    X(glBindRenderbuffer, ".R") \
+    X(glBindTexture, ".T") \
+    X(glBindVertexArray, "V") \
+    X(glBlendFunc, "..") \
+    X(glBlitFramebuffer, "..........") \
+    X(glBufferData, "..D.") \
+    X(glBufferSubData, "...D") \
+    X(glClear, ".") \
+    X(glClearColor, "....") \
+    X(glColorMask, "....") \
+    X(glCompileShader, "S") \
+    X(glCreateProgram, "=S") \
+    X(glCreateShader, ".=S") \
+    X(glCullFace, ".") \
+    X(glDeleteBuffers, ".aB") \
+    X(glDeleteFramebuffers, ".aF") \
+    X(glDeleteProgram, "S") \
+    X(glDeleteQueries, ".aQ") \
+    X(glDeleteRenderbuffers, ".aR") \
+    X(glDeleteShader, "S") \
+    X(glDeleteTextures, ".aT") \
+    X(glDeleteVertexArrays, ".aV") \
+    X(glDepthFunc, ".") \
+    X(glDepthMask, ".") \
+    X(glDisable, ".") \
+    X(glDispatchCompute, "...") \
+    X(glDrawArrays, "...") \
+    X(glDrawArraysInstanced, "....") \
+    X(glDrawBuffer, ".") \
+    X(glDrawBuffers, ".D") \
+    X(glDrawElements, "....") \
+    X(glDrawElementsInstanced, ".....") \
+    X(glEnable, ".") \
+    X(glEnableVertexAttribArray, ".") \
+    X(glFramebufferRenderbuffer, "...R") \
+    X(glFramebufferTexture, "..T.") \
+    X(glFramebufferTexture2D, "...T.") \
+    X(glFramebufferTextureLayer, "..T..") \
+    X(glGenBuffers, ".gB") \
+    X(glGenFramebuffers, ".gF") \
+    X(glGenQueries, ".gQ") \
+    X(glGenRenderbuffers, ".gR") \
+    X(glGenTextures, ".gT") \
+    X(glGenVertexArrays, ".gV") \
+    X(glGenerateMipmap, ".") \
+    X(glGetUniformLocation, "SC=L") \
+    X(glLinkProgram, "S") \
+    X(glMemoryBarrier, ".") \
+    X(glPixelStorei, "..") \
+    X(glPolygonMode, "..") \
+    X(glProgramBinary, "S.D.") \
+    X(glProgramParameteri, "S..") \
+    X(glQueryCounter, "Q.") \
+    X(glReadBuffer, ".") \
+    X(glReadPixels, "......W") \
+    X(glRenderbufferStorage, "....") \
+    X(glRenderbufferStorageMultisample, ".....") \
+    X(glScissor, "....") \
+    X(glShaderSource, "S.ZN") \
+    X(glStencilFunc, "...") \
+    X(glStencilOp, "...") \
+    X(glStencilOpSeparate, "....") \
+    X(glTexImage2D, "........D") \
+    X(glTexImage2DMultisample, "......") \
+    X(glTexImage3D, ".........D") \
+    X(glTexParameterfv, "..D") \
+    X(glTexParameteri, "...") \
+    X(glTexSubImage2D, "........D") \
+    X(glUniform1f, "L.") \
+    X(glUniform1fv, "L.D") \
+    X(glUniform1i, "L.") \
+    X(glUniform1iv, "L.D") \
+    X(glUniform1uiv, "L.D") \
+    X(glUniform2f, "L..") \
+    X(glUniform2fv, "L.D") \
+    X(glUniform2iv, "L.D") \
+    X(glUniform2uiv, "L.D") \
+    X(glUniform3f, "L...") \
+    X(glUniform3fv, "L.D") \
+    X(glUniform3iv, "L.D") \
+    X(glUniform3uiv, "L.D") \
+    X(glUniform4f, "L....") \
+    X(glUniform4fv, "L.D") \
+    X(glUniform4iv, "L.D") \
+    X(glUniform4uiv, "L.D") \
+    X(glUniformMatrix2fv, "L..D") \
+    X(glUniformMatrix3fv, "L..D") \
+    X(glUniformMatrix4fv, "L..D") \
+    X(glUseProgram, "S") \
+    X(glVertexAttribPointer, "......") \
+    X(glViewport, "....")
+
+// Records the GL call stream with its payloads to a binary file, from the
+// first call after install() to the end of the given number of frames.
+// Replays need the resources created at startup, so recording always starts
+// with the context. ImGui loads GL on its own and is not recorded.
+class Capture {
+public:
+    constexpr static uint32_t VERSION = 1;
+    constexpr static unsigned int MAX_ARGUMENTS = 12;
+
+    // arguments and results as raw bits, pointers as addresses
+    using Player = uint64_t (*)(void* function, const uint64_t* words);
+    using Sizer = size_t (*)(const uint64_t* words);
+
+    struct Function {
+        const char* name;
+        const char* spec;
+        // glad's pointer, swapped for recorder while capturing
+        void** pointer;
+        void* recorder;
+        Player player;
+        // payload and output bytes, from the arguments
+        Sizer sizer;
+        // bytes of every argument, plain values are stored at that size
+        const uint8_t* sizes;
+        // the driver's function while capturing
+        void* real;
+    };
+
+    enum Record : uint16_t {
+        DECLARE = 0xFFFF,
+        FRAME_BEGIN = 0xFFFE,
+        FRAME_END = 0xFFFD
+    };
+
+    // name kinds, the order of the spec letters
+    constexpr static const char* KINDS = "BTFRVQS";
+
+    template<typename T>
+    static uint64_t toWord(T value) {
+        if constexpr (std::is_pointer_v<T>)
+            return reinterpret_cast<uintptr_t>(value);
+        else if constexpr (std::is_same_v<T, float>)
+            return std::bit_cast<uint32_t>(value);
+        else if constexpr (std::is_same_v<T, double>)
+            return std::bit_cast<uint64_t>(value);
+        else
+            return static_cast<uint64_t>(value);
+    }
+
+    template<typename T>
+    static T fromWord(uint64_t word) {
+        if constexpr (std::is_pointer_v<T>)
+            return reinterpret_cast<T>(static_cast<uintptr_t>(word));
+        else if constexpr (std::is_same_v<T, float>)
+            return std::bit_cast<float>(static_cast<uint32_t>(word));
+        else if constexpr (std::is_same_v<T, double>)
+            return std::bit_cast<double>(word);
+        else
+            return static_cast<T>(word);
+    }
+
+    // bytes of a w x h x d image as glTexImage reads it
+    static size_t imageSize(uint64_t width, uint64_t height, uint64_t depth, GLenum format, GLenum type, unsigned int alignment);
+
+private:
+    static std::vector<Function> s_Functions;
+    static std::unordered_map<std::string, unsigned int> s_Indices;
+
+    static bool s_Recording;
+    static std::ofstream s_File;
+    static std::string s_Path;
+    static std::vector<uint8_t> s_Buffer;
+    static std::vector<bool> s_Declared;
+    static unsigned int s_FramesLeft;
+    static unsigned int s_Frames;
+    static uint64_t s_Bytes;
+
+    static void put(const void* data, size_t size);
+    static void putWord(uint64_t word, size_t size);
+    static void flush(bool force);
+
+public:
+    static const std::vector<Function>& getFunctions();
+    static unsigned int indexOf(const std::string& name);
+
+    // opens the file, install() then routes glad's pointers through the recorder
+    static bool begin(const std::string& path, unsigned int frames, unsigned int width, unsigned int height);
+    static void install();
+    static bool isRecording();
+
+    // render() brackets every frame, the file is written after the last one
+    static void beginFrame();
+    static void endFrame();
+    // writes what was recorded so far when the app quits early
+    static void end();
+
+    static void record(unsigned int index, const uint64_t* words, uint64_t result);
+};
+
+// Plays a capture back on the current context, glad must be loaded. Names
+// and uniform locations are remapped to the ones this driver hands out.
+class CaptureReplayer {
+public:
+    enum class Step { Call, FrameBegin, FrameEnd, End };
+
+    struct Frame {
+        // decoding and submitting the calls, then until glFinish() returned
+        double submitMs;
+        double finishMs;
+    };
+
+private:
+    std::vector<uint8_t> m_Data;
+    size_t m_Cursor = 0;
+    uint32_t m_Width = 0, m_Height = 0;
+
+    // capture ids to the local function table
+    std::vector<int> m_Functions;
+    std::vector<std::unordered_map<uint32_t, uint32_t>> m_Names;
+    std::unordered_map<uint64_t, int32_t> m_Locations;
+    uint32_t m_Program = 0;
+
+    size_t m_FramesStart = 0;
+    unsigned int m_Calls = 0;
+    unsigned int m_Skipped = 0;
+    std::vector<uint8_t> m_Output;
+
+    template<typename T>
+    T read() {
+        T value {};
+        std::memcpy(&value, m_Data.data() + m_Cursor, sizeof(T));
+        m_Cursor += sizeof(T);
+        return value;
+    }
+
+    uint32_t mapName(char kind, uint32_t name) const;
+    int32_t mapLocation(int32_t location) const;
+
+    Step step();
+
+public:
+    bool load(const std::string& path);
+
+    inline uint32_t getWidth() const { return m_Width; }
+    inline uint32_t getHeight() const { return m_Height; }
+    inline unsigned int getCallCount() const { return m_Calls; }
+    // calls this context has no function for
+    inline unsigned int getSkippedCount() const { return m_Skipped; }
+
+    // replays everything up to the first frame, untimed
+    void prepare();
+    // replays every captured frame once, present is called after each
+    std::vector<Frame> replayFrames(void (*present)() = nullptr);
+};
+
+#endif
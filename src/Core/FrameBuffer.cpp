@@ -4,6 +4,10 @@ FrameBuffer::FrameBuffer() {
     glGenFramebuffers(1, &m_FrameBufferID);
 }
 
+FrameBuffer::~FrameBuffer() {
+    glDeleteFramebuffers(1, &m_FrameBufferID);
+}
+
 void FrameBuffer::attachTexture(int attachment_target, const Texture::Ptr& texture)
 {
     bind();
@@ -22,6 +26,18 @@ void FrameBuffer::attachCubemapTexture(int attachment_target, const Texture::Ptr
                            texture->getID(), mip_level);
 }
 
+void FrameBuffer::attachLayeredTexture(int attachment_target, const Texture::Ptr& texture)
+{
+    bind();
+    glFramebufferTexture(GL_FRAMEBUFFER, attachment_target, texture->getID(), 0);
+}
+
+void FrameBuffer::attachTextureLayer(int attachment_target, const Texture::Ptr& texture, int layer)
+{
+    bind();
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, attachment_target, texture->getID(), 0, layer);
+}
+
 void FrameBuffer::attachRenderBuffer(int attachent_target, const RenderBuffer::Ptr& rbo)
 {
     bind();
@@ -0,0 +1,276 @@
+#include "FrameGraph.hpp"
+
+#include <algorithm>
+
+bool FrameGraph::TextureDesc::operator==(const TextureDesc& other) const
+{
+    return width == other.width &&
+        height == other.height &&
+        config.internal_format == other.config.internal_format &&
+        config.data_format == other.config.data_format &&
+        config.data_type == other.config.data_type &&
+        config.hdr == other.config.hdr &&
+        config.min_filter == other.config.min_filter &&
+        config.mag_filter == other.config.mag_filter &&
+        config.wrap_s == other.config.wrap_s &&
+        config.wrap_t == other.config.wrap_t;
+}
+
+FrameGraph::Builder::Builder(FrameGraph& graph, unsigned int pass) :
+    m_Graph{graph}, m_Pass{pass}
+{}
+
+FrameGraph::Resource FrameGraph::Builder::create(const std::string& name, const TextureDesc& desc)
+{
+    ResourceNode node;
+    node.name = name;
+    node.desc = desc;
+    node.imported = false;
+
+    m_Graph.m_Resources.push_back(node);
+
+    return write(m_Graph.m_Resources.size() - 1);
+}
+
+FrameGraph::Resource FrameGraph::Builder::read(Resource resource)
+{
+    m_Graph.m_Passes[m_Pass].reads.push_back(resource);
+    return resource;
+}
+
+FrameGraph::Resource FrameGraph::Builder::write(Resource resource)
+{
+    m_Graph.m_Passes[m_Pass].writes.push_back(resource);
+    m_Graph.m_Resources[resource].writers.push_back(m_Pass);
+    return resource;
+}
+
+void FrameGraph::Builder::sideEffect()
+{
+    m_Graph.m_Passes[m_Pass].sideEffect = true;
+}
+
+void FrameGraph::Builder::execute(Execute execute)
+{
+    m_Graph.m_Passes[m_Pass].execute = std::move(execute);
+}
+
+void FrameGraph::reset()
+{
+    m_Passes.clear();
+    m_Resources.clear();
+}
+
+FrameGraph::Builder FrameGraph::addPass(const std::string& name)
+{
+    PassNode node;
+    node.name = name;
+
+    m_Passes.push_back(node);
+
+    return Builder(*this, m_Passes.size() - 1);
+}
+
+FrameGraph::Resource FrameGraph::importTexture(const std::string& name, const Texture::Ptr& texture)
+{
+    ResourceNode node;
+    node.name = name;
+    node.texture = texture;
+    node.imported = true;
+
+    m_Resources.push_back(node);
+
+    return m_Resources.size() - 1;
+}
+
+void FrameGraph::compile()
+{
+    std::vector<Resource> unreferenced;
+
+    for (ResourceNode& resource : m_Resources)
+        resource.refCount = 0;
+
+    for (const PassNode& pass : m_Passes)
+        for (Resource read : pass.reads)
+            m_Resources[read].refCount++;
+
+    for (Resource i = 0; i < m_Resources.size(); i++)
+        if (m_Resources[i].refCount == 0)
+            unreferenced.push_back(i);
+
+    const auto cull = [&](PassNode& pass) {
+        pass.culled = true;
+
+        for (Resource read : pass.reads)
+            if (--m_Resources[read].refCount == 0)
+                unreferenced.push_back(read);
+    };
+
+    for (PassNode& pass : m_Passes) {
+        pass.culled = false;
+        pass.refCount = pass.writes.size();
+
+        if (pass.refCount == 0 && !pass.sideEffect)
+            cull(pass);
+    }
+
+    // walk back from every unread resource, dropping writers nobody else needs
+    while (!unreferenced.empty()) {
+        const Resource resource = unreferenced.back();
+        unreferenced.pop_back();
+
+        for (unsigned int writer : m_Resources[resource].writers) {
+            PassNode& pass = m_Passes[writer];
+
+            if (pass.sideEffect || pass.culled)
+                continue;
+
+            if (--pass.refCount == 0)
+                cull(pass);
+        }
+    }
+
+    for (unsigned int i = 0; i < m_Passes.size(); i++) {
+        const PassNode& pass = m_Passes[i];
+        if (pass.culled) continue;
+
+        const auto touch = [&](Resource resource) {
+            ResourceNode& node = m_Resources[resource];
+            if (node.firstUse == NONE)
+                node.firstUse = i;
+            node.lastUse = i;
+        };
+
+        std::for_each(pass.reads.begin(), pass.reads.end(), touch);
+        std::for_each(pass.writes.begin(), pass.writes.end(), touch);
+    }
+}
+
+void FrameGraph::execute(const Profiler::Ptr& profiler)
+{
+    m_InUseBytes = m_PeakBytes = 0;
+
+    for (unsigned int i = 0; i < m_Passes.size(); i++) {
+        const PassNode& pass = m_Passes[i];
+        if (pass.culled) continue;
+
+        for (ResourceNode& node : m_Resources) {
+            if (node.imported || node.firstUse != i) continue;
+
+            node.poolIndex = acquire(node.desc);
+            node.texture = m_Pool[node.poolIndex].texture;
+        }
+
+        if (pass.execute) {
+            Profiler::Scope scope(profiler, pass.name);
+            pass.execute(*this);
+        }
+
+        for (ResourceNode& node : m_Resources) {
+            if (node.imported || node.lastUse != i) continue;
+
+            release(node.poolIndex);
+            node.texture = nullptr;
+        }
+    }
+
+    // nothing is in use between frames, so indices may shift here
+    std::erase_if(m_Pool, [](PoolEntry& entry) {
+        return ++entry.idleFrames >= POOL_EVICT_FRAMES;
+    });
+}
+
+unsigned int FrameGraph::acquire(const TextureDesc& desc)
+{
+    unsigned int index = NONE;
+
+    for (unsigned int i = 0; i < m_Pool.size() && index == NONE; i++)
+        if (!m_Pool[i].inUse && m_Pool[i].desc == desc)
+            index = i;
+
+    if (index == NONE) {
+        PoolEntry entry;
+        entry.texture = ColorBufferTexture::New(desc.width, desc.height, desc.config);
+        entry.desc = desc;
+
+        m_Pool.push_back(entry);
+        index = m_Pool.size() - 1;
+    }
+
+    m_Pool[index].inUse = true;
+    m_Pool[index].idleFrames = 0;
+
+    m_InUseBytes += byteSize(desc);
+    m_PeakBytes = std::max(m_PeakBytes, m_InUseBytes);
+
+    return index;
+}
+
+void FrameGraph::release(unsigned int poolIndex)
+{
+    m_Pool[poolIndex].inUse = false;
+    m_InUseBytes -= byteSize(m_Pool[poolIndex].desc);
+}
+
+Texture::Ptr FrameGraph::getTexture(Resource resource) const
+{
+    return m_Resources[resource].texture;
+}
+
+bool FrameGraph::isCulled(const std::string& pass) const
+{
+    return std::any_of(m_Passes.begin(), m_Passes.end(), [&](const PassNode& node) {
+        return node.name == pass && node.culled;
+    });
+}
+
+unsigned int FrameGraph::getPassCount() const
+{
+    return m_Passes.size();
+}
+
+unsigned int FrameGraph::getCulledCount() const
+{
+    return std::count_if(m_Passes.begin(), m_Passes.end(), [](const PassNode& node) {
+        return node.culled;
+    });
+}
+
+unsigned int FrameGraph::getPoolTextureCount() const
+{
+    return m_Pool.size();
+}
+
+size_t FrameGraph::getPoolBytes() const
+{
+    size_t bytes = 0;
+
+    for (const PoolEntry& entry : m_Pool)
+        bytes += byteSize(entry.desc);
+
+    return bytes;
+}
+
+size_t FrameGraph::bytesPerPixel(GLint internalFormat)
+{
+    switch (internalFormat) {
+        case GL_R8: return 1;
+        case GL_RG8: return 2;
+        case GL_R16F: return 2;
+        case GL_RGBA32F: return 16;
+        case GL_RGBA16F: return 8;
+        case GL_RGB: return 3;
+        default: return 4;
+    }
+}
+
+size_t FrameGraph::byteSize(const TextureDesc& desc)
+{
+    GLint internalFormat = desc.config.internal_format;
+
+    // same fallback as ColorBufferTexture::genTexture
+    if (internalFormat == TextureConfig::UNSPECIFIED || desc.config.data_format == TextureConfig::UNSPECIFIED)
+        internalFormat = desc.config.hdr ? GL_RGBA32F : GL_RGB;
+
+    return bytesPerPixel(internalFormat) * desc.width * desc.height;
+}
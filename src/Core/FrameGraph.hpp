@@ -0,0 +1,125 @@
+#ifndef FRAME_GRAPH_H
+#define FRAME_GRAPH_H
+
+#include "Core/Profiler.hpp"
+#include "Texture/ColorBufferTexture.hpp"
+#include "Util/MoveOnly.hpp"
+#include "Util/Ptr.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Passes declare the virtual textures they read and write and are rebuilt
+// every frame. compile() culls the passes nothing depends on, execute()
+// runs the rest in declaration order and backs transient textures with a
+// pool, so targets whose lifetimes do not overlap share one texture.
+class FrameGraph {
+    MAKE_MOVE_ONLY(FrameGraph)
+    GENERATE_PTR(FrameGraph)
+public:
+    using Resource = unsigned int;
+    using Execute = std::function<void(const FrameGraph&)>;
+
+    struct TextureDesc {
+        unsigned int width = 1;
+        unsigned int height = 1;
+        TextureConfig config = ColorBufferTexture::defaultConfig();
+
+        bool operator==(const TextureDesc& other) const;
+    };
+
+    class Builder {
+    private:
+        FrameGraph& m_Graph;
+        unsigned int m_Pass;
+    public:
+        Builder(FrameGraph& graph, unsigned int pass);
+
+        // a new transient texture, written by this pass
+        Resource create(const std::string& name, const TextureDesc& desc);
+
+        Resource read(Resource resource);
+        Resource write(Resource resource);
+
+        // keeps the pass even if nothing reads what it writes
+        void sideEffect();
+
+        void execute(Execute execute);
+    };
+
+private:
+    // pooled textures unused for this many frames are deleted
+    constexpr static unsigned int POOL_EVICT_FRAMES = 60;
+    constexpr static unsigned int NONE = ~0u;
+
+    struct ResourceNode {
+        std::string name;
+        TextureDesc desc;
+        Texture::Ptr texture;
+        bool imported;
+
+        std::vector<unsigned int> writers;
+        unsigned int refCount = 0;
+        unsigned int firstUse = NONE, lastUse = NONE;
+        unsigned int poolIndex = NONE;
+    };
+
+    struct PassNode {
+        std::string name;
+        std::vector<Resource> reads;
+        std::vector<Resource> writes;
+        Execute execute;
+        bool sideEffect = false;
+
+        unsigned int refCount = 0;
+        bool culled = false;
+    };
+
+    struct PoolEntry {
+        ColorBufferTexture::Ptr texture;
+        TextureDesc desc;
+        bool inUse = false;
+        unsigned int idleFrames = 0;
+    };
+
+    std::vector<PassNode> m_Passes;
+    std::vector<ResourceNode> m_Resources;
+    std::vector<PoolEntry> m_Pool;
+
+    size_t m_InUseBytes = 0;
+    size_t m_PeakBytes = 0;
+
+    unsigned int acquire(const TextureDesc& desc);
+    void release(unsigned int poolIndex);
+
+    static size_t bytesPerPixel(GLint internalFormat);
+    static size_t byteSize(const TextureDesc& desc);
+
+public:
+    FrameGraph() = default;
+
+    // drops the passes of the last frame, the texture pool is kept
+    void reset();
+
+    Builder addPass(const std::string& name);
+    Resource importTexture(const std::string& name, const Texture::Ptr& texture = nullptr);
+
+    void compile();
+    // each pass that runs is timed as a scope of the profiler, if given
+    void execute(const Profiler::Ptr& profiler = nullptr);
+
+    // only valid while the passes touching the resource execute
+    Texture::Ptr getTexture(Resource resource) const;
+
+    bool isCulled(const std::string& pass) const;
+    unsigned int getPassCount() const;
+    unsigned int getCulledCount() const;
+
+    unsigned int getPoolTextureCount() const;
+    size_t getPoolBytes() const;
+    // largest amount of transient memory alive at once last frame
+    inline size_t getPeakBytes() const { return m_PeakBytes; }
+};
+
+#endif
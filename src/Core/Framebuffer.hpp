@@ -3,6 +3,7 @@
 
 #include "Texture/Texture.hpp"
 #include "RenderBuffer.hpp"
+#include "RenderStats.hpp"
 #include "Util/MoveOnly.hpp"
 #include "Util/Ptr.hpp"
 #include "imgui.h"
@@ -13,15 +14,19 @@
 
 class FrameBuffer {
     GENERATE_PTR(FrameBuffer)
-    MAKE_MOVE_ONLY(FrameBuffer)
+    MAKE_NON_MOVABLE(FrameBuffer)
 private:
     unsigned int m_FrameBufferID;
 public:
 
     FrameBuffer();
+    ~FrameBuffer();
 
     void attachTexture(int attachment_target, const Texture::Ptr& texture);
     void attachCubemapTexture(int attachment_target, const Texture::Ptr& texture, int face_slot, int mip_level = 0);
+    // every layer at once, a geometry shader picks one through gl_Layer
+    void attachLayeredTexture(int attachment_target, const Texture::Ptr& texture);
+    void attachTextureLayer(int attachment_target, const Texture::Ptr& texture, int layer);
     void attachRenderBuffer(int attachent_target, const RenderBuffer::Ptr& rbo);
 
     void setDrawBuffers(const std::vector<unsigned int>& draw_buffs);
@@ -30,6 +35,7 @@ public:
     void blitDepthTo(const FrameBuffer::Ptr& other, unsigned int width, unsigned int height);
 
     inline void bind() const {
+        RenderStats::s_Current.framebufferBinds++;
         glBindFramebuffer(GL_FRAMEBUFFER, m_FrameBufferID);
     }
 
@@ -8,33 +8,45 @@ GBuffer::GBuffer(unsigned int width, unsigned int height)
     gBuffer_TConf.min_filter = gBuffer_TConf.mag_filter = GL_NEAREST;
     gBuffer_TConf.wrap_s = gBuffer_TConf.wrap_t = GL_CLAMP_TO_EDGE;
 
-    m_PositionBuffer = ColorBufferTexture::New(width, height, gBuffer_TConf);
-    m_NormalBuffer = ColorBufferTexture::New(width, height, gBuffer_TConf);
-    m_AlbedoSpecBuffer = ColorBufferTexture::New(width, height, gBuffer_TConf);
-    m_PositionLightSpace = ColorBufferTexture::New(width, height, gBuffer_TConf);
+    TextureConfig normal_TConf = gBuffer_TConf;
+    normal_TConf.internal_format = GL_RG16;
+    normal_TConf.data_format = GL_RG;
 
-    m_RBO = RenderBuffer::New(RBType::DEPTH_STENCIL, width, height);
+    TextureConfig color_TConf = gBuffer_TConf;
+    color_TConf.internal_format = GL_RGBA8;
+    color_TConf.data_format = GL_RGBA;
+
+    // albedo is linear after sampling, 8 bit linear bands in the darks
+    TextureConfig albedo_TConf = color_TConf;
+    albedo_TConf.internal_format = GL_SRGB8_ALPHA8;
+
+    m_NormalBuffer = ColorBufferTexture::New(width, height, normal_TConf);
+    m_AlbedoSpecBuffer = ColorBufferTexture::New(width, height, albedo_TConf);
+    m_MaterialBuffer = ColorBufferTexture::New(width, height, color_TConf);
+
+    m_DepthBuffer = DepthStencilBufferTexture::New(width, height);
 
-    m_PositionBuffer->setSlot(renderer::TEXTURE_SLOT_DEFERRED_POSITION);
     m_NormalBuffer->setSlot(renderer::TEXTURE_SLOT_DEFERRED_NORMAL);
     m_AlbedoSpecBuffer->setSlot(renderer::TEXTURE_SLOT_DEFERRED_ALBEDOSPEC);
-    m_PositionLightSpace->setSlot(renderer::TEXTURE_SLOT_DEFERRED_POSITION_LIGHT_SPACE);
+    m_MaterialBuffer->setSlot(renderer::TEXTURE_SLOT_DEFERRED_MATERIAL);
+    m_DepthBuffer->setSlot(renderer::TEXTURE_SLOT_DEFERRED_DEPTH);
 
     bind();
 
-    attachTexture(GL_COLOR_ATTACHMENT0, m_PositionBuffer);
-    attachTexture(GL_COLOR_ATTACHMENT1, m_NormalBuffer);
-    attachTexture(GL_COLOR_ATTACHMENT2, m_AlbedoSpecBuffer);
-    attachTexture(GL_COLOR_ATTACHMENT3, m_PositionLightSpace);
+    attachTexture(GL_COLOR_ATTACHMENT0, m_NormalBuffer);
+    attachTexture(GL_COLOR_ATTACHMENT1, m_AlbedoSpecBuffer);
+    attachTexture(GL_COLOR_ATTACHMENT2, m_MaterialBuffer);
 
     setDrawBuffers({
         GL_COLOR_ATTACHMENT0,
         GL_COLOR_ATTACHMENT1,
-        GL_COLOR_ATTACHMENT2,
-        GL_COLOR_ATTACHMENT3
+        GL_COLOR_ATTACHMENT2
     });
 
-    attachRenderBuffer(GL_DEPTH_STENCIL_ATTACHMENT, m_RBO);
+    attachTexture(GL_DEPTH_STENCIL_ATTACHMENT, m_DepthBuffer);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::FRAMEBUFFER:: GBuffer is not complete!" << std::endl;
 
     unbind();
 }
@@ -42,18 +54,17 @@ GBuffer::GBuffer(unsigned int width, unsigned int height)
 void GBuffer::bindTextures()
 {
     // we do not want to bind the fbo itself
-    m_PositionBuffer->bind();
     m_NormalBuffer->bind();
     m_AlbedoSpecBuffer->bind();
-    m_PositionLightSpace->bind();
+    m_MaterialBuffer->bind();
+    m_DepthBuffer->bind();
 }
 
 void GBuffer::resize(unsigned int width, unsigned int height)
 {
-    m_PositionBuffer->resize(width, height);
     m_NormalBuffer->resize(width, height);
     m_AlbedoSpecBuffer->resize(width, height);
-    m_PositionLightSpace->resize(width, height);
+    m_MaterialBuffer->resize(width, height);
 
-    m_RBO->resize(width, height);
+    m_DepthBuffer->resize(width, height);
 }
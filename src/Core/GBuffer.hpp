@@ -2,26 +2,34 @@
 #define GBUFFER_H
 
 #include "Core/FrameBuffer.hpp"
-#include "Core/RenderBuffer.hpp"
 #include "Texture/ColorBufferTexture.hpp"
-#include "Texture/DepthBufferTexture.hpp"
+#include "Texture/DepthStencilBufferTexture.hpp"
 #include "Util/MoveOnly.hpp"
 #include "Util/Ptr.hpp"
 
+// Compact G-Buffer layout:
+//   0: RG16     octahedral encoded world normal
+//   1: SRGB8_A8 albedo + specular intensity
+//   2: RGBA8    metallic, roughness, ao
+//   D: D24S8    depth (world position is reconstructed from it)
 class GBuffer : public FrameBuffer {
-    MAKE_MOVE_ONLY(GBuffer)
+    MAKE_NON_MOVABLE(GBuffer)
     GENERATE_PTR(GBuffer)
 private:
-    ColorBufferTexture::Ptr m_PositionBuffer;
     ColorBufferTexture::Ptr m_NormalBuffer;
     ColorBufferTexture::Ptr m_AlbedoSpecBuffer;
-    ColorBufferTexture::Ptr m_PositionLightSpace;
+    ColorBufferTexture::Ptr m_MaterialBuffer;
 
-    RenderBuffer::Ptr m_RBO;
+    DepthStencilBufferTexture::Ptr m_DepthBuffer;
 public:
+    static constexpr unsigned int BYTES_PER_PIXEL = 4 + 4 + 4 + 4;
+
     GBuffer(unsigned int width, unsigned int height);
     void bindTextures();
     void resize(unsigned int width, unsigned int height);
+
+    inline const DepthStencilBufferTexture::Ptr& getDepthTexture() const { return m_DepthBuffer; }
+    inline const ColorBufferTexture::Ptr& getNormalTexture() const { return m_NormalBuffer; }
 };
 
 #endif
@@ -8,7 +8,7 @@
 #include <GLFW/glfw3.h>
 
 class IndexBuffer {
-    MAKE_MOVE_ONLY(IndexBuffer)
+    MAKE_NON_MOVABLE(IndexBuffer)
     GENERATE_PTR(IndexBuffer)
 
 private:
@@ -0,0 +1,32 @@
+#include "LazyResource.hpp"
+
+#include <GLFW/glfw3.h>
+
+LazyResource::LazyResource(const std::string& name, Callback create, Callback release):
+    m_Name{name}, m_Create{std::move(create)}, m_Release{std::move(release)}
+{
+}
+
+void LazyResource::require()
+{
+    m_LastUse = glfwGetTime();
+
+    if (m_Live) return;
+
+    m_Create();
+    m_Live = true;
+}
+
+void LazyResource::collect(double now, double graceSeconds)
+{
+    if (m_Live && now - m_LastUse > graceSeconds)
+        release();
+}
+
+void LazyResource::release()
+{
+    if (!m_Live) return;
+
+    m_Release();
+    m_Live = false;
+}
@@ -0,0 +1,40 @@
+#ifndef LAZY_RESOURCE_H
+#define LAZY_RESOURCE_H
+
+#include "Util/MoveOnly.hpp"
+#include "Util/Ptr.hpp"
+
+#include <functional>
+#include <string>
+
+// The shaders and targets of one feature. They are created the first time
+// the feature runs and released once it has been idle for the grace period,
+// so toggling a feature back and forth does not recompile anything.
+class LazyResource {
+    MAKE_MOVE_ONLY(LazyResource)
+    GENERATE_PTR(LazyResource)
+public:
+    using Callback = std::function<void()>;
+
+private:
+    std::string m_Name;
+    Callback m_Create;
+    Callback m_Release;
+
+    bool m_Live = false;
+    double m_LastUse = 0.0;
+
+public:
+    LazyResource(const std::string& name, Callback create, Callback release);
+
+    // call every frame the feature runs
+    void require();
+
+    void collect(double now, double graceSeconds);
+    void release();
+
+    inline bool isLive() const { return m_Live; }
+    inline const std::string& getName() const { return m_Name; }
+};
+
+#endif
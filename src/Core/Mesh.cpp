@@ -1,5 +1,6 @@
 #include "Mesh.hpp"
 #include "Core/IndexBuffer.hpp"
+#include "Core/RenderStats.hpp"
 #include "Core/Vertex.hpp"
 #include "Core/VertexArray.hpp"
 
@@ -45,6 +46,14 @@ Mesh::Mesh(
     init(vertices, indices);
 }
 
+Mesh::Mesh(const Mesh::Ptr& geometry) :
+    m_Geometry(geometry),
+    m_Material(geometry->m_Material),
+    m_ModelMatrix(1.f),
+    m_Textures(geometry->m_Textures),
+    m_VerticesLength(geometry->m_VerticesLength), m_IndicesLength(geometry->m_IndicesLength)
+{}
+
 void Mesh::init(
     std::vector<Vertex>& vertices,
     std::optional<std::reference_wrapper<std::vector<unsigned int>>> indices
@@ -68,6 +77,12 @@ void Mesh::init(
 }
 
 void Mesh::draw(bool wireframe, GLenum primitive) {
+    // the owner knows its primitive, spheres draw strips
+    if (m_Geometry) {
+        m_Geometry->draw(wireframe, primitive);
+        return;
+    }
+
     m_VAO->bind();
 
     wireframe
@@ -76,9 +91,29 @@ void Mesh::draw(bool wireframe, GLenum primitive) {
 
     // TODO: 1 - Allow drawing more primitives
     //       2 - Add wireframe mode
-    if (m_IBO == nullptr)
+    if (m_IBO == nullptr) {
+        RenderStats::countDraw(primitive, m_VerticesLength * 3);
         glDrawArrays(primitive, 0, m_VerticesLength * 3);
-    else
+    } else {
+        RenderStats::countDraw(primitive, m_IndicesLength);
         glDrawElements(primitive, m_IndicesLength, GL_UNSIGNED_INT, 0);
+    }
+
+}
+
+void Mesh::drawInstanced(unsigned int instances, GLenum primitive) {
+    if (m_Geometry) {
+        m_Geometry->drawInstanced(instances, primitive);
+        return;
+    }
 
+    m_VAO->bind();
+
+    if (m_IBO == nullptr) {
+        RenderStats::countDraw(primitive, m_VerticesLength, instances);
+        glDrawArraysInstanced(primitive, 0, m_VerticesLength, instances);
+    } else {
+        RenderStats::countDraw(primitive, m_IndicesLength, instances);
+        glDrawElementsInstanced(primitive, m_IndicesLength, GL_UNSIGNED_INT, 0, instances);
+    }
 }
@@ -28,6 +28,9 @@ private:
     IndexBuffer::Ptr m_IBO;
     VertexArray::Ptr m_VAO;
 
+    // set when the buffers belong to another mesh
+    std::shared_ptr<Mesh> m_Geometry;
+
     Material::Ptr m_Material;
     glm::mat4 m_ModelMatrix;
 
@@ -47,6 +50,8 @@ public:
     Mesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
     Mesh(std::vector<Vertex>&& vertices, std::vector<unsigned int>&& indices);
     Mesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, std::vector<Texture::Ptr>& textures);
+    // draws the buffers of geometry, keeping its own transform, material and textures
+    Mesh(const std::shared_ptr<Mesh>& geometry);
 
     inline void translate(const glm::vec3& v) { m_ModelMatrix = glm::translate(m_ModelMatrix, v); }
     inline void rotate(float deg, const glm::vec3& v) { m_ModelMatrix = glm::rotate(m_ModelMatrix, glm::radians(deg), v); }
@@ -63,6 +68,7 @@ public:
     inline glm::mat4& getModelMatrix() { return m_ModelMatrix; }
 
     virtual void draw(bool wireframe = false, GLenum primitive = GL_TRIANGLES);
+    virtual void drawInstanced(unsigned int instances, GLenum primitive = GL_TRIANGLES);
 };
 
 #endif
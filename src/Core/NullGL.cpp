@@ -0,0 +1,562 @@
+#include "NullGL.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+
+bool NullGL::s_Active = false;
+bool NullGL::s_InFrame = false;
+
+std::vector<std::string> NullGL::s_Names;
+std::vector<NullGL::Category> NullGL::s_Categories;
+std::unordered_map<std::string, unsigned int> NullGL::s_Indices;
+
+std::vector<uint64_t> NullGL::s_FrameCalls;
+std::vector<uint64_t> NullGL::s_TotalCalls;
+std::vector<uint64_t> NullGL::s_PeakCalls;
+std::vector<std::array<uint64_t, NullGL::CATEGORY_COUNT>> NullGL::s_FrameCategories;
+std::vector<double> NullGL::s_FrameTimes;
+double NullGL::s_FrameStart = 0.0;
+
+std::vector<std::string> NullGL::s_SectionNames = {"(none)"};
+std::vector<std::vector<uint64_t>> NullGL::s_SectionCalls(1);
+std::vector<unsigned int> NullGL::s_SectionStack = {0};
+
+namespace {
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// glad refuses a context without any extension, this one matches nothing the renderer looks for
+constexpr const char* EXTENSION = "GL_GLRENDERER_null_backend";
+
+GLuint s_NextHandle = 1;
+std::vector<uint8_t> s_Mapped;
+
+// function names as template arguments, so each stub knows what it counts
+template<size_t N>
+struct Name {
+    char value[N];
+    constexpr Name(const char (&name)[N]) { std::copy_n(name, N, value); }
+};
+
+template<Name name>
+void countCall() {
+    static const unsigned int index = NullGL::indexOf(name.value);
+    NullGL::count(index);
+}
+
+// Everything without an output only needs counting. The stubs ignore their
+// arguments, which is fine on 64 bit ABIs where the caller cleans the stack.
+template<unsigned int I>
+uintptr_t APIENTRY genericStub() {
+    NullGL::count(I);
+    return 0;
+}
+
+template<unsigned int... I>
+std::array<void*, sizeof...(I)> genericStubs(std::integer_sequence<unsigned int, I...>) {
+    return {reinterpret_cast<void*>(&genericStub<I>)...};
+}
+
+template<Name name>
+const GLubyte* APIENTRY getString(GLenum pname) {
+    countCall<name>();
+
+    const char* value = "";
+    switch (pname) {
+        case GL_VENDOR: value = "GLRenderer"; break;
+        case GL_RENDERER: value = "NullGL"; break;
+        case GL_VERSION: value = "3.3.0 NullGL"; break;
+        case GL_SHADING_LANGUAGE_VERSION: value = "3.30 NullGL"; break;
+    }
+    return reinterpret_cast<const GLubyte*>(value);
+}
+
+template<Name name>
+const GLubyte* APIENTRY getStringi(GLenum pname, GLuint index) {
+    countCall<name>();
+    return reinterpret_cast<const GLubyte*>(pname == GL_EXTENSIONS && index == 0 ? EXTENSION : "");
+}
+
+// how many values a glGet* of pname writes, every one of them is zeroed first
+static unsigned int valueCount(GLenum pname) {
+    switch (pname) {
+        case GL_VIEWPORT:
+        case GL_SCISSOR_BOX:
+        case GL_COLOR_CLEAR_VALUE:
+        case GL_COLOR_WRITEMASK:
+        case GL_BLEND_COLOR: return 4;
+        case GL_MAX_VIEWPORT_DIMS:
+        case GL_DEPTH_RANGE:
+        case GL_VIEWPORT_BOUNDS_RANGE:
+        case GL_ALIASED_LINE_WIDTH_RANGE:
+        case GL_SMOOTH_LINE_WIDTH_RANGE:
+        case GL_POINT_SIZE_RANGE: return 2;
+        default: return 1;
+    }
+}
+
+template<Name name>
+void APIENTRY getIntegerv(GLenum pname, GLint* data) {
+    countCall<name>();
+    std::fill_n(data, valueCount(pname), 0);
+
+    GLint value = 0;
+    switch (pname) {
+        case GL_MAJOR_VERSION:
+        case GL_MINOR_VERSION: value = 3; break;
+        case GL_NUM_EXTENSIONS: value = 1; break;
+        case GL_MAX_TEXTURE_SIZE:
+        case GL_MAX_CUBE_MAP_TEXTURE_SIZE:
+        case GL_MAX_RENDERBUFFER_SIZE: value = 16384; break;
+        case GL_MAX_SAMPLES:
+        case GL_MAX_COLOR_ATTACHMENTS:
+        case GL_MAX_DRAW_BUFFERS: value = 8; break;
+        case GL_MAX_TEXTURE_IMAGE_UNITS:
+        case GL_MAX_VERTEX_ATTRIBS: value = 16; break;
+        case GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS: value = 48; break;
+        case GL_MAX_ARRAY_TEXTURE_LAYERS: value = 2048; break;
+        case GL_MAX_UNIFORM_BLOCK_SIZE: value = 65536; break;
+        case GL_MAX_VIEWPORT_DIMS: data[1] = 16384; value = 16384; break;
+    }
+    data[0] = value;
+}
+
+template<Name name>
+void APIENTRY getInteger64v(GLenum pname, GLint64* data) {
+    countCall<name>();
+    std::fill_n(data, valueCount(pname), 0);
+}
+
+template<Name name>
+void APIENTRY getFloatv(GLenum pname, GLfloat* data) {
+    countCall<name>();
+    std::fill_n(data, valueCount(pname), 0.f);
+}
+
+template<Name name>
+void APIENTRY getBooleanv(GLenum pname, GLboolean* data) {
+    countCall<name>();
+    std::fill_n(data, valueCount(pname), GL_FALSE);
+}
+
+template<Name name>
+void APIENTRY genNames(GLsizei n, GLuint* names) {
+    countCall<name>();
+    for (GLsizei i = 0; i < n; i++)
+        names[i] = s_NextHandle++;
+}
+
+template<Name name>
+GLuint APIENTRY createShader(GLenum) {
+    countCall<name>();
+    return s_NextHandle++;
+}
+
+template<Name name>
+GLuint APIENTRY createProgram() {
+    countCall<name>();
+    return s_NextHandle++;
+}
+
+// shaders compile and link, queries are always available
+template<Name name, typename T>
+void APIENTRY getStatus(GLuint, GLenum pname, T* params) {
+    countCall<name>();
+
+    switch (pname) {
+        case GL_COMPILE_STATUS:
+        case GL_LINK_STATUS:
+        case GL_VALIDATE_STATUS:
+        case GL_COMPLETION_STATUS_KHR:
+        case GL_QUERY_RESULT_AVAILABLE: *params = GL_TRUE; break;
+        default: *params = 0;
+    }
+}
+
+template<Name name> void APIENTRY getStatusiv(GLuint object, GLenum pname, GLint* params) { getStatus<name>(object, pname, params); }
+template<Name name> void APIENTRY getStatusuiv(GLuint object, GLenum pname, GLuint* params) { getStatus<name>(object, pname, params); }
+
+template<Name name, typename T>
+void APIENTRY getZero64(GLuint, GLenum, T* params) {
+    countCall<name>();
+    *params = 0;
+}
+
+template<Name name> void APIENTRY getZeroi64v(GLuint object, GLenum pname, GLint64* params) { getZero64<name>(object, pname, params); }
+template<Name name> void APIENTRY getZeroui64v(GLuint object, GLenum pname, GLuint64* params) { getZero64<name>(object, pname, params); }
+
+template<Name name>
+void APIENTRY getParameteriv(GLenum, GLenum, GLint* params) {
+    countCall<name>();
+    *params = 0;
+}
+
+template<Name name>
+void APIENTRY getLevelParameteriv(GLenum, GLenum, GLenum, GLint* params) {
+    countCall<name>();
+    *params = 0;
+}
+
+template<Name name>
+void APIENTRY getInfoLog(GLuint, GLsizei size, GLsizei* length, GLchar* log) {
+    countCall<name>();
+    if (length) *length = 0;
+    if (log && size > 0) log[0] = '\0';
+}
+
+template<Name name>
+GLenum APIENTRY checkFramebufferStatus(GLenum) {
+    countCall<name>();
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+
+template<Name name>
+void* APIENTRY mapBufferRange(GLenum, GLintptr, GLsizeiptr length, GLbitfield) {
+    countCall<name>();
+    s_Mapped.resize(std::max<size_t>(s_Mapped.size(), length));
+    return s_Mapped.data();
+}
+
+template<Name name>
+GLboolean APIENTRY unmapBuffer(GLenum) {
+    countCall<name>();
+    return GL_TRUE;
+}
+
+template<Name name>
+GLsync APIENTRY fenceSync(GLenum, GLbitfield) {
+    countCall<name>();
+    return reinterpret_cast<GLsync>(uintptr_t(1));
+}
+
+template<Name name>
+GLenum APIENTRY clientWaitSync(GLsync, GLbitfield, GLuint64) {
+    countCall<name>();
+    return GL_ALREADY_SIGNALED;
+}
+
+// stringizing does not expand the argument, so glad's macro names stay intact
+#define NULLGL_STUB(function, stub) {#function, reinterpret_cast<void*>(&stub<#function>)}
+
+const std::unordered_map<std::string, void*>& overrides() {
+    static const std::unordered_map<std::string, void*> stubs = {
+        NULLGL_STUB(glGetString, getString),
+        NULLGL_STUB(glGetStringi, getStringi),
+        NULLGL_STUB(glGetIntegerv, getIntegerv),
+        NULLGL_STUB(glGetInteger64v, getInteger64v),
+        NULLGL_STUB(glGetFloatv, getFloatv),
+        NULLGL_STUB(glGetBooleanv, getBooleanv),
+
+        NULLGL_STUB(glGenBuffers, genNames),
+        NULLGL_STUB(glGenVertexArrays, genNames),
+        NULLGL_STUB(glGenTextures, genNames),
+        NULLGL_STUB(glGenFramebuffers, genNames),
+        NULLGL_STUB(glGenRenderbuffers, genNames),
+        NULLGL_STUB(glGenQueries, genNames),
+        NULLGL_STUB(glGenSamplers, genNames),
+        NULLGL_STUB(glGenTransformFeedbacks, genNames),
+        NULLGL_STUB(glGenProgramPipelines, genNames),
+        NULLGL_STUB(glCreateShader, createShader),
+        NULLGL_STUB(glCreateProgram, createProgram),
+
+        NULLGL_STUB(glGetShaderiv, getStatusiv),
+        NULLGL_STUB(glGetProgramiv, getStatusiv),
+        NULLGL_STUB(glGetQueryObjectiv, getStatusiv),
+        NULLGL_STUB(glGetQueryObjectuiv, getStatusuiv),
+        NULLGL_STUB(glGetQueryObjecti64v, getZeroi64v),
+        NULLGL_STUB(glGetQueryObjectui64v, getZeroui64v),
+        NULLGL_STUB(glGetShaderInfoLog, getInfoLog),
+        NULLGL_STUB(glGetProgramInfoLog, getInfoLog),
+
+        NULLGL_STUB(glGetTexParameteriv, getParameteriv),
+        NULLGL_STUB(glGetBufferParameteriv, getParameteriv),
+        NULLGL_STUB(glGetRenderbufferParameteriv, getParameteriv),
+        NULLGL_STUB(glGetQueryiv, getParameteriv),
+        NULLGL_STUB(glGetTexLevelParameteriv, getLevelParameteriv),
+        NULLGL_STUB(glGetFramebufferAttachmentParameteriv, getLevelParameteriv),
+
+        NULLGL_STUB(glCheckFramebufferStatus, checkFramebufferStatus),
+        NULLGL_STUB(glMapBufferRange, mapBufferRange),
+        NULLGL_STUB(glUnmapBuffer, unmapBuffer),
+        NULLGL_STUB(glFenceSync, fenceSync),
+        NULLGL_STUB(glClientWaitSync, clientWaitSync),
+    };
+    return stubs;
+}
+
+bool startsWith(const std::string& name, const char* prefix) {
+    return name.rfind(prefix, 0) == 0;
+}
+
+}
+
+void* NullGL::getProcAddress(const char* name)
+{
+    static const std::array<void*, MAX_FUNCTIONS> generic =
+        genericStubs(std::make_integer_sequence<unsigned int, MAX_FUNCTIONS>());
+
+    s_Active = true;
+
+    const unsigned int index = indexOf(name);
+    if (index >= MAX_FUNCTIONS) {
+        std::cerr << "ERROR::NULL_GL::TOO_MANY_FUNCTIONS::" << name << std::endl;
+        return nullptr;
+    }
+
+    auto stub = overrides().find(name);
+    return stub != overrides().end() ? stub->second : generic[index];
+}
+
+bool NullGL::isActive()
+{
+    return s_Active;
+}
+
+unsigned int NullGL::indexOf(const char* name)
+{
+    auto [it, inserted] = s_Indices.try_emplace(name, s_Names.size());
+
+    if (inserted) {
+        s_Names.push_back(name);
+        s_Categories.push_back(categorize(name));
+    }
+
+    return it->second;
+}
+
+NullGL::Category NullGL::categorize(const std::string& name)
+{
+    if (startsWith(name, "glBind") || name == "glUseProgram" || name == "glActiveTexture")
+        return Category::Bind;
+
+    if (startsWith(name, "glUniform") || startsWith(name, "glProgramUniform"))
+        return Category::Uniform;
+
+    if (startsWith(name, "glDraw") || startsWith(name, "glMultiDraw") || startsWith(name, "glDispatchCompute")
+        || startsWith(name, "glClear") || startsWith(name, "glBlitFramebuffer"))
+        return Category::Draw;
+
+    if (startsWith(name, "glBufferData") || startsWith(name, "glBufferSubData") || startsWith(name, "glTexImage")
+        || startsWith(name, "glTexSubImage") || startsWith(name, "glTexStorage") || startsWith(name, "glCompressedTex")
+        || startsWith(name, "glMapBuffer") || name == "glUnmapBuffer" || name == "glCopyBufferSubData"
+        || name == "glGenerateMipmap")
+        return Category::Upload;
+
+    if (startsWith(name, "glGet") || startsWith(name, "glIs") || name == "glCheckFramebufferStatus"
+        || name == "glClientWaitSync" || name == "glReadPixels")
+        return Category::Query;
+
+    if (startsWith(name, "glGen") || startsWith(name, "glCreate") || startsWith(name, "glDelete"))
+        return Category::Create;
+
+    return Category::State;
+}
+
+const char* NullGL::categoryName(Category category)
+{
+    constexpr const char* NAMES[] = {"bind", "uniform", "draw", "upload", "query", "create", "state"};
+    return NAMES[static_cast<unsigned int>(category)];
+}
+
+void NullGL::beginFrame()
+{
+    if (!s_Active) return;
+
+    const size_t functions = s_Names.size();
+    s_FrameCalls.assign(functions, 0);
+    s_TotalCalls.resize(functions, 0);
+    s_PeakCalls.resize(functions, 0);
+    for (std::vector<uint64_t>& calls : s_SectionCalls)
+        calls.resize(functions, 0);
+
+    s_FrameStart = Trace::now();
+    s_InFrame = true;
+}
+
+void NullGL::endFrame()
+{
+    if (!s_InFrame) return;
+
+    s_InFrame = false;
+    s_FrameTimes.push_back((Trace::now() - s_FrameStart) / 1e3);
+
+    std::array<uint64_t, CATEGORY_COUNT> categories {};
+
+    for (size_t i = 0; i < s_FrameCalls.size(); i++) {
+        s_TotalCalls[i] += s_FrameCalls[i];
+        s_PeakCalls[i] = std::max(s_PeakCalls[i], s_FrameCalls[i]);
+        categories[static_cast<unsigned int>(s_Categories[i])] += s_FrameCalls[i];
+    }
+
+    s_FrameCategories.push_back(categories);
+}
+
+void NullGL::pushSection(const std::string& name)
+{
+    if (!s_Active) return;
+
+    auto it = std::find(s_SectionNames.begin(), s_SectionNames.end(), name);
+    if (it == s_SectionNames.end()) {
+        s_SectionNames.push_back(name);
+        s_SectionCalls.emplace_back(s_Names.size(), 0);
+        it = s_SectionNames.end() - 1;
+    }
+
+    s_SectionStack.push_back(it - s_SectionNames.begin());
+}
+
+void NullGL::popSection()
+{
+    if (s_Active && s_SectionStack.size() > 1)
+        s_SectionStack.pop_back();
+}
+
+unsigned int NullGL::getFrameCount()
+{
+    return s_FrameCategories.size();
+}
+
+std::vector<NullGL::Call> NullGL::getCalls()
+{
+    const double frames = std::max(getFrameCount(), 1u);
+
+    std::vector<Call> calls;
+    for (size_t i = 0; i < s_TotalCalls.size(); i++) {
+        if (s_TotalCalls[i] == 0) continue;
+        calls.push_back({s_Names[i], s_Categories[i], s_TotalCalls[i] / frames, s_PeakCalls[i]});
+    }
+
+    std::sort(calls.begin(), calls.end(), [](const Call& a, const Call& b) {
+        return a.perFrame > b.perFrame;
+    });
+    return calls;
+}
+
+std::vector<NullGL::Section> NullGL::getSections()
+{
+    const double frames = std::max(getFrameCount(), 1u);
+
+    std::vector<Section> sections;
+    for (size_t s = 0; s < s_SectionNames.size(); s++) {
+        Section section {s_SectionNames[s], 0.0, {}, {}};
+
+        for (size_t i = 0; i < s_SectionCalls[s].size(); i++) {
+            const uint64_t calls = s_SectionCalls[s][i];
+            if (calls == 0) continue;
+
+            section.perFrame += calls / frames;
+            section.categories[static_cast<unsigned int>(s_Categories[i])] += calls / frames;
+            section.calls.push_back({s_Names[i], s_Categories[i], calls / frames, 0});
+        }
+
+        if (section.calls.empty()) continue;
+
+        std::sort(section.calls.begin(), section.calls.end(), [](const Call& a, const Call& b) {
+            return a.perFrame > b.perFrame;
+        });
+        sections.push_back(std::move(section));
+    }
+    return sections;
+}
+
+bool NullGL::writeReport(const std::string& path)
+{
+    std::ofstream out(path);
+    if (!out)
+        return false;
+
+    const auto distribution = [&](std::vector<double> samples) {
+        if (samples.empty()) {
+            out << "null";
+            return;
+        }
+
+        std::sort(samples.begin(), samples.end());
+
+        double sum = 0.0;
+        for (double sample : samples)
+            sum += sample;
+
+        out << "{\"min\": " << samples.front() << ", \"avg\": " << sum / samples.size()
+            << ", \"max\": " << samples.back() << "}";
+    };
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\n";
+    out << "  \"frames\": " << getFrameCount() << ",\n";
+    out << "  \"cpu_ms\": "; distribution(s_FrameTimes); out << ",\n";
+
+    out << "  \"calls_per_frame\": {";
+    for (unsigned int c = 0; c <= CATEGORY_COUNT; c++) {
+        std::vector<double> samples;
+        for (const auto& categories : s_FrameCategories) {
+            uint64_t calls = 0;
+            for (unsigned int k = 0; k < CATEGORY_COUNT; k++)
+                calls += c == CATEGORY_COUNT || c == k ? categories[k] : 0;
+            samples.push_back(calls);
+        }
+
+        out << (c ? ", " : "") << "\"" << (c == CATEGORY_COUNT ? "total" : categoryName(Category(c))) << "\": ";
+        distribution(samples);
+    }
+    out << "},\n";
+
+    out << "  \"functions\": [\n";
+    const std::vector<Call> calls = getCalls();
+    for (size_t i = 0; i < calls.size(); i++) {
+        out << "    {\"name\": \"" << calls[i].name << "\", \"category\": \"" << categoryName(calls[i].category)
+            << "\", \"per_frame\": " << calls[i].perFrame << ", \"peak\": " << calls[i].peak << "}"
+            << (i + 1 < calls.size() ? "," : "") << "\n";
+    }
+    out << "  ],\n";
+
+    out << "  \"sections\": [\n";
+    const std::vector<Section> sections = getSections();
+    for (size_t s = 0; s < sections.size(); s++) {
+        const Section& section = sections[s];
+
+        out << "    {\"name\": \"" << section.name << "\", \"per_frame\": " << section.perFrame << ", \"categories\": {";
+        for (unsigned int c = 0; c < CATEGORY_COUNT; c++)
+            out << (c ? ", " : "") << "\"" << categoryName(Category(c)) << "\": " << section.categories[c];
+        out << "}, \"functions\": {";
+        for (size_t i = 0; i < section.calls.size(); i++)
+            out << (i ? ", " : "") << "\"" << section.calls[i].name << "\": " << section.calls[i].perFrame;
+        out << "}}" << (s + 1 < sections.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+
+    return out.good();
+}
+
+void NullGL::printSummary()
+{
+    const unsigned int frames = getFrameCount();
+
+    double total_ms = 0.0;
+    for (double ms : s_FrameTimes)
+        total_ms += ms;
+
+    std::cout << "NULL_GL::" << frames << " frames, "
+        << std::fixed << std::setprecision(3) << (frames ? total_ms / frames : 0.0) << " ms CPU per frame" << std::endl;
+
+    std::cout << std::left << std::setw(28) << "section" << std::right << std::setw(10) << "calls";
+    for (unsigned int c = 0; c < CATEGORY_COUNT; c++)
+        std::cout << std::setw(10) << categoryName(Category(c));
+    std::cout << std::endl;
+
+    std::cout << std::setprecision(1);
+    for (const Section& section : getSections()) {
+        std::cout << std::left << std::setw(28) << section.name << std::right << std::setw(10) << section.perFrame;
+        for (double calls : section.categories)
+            std::cout << std::setw(10) << calls;
+        std::cout << std::endl;
+    }
+}
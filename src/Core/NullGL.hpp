@@ -0,0 +1,103 @@
+#ifndef NULL_GL_H
+#define NULL_GL_H
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// GL backend that renders nothing. Loaded into glad in place of the driver,
+// every entry point only counts its calls and the few that hand something
+// back return plausible handles and statuses, so the renderer runs its full
+// CPU side without a GPU. Reports as a 3.3 core context.
+class NullGL {
+public:
+    enum class Category : unsigned int {
+        Bind,
+        Uniform,
+        Draw,
+        Upload,
+        Query,
+        Create,
+        State,
+        Count
+    };
+
+    constexpr static unsigned int CATEGORY_COUNT = static_cast<unsigned int>(Category::Count);
+
+    // more than glad's 4.6 core loader asks for
+    constexpr static unsigned int MAX_FUNCTIONS = 768;
+
+    struct Call {
+        std::string name;
+        Category category;
+        double perFrame;
+        uint64_t peak;
+    };
+
+    struct Section {
+        std::string name;
+        double perFrame;
+        std::array<double, CATEGORY_COUNT> categories;
+        // most called functions first
+        std::vector<Call> calls;
+    };
+
+private:
+    static bool s_Active;
+    static bool s_InFrame;
+
+    static std::vector<std::string> s_Names;
+    static std::vector<Category> s_Categories;
+    static std::unordered_map<std::string, unsigned int> s_Indices;
+
+    // calls of the current frame, and folded over every finished one
+    static std::vector<uint64_t> s_FrameCalls;
+    static std::vector<uint64_t> s_TotalCalls;
+    static std::vector<uint64_t> s_PeakCalls;
+    static std::vector<std::array<uint64_t, CATEGORY_COUNT>> s_FrameCategories;
+    static std::vector<double> s_FrameTimes;
+    static double s_FrameStart;
+
+    // profiler sections, 0 collects the calls made outside of any
+    static std::vector<std::string> s_SectionNames;
+    static std::vector<std::vector<uint64_t>> s_SectionCalls;
+    static std::vector<unsigned int> s_SectionStack;
+
+public:
+    // the loader passed to gladLoadGLLoader()
+    static void* getProcAddress(const char* name);
+    static bool isActive();
+
+    static unsigned int indexOf(const char* name);
+    static Category categorize(const std::string& name);
+    static const char* categoryName(Category category);
+
+    static inline void count(unsigned int index) {
+        if (!s_InFrame) return;
+
+        s_FrameCalls[index]++;
+        s_SectionCalls[s_SectionStack.back()][index]++;
+    }
+
+    // calls are only counted between these, render() brackets a frame
+    static void beginFrame();
+    static void endFrame();
+
+    // follows the profiler scopes, calls count to the innermost one
+    static void pushSection(const std::string& name);
+    static void popSection();
+
+    static unsigned int getFrameCount();
+    // per frame averages over every counted frame, most called first
+    static std::vector<Call> getCalls();
+    static std::vector<Section> getSections();
+
+    static bool writeReport(const std::string& path);
+    static void printSummary();
+};
+
+#endif
@@ -0,0 +1,210 @@
+#include "Profiler.hpp"
+#include "NullGL.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+
+void Profiler::History::push(float value)
+{
+    m_Values[m_Next] = value;
+    m_Next = (m_Next + 1) % HISTORY_SIZE;
+    m_Count = std::min(m_Count + 1, HISTORY_SIZE);
+}
+
+Profiler::Stats Profiler::History::stats() const
+{
+    Stats stats;
+    if (m_Count == 0)
+        return stats;
+
+    std::array<float, HISTORY_SIZE> sorted;
+    std::copy_n(m_Values.begin(), m_Count, sorted.begin());
+    std::sort(sorted.begin(), sorted.begin() + m_Count);
+
+    float sum = 0.f;
+    for (unsigned int i = 0; i < m_Count; i++)
+        sum += sorted[i];
+
+    // nearest rank
+    const auto percentile = [&](float p) {
+        unsigned int rank = static_cast<unsigned int>(p * m_Count + .999f);
+        return sorted[std::clamp(rank, 1u, m_Count) - 1];
+    };
+
+    stats.average = sum / m_Count;
+    stats.p95 = percentile(.95f);
+    stats.p99 = percentile(.99f);
+    return stats;
+}
+
+Profiler::Scope::Scope(const Profiler::Ptr& profiler, const std::string& name)
+    : m_Profiler(profiler.get())
+{
+    if (m_Profiler)
+        m_Profiler->push(name);
+}
+
+Profiler::Scope::~Scope()
+{
+    if (m_Profiler)
+        m_Profiler->pop();
+}
+
+Profiler::~Profiler()
+{
+    for (Frame& frame : m_Frames)
+        if (!frame.queries.empty())
+            glDeleteQueries(frame.queries.size(), frame.queries.data());
+}
+
+unsigned int Profiler::nextQuery(Frame& frame)
+{
+    if (frame.usedQueries == frame.queries.size()) {
+        const unsigned int grow = std::max<unsigned int>(frame.queries.size(), 16);
+        frame.queries.resize(frame.queries.size() + grow);
+        glGenQueries(grow, frame.queries.data() + frame.usedQueries);
+    }
+
+    return frame.queries[frame.usedQueries++];
+}
+
+unsigned int Profiler::sectionIndex(const std::string& name, unsigned int depth)
+{
+    auto it = m_SectionIndices.find(name);
+    if (it != m_SectionIndices.end())
+        return it->second;
+
+    Section section;
+    section.name = name;
+    section.depth = depth;
+
+    m_Sections.push_back(section);
+    m_SectionIndices[name] = m_Sections.size() - 1;
+    return m_Sections.size() - 1;
+}
+
+bool Profiler::collect(Frame& frame, bool wait)
+{
+    bool available = true;
+
+    if (!frame.records.empty() && !wait) {
+        // timestamps complete in order, so the last one written decides
+        GLint result = GL_FALSE;
+        glGetQueryObjectiv(frame.lastQuery, GL_QUERY_RESULT_AVAILABLE, &result);
+        available = result == GL_TRUE;
+    }
+
+    if (available && !frame.records.empty()) {
+        // a section may be entered more than once per frame, its sample is the sum
+        std::vector<float> gpu(m_Sections.size(), 0.f);
+        std::vector<float> cpu(m_Sections.size(), 0.f);
+        std::vector<bool> seen(m_Sections.size(), false);
+
+        for (const Record& record : frame.records) {
+            GLuint64 start = 0, end = 0;
+            glGetQueryObjectui64v(record.startQuery, GL_QUERY_RESULT, &start);
+            glGetQueryObjectui64v(record.endQuery, GL_QUERY_RESULT, &end);
+
+            gpu[record.section] += (end - start) / 1e6f;
+            cpu[record.section] += (record.cpuEnd - record.cpuStart) / 1e3f;
+            seen[record.section] = true;
+
+            // nanoseconds on the GPU clock to microseconds on the trace clock
+            const auto to_trace = [&](GLuint64 timestamp) {
+                return frame.cpuReference + (static_cast<GLint64>(timestamp) - frame.gpuReference) / 1e3;
+            };
+            Trace::recordGpu(m_Sections[record.section].name, to_trace(start), to_trace(end));
+        }
+
+        if (m_FrameCallback && !frame.records.empty() && m_Sections[frame.records[0].section].name == FRAME) {
+            const unsigned int section = frame.records[0].section;
+            m_FrameCallback(frame.index, gpu[section], cpu[section]);
+        }
+
+        for (unsigned int i = 0; i < m_Sections.size(); i++) {
+            if (!seen[i]) continue;
+
+            Section& section = m_Sections[i];
+            section.gpu.push(gpu[i]);
+            section.cpu.push(cpu[i]);
+            section.gpuStats = section.gpu.stats();
+            section.cpuStats = section.cpu.stats();
+        }
+    }
+
+    frame.records.clear();
+    frame.usedQueries = 0;
+    return available;
+}
+
+void Profiler::beginFrame()
+{
+    if (!collect(m_Frames[m_Current], false))
+        m_DroppedFrames++;
+
+    m_Frames[m_Current].index = m_FrameIndex++;
+    push(FRAME);
+}
+
+void Profiler::endFrame()
+{
+    pop();
+
+    m_Current = (m_Current + 1) % FRAME_LATENCY;
+}
+
+void Profiler::push(const std::string& name)
+{
+    Frame& frame = m_Frames[m_Current];
+
+    if (frame.records.empty()) {
+        glGetInteger64v(GL_TIMESTAMP, &frame.gpuReference);
+        frame.cpuReference = Trace::now();
+    }
+
+    Record record;
+    record.section = sectionIndex(name, m_Stack.size());
+    record.startQuery = nextQuery(frame);
+    record.endQuery = nextQuery(frame);
+    record.cpuStart = Trace::now();
+
+    Trace::pushDebugGroup(name);
+    NullGL::pushSection(name);
+    glQueryCounter(record.startQuery, GL_TIMESTAMP);
+
+    frame.records.push_back(record);
+    m_Stack.push_back(frame.records.size() - 1);
+}
+
+void Profiler::pop()
+{
+    Frame& frame = m_Frames[m_Current];
+    Record& record = frame.records[m_Stack.back()];
+    m_Stack.pop_back();
+
+    glQueryCounter(record.endQuery, GL_TIMESTAMP);
+    frame.lastQuery = record.endQuery;
+    NullGL::popSection();
+    Trace::popDebugGroup();
+
+    record.cpuEnd = Trace::now();
+    Trace::record(m_Sections[record.section].name, record.cpuStart, record.cpuEnd);
+}
+
+void Profiler::flush()
+{
+    collect(m_Frames[m_Current], true);
+}
+
+void Profiler::finish()
+{
+    // after endFrame() the current slot holds the oldest frame
+    for (unsigned int i = 0; i < FRAME_LATENCY; i++)
+        collect(m_Frames[(m_Current + i) % FRAME_LATENCY], true);
+}
+
+const Profiler::Section* Profiler::getSection(const std::string& name) const
+{
+    auto it = m_SectionIndices.find(name);
+    return it != m_SectionIndices.end() ? &m_Sections[it->second] : nullptr;
+}
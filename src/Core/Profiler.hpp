@@ -0,0 +1,139 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "Util/MoveOnly.hpp"
+#include "Util/Ptr.hpp"
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Hierarchical GPU and CPU timings of named scopes. Each scope is bracketed
+// by a pair of GL_TIMESTAMP queries, so scopes can nest, and the queries of
+// a frame are only read back FRAME_LATENCY frames later. Results that are
+// still in flight by then are dropped rather than waited on. Scopes are also
+// forwarded to the Trace, as KHR_debug groups and CPU and GPU zones.
+class Profiler {
+    MAKE_NON_MOVABLE(Profiler)
+    GENERATE_PTR(Profiler)
+public:
+    constexpr static unsigned int FRAME_LATENCY = 4;
+    constexpr static unsigned int HISTORY_SIZE = 240;
+
+    struct Stats {
+        float average = 0.f;
+        float p95 = 0.f;
+        float p99 = 0.f;
+    };
+
+    // rolling window of the last HISTORY_SIZE samples, oldest at getOffset()
+    class History {
+    private:
+        std::array<float, HISTORY_SIZE> m_Values {};
+        unsigned int m_Count = 0;
+        unsigned int m_Next = 0;
+    public:
+        void push(float value);
+        Stats stats() const;
+
+        inline float last() const { return m_Count ? m_Values[(m_Next + HISTORY_SIZE - 1) % HISTORY_SIZE] : 0.f; }
+        inline const float* data() const { return m_Values.data(); }
+        inline unsigned int size() const { return m_Count; }
+        inline unsigned int getOffset() const { return m_Count < HISTORY_SIZE ? 0 : m_Next; }
+    };
+
+    // GPU and CPU milliseconds of a whole frame, once its queries are read back
+    using FrameCallback = std::function<void(uint64_t frame, float gpu_ms, float cpu_ms)>;
+
+    struct Section {
+        std::string name;
+        unsigned int depth;
+        History gpu;
+        History cpu;
+        Stats gpuStats;
+        Stats cpuStats;
+    };
+
+    // times the enclosing block
+    class Scope {
+    private:
+        Profiler* m_Profiler;
+    public:
+        Scope(const Profiler::Ptr& profiler, const std::string& name);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+private:
+    struct Record {
+        unsigned int section;
+        unsigned int startQuery;
+        unsigned int endQuery;
+        double cpuStart;
+        double cpuEnd = 0.0;
+    };
+
+    struct Frame {
+        uint64_t index = 0;
+        std::vector<unsigned int> queries;
+        unsigned int usedQueries = 0;
+        unsigned int lastQuery = 0;
+        std::vector<Record> records;
+
+        // GPU clock against the trace clock when the first scope began
+        GLint64 gpuReference = 0;
+        double cpuReference = 0.0;
+    };
+
+    std::array<Frame, FRAME_LATENCY> m_Frames;
+    unsigned int m_Current = 0;
+    std::vector<unsigned int> m_Stack;
+
+    std::vector<Section> m_Sections;
+    std::unordered_map<std::string, unsigned int> m_SectionIndices;
+
+    unsigned int m_DroppedFrames = 0;
+    uint64_t m_FrameIndex = 0;
+
+    FrameCallback m_FrameCallback;
+
+    unsigned int nextQuery(Frame& frame);
+    unsigned int sectionIndex(const std::string& name, unsigned int depth);
+    // true if the results were available, the frame is reset either way
+    bool collect(Frame& frame, bool wait);
+
+public:
+    // name of the section spanning beginFrame() to endFrame()
+    inline static const std::string FRAME = "Frame";
+
+    Profiler() = default;
+    ~Profiler();
+
+    void beginFrame();
+    void endFrame();
+
+    void push(const std::string& name);
+    void pop();
+
+    // blocks on everything recorded so far, for one-off work outside the frame loop
+    void flush();
+    // blocks on the frames still in flight, oldest first
+    void finish();
+
+    inline void setFrameCallback(FrameCallback callback) { m_FrameCallback = std::move(callback); }
+    // index the next beginFrame() gets
+    inline uint64_t getFrameIndex() const { return m_FrameIndex; }
+
+    inline const std::vector<Section>& getSections() const { return m_Sections; }
+    const Section* getSection(const std::string& name) const;
+    inline unsigned int getDroppedFrames() const { return m_DroppedFrames; }
+};
+
+#endif
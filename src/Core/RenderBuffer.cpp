@@ -7,6 +7,10 @@ RenderBuffer::RenderBuffer(RBType type, int width, int height): m_Type{type}
     resize(width, height);
 }
 
+RenderBuffer::~RenderBuffer() {
+    glDeleteRenderbuffers(1, &m_BufferID);
+}
+
 void RenderBuffer::resize(unsigned int width, unsigned int height) const {
     bind();
 
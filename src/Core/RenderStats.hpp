@@ -0,0 +1,42 @@
+#ifndef RENDER_STATS_H
+#define RENDER_STATS_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+
+// GL work issued during a frame, counted where draws and binds are issued.
+// Binds are counted per call, redundant ones included.
+struct RenderStats {
+    uint64_t drawCalls = 0;
+    uint64_t triangles = 0;
+    uint64_t programBinds = 0;
+    uint64_t textureBinds = 0;
+    uint64_t framebufferBinds = 0;
+    uint64_t vertexArrayBinds = 0;
+
+    inline uint64_t stateChanges() const {
+        return programBinds + textureBinds + framebufferBinds + vertexArrayBinds;
+    }
+
+    static RenderStats s_Current;
+    // what s_Current held at the last endFrame()
+    static RenderStats s_LastFrame;
+
+    inline static void beginFrame() { s_Current = RenderStats(); }
+    inline static void endFrame() { s_LastFrame = s_Current; }
+
+    inline static void countDraw(GLenum primitive, uint64_t vertices, uint64_t instances = 1) {
+        s_Current.drawCalls++;
+
+        if (primitive == GL_TRIANGLES)
+            s_Current.triangles += vertices / 3 * instances;
+        else if ((primitive == GL_TRIANGLE_STRIP || primitive == GL_TRIANGLE_FAN) && vertices > 2)
+            s_Current.triangles += (vertices - 2) * instances;
+    }
+};
+
+inline RenderStats RenderStats::s_Current;
+inline RenderStats RenderStats::s_LastFrame;
+
+#endif
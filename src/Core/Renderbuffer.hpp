@@ -15,7 +15,7 @@ enum class RBType {
 };
 
 class RenderBuffer {
-    MAKE_MOVE_ONLY(RenderBuffer)
+    MAKE_NON_MOVABLE(RenderBuffer)
     GENERATE_PTR(RenderBuffer)
 private:
     unsigned int m_BufferID;
@@ -24,6 +24,7 @@ public:
     RBType m_Type;
 
     RenderBuffer(RBType type, int width, int height);
+    ~RenderBuffer();
     void resize(unsigned int width, unsigned int height) const;
 
     inline void bind() const {
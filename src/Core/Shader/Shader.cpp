@@ -1,93 +1,525 @@
 #include "Shader.hpp"
+#include "Core/RenderStats.hpp"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+typedef void (*PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+
+bool Shader::s_ParallelCompile = false;
+
+std::string Shader::s_BinaryCacheDir;
+unsigned int Shader::s_BinaryCacheHits = 0;
+unsigned int Shader::s_BinaryCacheMisses = 0;
 
 Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath, const std::string& geometryPath)
 {
-    // 1. retrieve the vertex/fragment source code from filePath
-    std::string vertexCode;
-    std::string fragmentCode;
-    std::string geometryCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
-    std::ifstream gShaderFile;
-    // ensure ifstream objects can throw exceptions:
-    vShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-    fShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-    gShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-    try
+    m_Stages.push_back({GL_VERTEX_SHADER, vertexPath});
+    m_Stages.push_back({GL_FRAGMENT_SHADER, fragmentPath});
+    // if geometry shader path is present, also load a geometry shader
+    if(!geometryPath.empty())
+        m_Stages.push_back({GL_GEOMETRY_SHADER, geometryPath});
+
+    build();
+}
+
+Shader::Shader(const std::string& computePath)
+{
+    m_Stages.push_back({GL_COMPUTE_SHADER, computePath});
+
+    build();
+}
+
+Shader::~Shader()
+{
+    discardReload();
+    for (unsigned int shader : m_BuildStages)
+        glDeleteShader(shader);
+    glDeleteProgram(ID);
+
+    std::erase(instances(), this);
+}
+
+void Shader::build()
+{
+    instances().push_back(this);
+    m_Building = true;
+
+    // 1. retrieve the source code of every stage
+    for (const Stage& stage : m_Stages)
     {
-        // open files
-        vShaderFile.open(vertexPath);
-        fShaderFile.open(fragmentPath);
-        std::stringstream vShaderStream, fShaderStream;
-        // read file's buffer contents into streams
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
-        // close file handlers
-        vShaderFile.close();
-        fShaderFile.close();
-        // convert stream into string
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
-        // if geometry shader path is present, also load a geometry shader
-        if(!geometryPath.empty())
-        {
-            gShaderFile.open(geometryPath);
-            std::stringstream gShaderStream;
-            gShaderStream << gShaderFile.rdbuf();
-            gShaderFile.close();
-            geometryCode = gShaderStream.str();
-        }
+        std::string code;
+        readSource(stage.path, code);
+        m_BuildSources.push_back(std::move(code));
     }
-    catch (std::ifstream::failure& e)
-    {
-        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << "::" << vertexPath << "::" << fragmentPath << std::endl;
-    }
-    const char* vShaderCode = vertexCode.c_str();
-    const char * fShaderCode = fragmentCode.c_str();
-    // 2. compile shaders
-    unsigned int vertex, fragment;
-    // vertex shader
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, NULL);
-    glCompileShader(vertex);
-    checkCompileErrors(vertex, "VERTEX");
-    // fragment Shader
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    glCompileShader(fragment);
-    checkCompileErrors(fragment, "FRAGMENT");
-    // if geometry shader is given, compile geometry shader
-    unsigned int geometry;
-    if(!geometryPath.empty())
+    // 2. a binary linked by this driver for the same sources skips compiling
+    m_BuildCachePath = binaryCachePath(m_BuildSources);
+    m_BuildFromBinary = !m_BuildCachePath.empty() && loadBinary(m_BuildCachePath);
+    if (m_BuildFromBinary)
+        return;
+    // 3. compile every stage and link, nothing is queried until resolve()
+    compileSources();
+}
+
+void Shader::compileSources()
+{
+    for (unsigned int i = 0; i < m_Stages.size(); i++)
     {
-        const char * gShaderCode = geometryCode.c_str();
-        geometry = glCreateShader(GL_GEOMETRY_SHADER);
-        glShaderSource(geometry, 1, &gShaderCode, NULL);
-        glCompileShader(geometry);
-        checkCompileErrors(geometry, "GEOMETRY");
+        const char* shaderCode = m_BuildSources[i].c_str();
+
+        unsigned int shader = glCreateShader(m_Stages[i].type);
+        glShaderSource(shader, 1, &shaderCode, NULL);
+        glCompileShader(shader);
+
+        m_BuildStages.push_back(shader);
     }
     // shader Program
     ID = glCreateProgram();
-    glAttachShader(ID, vertex);
-    glAttachShader(ID, fragment);
-    if(!geometryPath.empty())
-        glAttachShader(ID, geometry);
+    for (unsigned int shader : m_BuildStages)
+        glAttachShader(ID, shader);
+    if (!m_BuildCachePath.empty())
+        glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(ID);
+}
+
+void Shader::resolve()
+{
+    if (!m_Building)
+        return;
+    m_Building = false;
+
+    // a driver update may reject old binaries, compile from source then
+    if (m_BuildFromBinary)
+    {
+        GLint success = GL_FALSE;
+        glGetProgramiv(ID, GL_LINK_STATUS, &success);
+
+        if (success)
+        {
+            s_BinaryCacheHits++;
+            m_BuildSources.clear();
+            return;
+        }
+
+        glDeleteProgram(ID);
+        std::error_code error;
+        std::filesystem::remove(m_BuildCachePath, error);
+
+        s_BinaryCacheMisses++;
+        compileSources();
+    }
+
+    for (unsigned int i = 0; i < m_BuildStages.size(); i++)
+        checkCompileErrors(m_BuildStages[i], stageName(m_Stages[i].type));
     checkCompileErrors(ID, "PROGRAM");
     // delete the shaders as they're linked into our program now and no longer necessary
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
-    if(!geometryPath.empty())
-        glDeleteShader(geometry);
+    for (unsigned int shader : m_BuildStages)
+        glDeleteShader(shader);
+    m_BuildStages.clear();
+    m_BuildSources.clear();
 
+    if (!m_BuildCachePath.empty())
+        saveBinary(m_BuildCachePath);
 }
 
 void Shader::use()
 {
+    resolve();
+    RenderStats::s_Current.programBinds++;
     glUseProgram(ID);
 }
 
-void Shader::checkCompileErrors(GLuint shader, std::string type)
+bool Shader::isReady() const
+{
+    if (!m_Building)
+        return true;
+
+    // without the extension any status query would wait for the compile
+    if (!s_ParallelCompile)
+        return false;
+
+    GLint done = GL_FALSE;
+    glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &done);
+    return done;
+}
+
+void Shader::dispatch(unsigned int groups_x, unsigned int groups_y, unsigned int groups_z)
+{
+    resolve();
+    glUseProgram(ID);
+    glDispatchCompute(groups_x, groups_y, groups_z);
+}
+
+bool Shader::usesFile(const std::string& filename) const
+{
+    return std::any_of(m_Stages.begin(), m_Stages.end(), [&](const Stage& stage) {
+        return std::filesystem::path(stage.path).filename() == filename;
+    });
+}
+
+bool Shader::beginReload()
+{
+    resolve();
+    discardReload();
+
+    std::vector<std::string> sources;
+    for (const Stage& stage : m_Stages)
+    {
+        std::string code;
+        if (!readSource(stage.path, code))
+            return false;
+        sources.push_back(std::move(code));
+    }
+    m_PendingCachePath = binaryCachePath(sources);
+
+    // nothing is queried here, so a driver with parallel compile returns immediately
+    m_PendingID = glCreateProgram();
+    for (unsigned int i = 0; i < m_Stages.size(); i++)
+    {
+        const char* shaderCode = sources[i].c_str();
+
+        unsigned int shader = glCreateShader(m_Stages[i].type);
+        glShaderSource(shader, 1, &shaderCode, NULL);
+        glCompileShader(shader);
+        glAttachShader(m_PendingID, shader);
+
+        m_PendingStages.push_back(shader);
+    }
+    if (!s_BinaryCacheDir.empty())
+        glProgramParameteri(m_PendingID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(m_PendingID);
+
+    return true;
+}
+
+Shader::ReloadStatus Shader::pollReload()
+{
+    if (m_PendingID == 0)
+        return ReloadStatus::Idle;
+
+    if (s_ParallelCompile)
+    {
+        GLint done = GL_FALSE;
+        glGetProgramiv(m_PendingID, GL_COMPLETION_STATUS_KHR, &done);
+        if (!done)
+            return ReloadStatus::Pending;
+    }
+
+    bool success = true;
+    for (unsigned int i = 0; i < m_PendingStages.size(); i++)
+        success = checkCompileErrors(m_PendingStages[i], stageName(m_Stages[i].type), false) && success;
+    success = success && checkCompileErrors(m_PendingID, "PROGRAM", false);
+
+    if (!success)
+    {
+        discardReload();
+        return ReloadStatus::Failed;
+    }
+
+    // uniforms set once at setup would otherwise be lost with the old program
+    copyUniforms(ID, m_PendingID);
+
+    glDeleteProgram(ID);
+    ID = m_PendingID;
+
+    for (unsigned int shader : m_PendingStages)
+        glDeleteShader(shader);
+
+    m_PendingID = 0;
+    m_PendingStages.clear();
+
+    // the next launch starts with the edited program
+    if (!m_PendingCachePath.empty())
+        saveBinary(m_PendingCachePath);
+
+    return ReloadStatus::Swapped;
+}
+
+void Shader::discardReload()
+{
+    for (unsigned int shader : m_PendingStages)
+        glDeleteShader(shader);
+    m_PendingStages.clear();
+
+    if (m_PendingID != 0)
+        glDeleteProgram(m_PendingID);
+    m_PendingID = 0;
+}
+
+bool Shader::enableBinaryCache(const std::string& directory)
+{
+    if (!GLAD_GL_VERSION_4_1)
+        return false;
+
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats == 0)
+        return false;
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+    {
+        std::cout << "ERROR::SHADER::BINARY_CACHE_NOT_CREATED: " << error.message() << "::" << directory << std::endl;
+        return false;
+    }
+
+    s_BinaryCacheDir = directory;
+    return true;
+}
+
+unsigned int Shader::getBinaryCacheHits()
+{
+    return s_BinaryCacheHits;
+}
+
+unsigned int Shader::getBinaryCacheMisses()
+{
+    return s_BinaryCacheMisses;
+}
+
+std::string Shader::binaryCachePath(const std::vector<std::string>& sources) const
+{
+    if (s_BinaryCacheDir.empty())
+        return "";
+
+    // FNV-1a, stable across runs unlike std::hash
+    uint64_t hash = 14695981039346656037ull;
+    const auto combine = [&hash](const std::string& text) {
+        for (unsigned char c : text)
+        {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        // separator, so moving text between parts changes the key
+        hash ^= 0xff;
+        hash *= 1099511628211ull;
+    };
+
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION })
+        combine(reinterpret_cast<const char*>(glGetString(name)));
+
+    for (unsigned int i = 0; i < m_Stages.size(); i++)
+    {
+        combine(stageName(m_Stages[i].type));
+        combine(sources[i]);
+    }
+
+    std::ostringstream path;
+    path << s_BinaryCacheDir << std::hex << std::setw(16) << std::setfill('0') << hash << ".bin";
+    return path.str();
+}
+
+bool Shader::loadBinary(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        s_BinaryCacheMisses++;
+        return false;
+    }
+
+    GLenum format = 0;
+    file.read(reinterpret_cast<char*>(&format), sizeof(format));
+    std::vector<char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+
+    if (binary.empty())
+    {
+        std::error_code error;
+        std::filesystem::remove(path, error);
+
+        s_BinaryCacheMisses++;
+        return false;
+    }
+
+    // whether the driver accepted it is checked in resolve()
+    ID = glCreateProgram();
+    glProgramBinary(ID, format, binary.data(), binary.size());
+    return true;
+}
+
+void Shader::saveBinary(const std::string& path) const
+{
+    GLint length = 0;
+    glGetProgramiv(ID, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    GLenum format = 0;
+    std::vector<char> binary(length);
+    glGetProgramBinary(ID, length, NULL, &format, binary.data());
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+    file.write(binary.data(), binary.size());
+}
+
+std::vector<Shader*>& Shader::instances()
+{
+    static std::vector<Shader*>* instances = new std::vector<Shader*>();
+    return *instances;
+}
+
+const std::vector<Shader*>& Shader::getInstances()
+{
+    return instances();
+}
+
+void Shader::finishAll()
+{
+    for (Shader* shader : instances())
+        shader->resolve();
+}
+
+unsigned int Shader::countCompiling()
+{
+    return std::count_if(instances().begin(), instances().end(), [](const Shader* shader) {
+        return !shader->isReady();
+    });
+}
+
+bool Shader::enableParallelCompile()
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+    for (GLint i = 0; i < count; i++)
+    {
+        const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (std::string(extension) != "GL_KHR_parallel_shader_compile")
+            continue;
+
+        // the loader is generated without extensions, so fetch the entry point here
+        auto maxShaderCompilerThreads = reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(
+            glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+
+        if (maxShaderCompilerThreads != nullptr)
+            maxShaderCompilerThreads(0xFFFFFFFF);
+
+        s_ParallelCompile = true;
+        break;
+    }
+
+    return s_ParallelCompile;
+}
+
+bool Shader::readSource(const std::string& path, std::string& code)
+{
+    std::ifstream shaderFile;
+    // ensure ifstream objects can throw exceptions:
+    shaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
+    try
+    {
+        shaderFile.open(path);
+        std::stringstream shaderStream;
+        shaderStream << shaderFile.rdbuf();
+        shaderFile.close();
+        code = shaderStream.str();
+    }
+    catch (std::ifstream::failure& e)
+    {
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << "::" << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+const char* Shader::stageName(GLenum type)
+{
+    switch (type)
+    {
+        case GL_VERTEX_SHADER: return "VERTEX";
+        case GL_FRAGMENT_SHADER: return "FRAGMENT";
+        case GL_GEOMETRY_SHADER: return "GEOMETRY";
+        case GL_COMPUTE_SHADER: return "COMPUTE";
+        default: return "UNKNOWN";
+    }
+}
+
+void Shader::copyUniforms(unsigned int from, unsigned int to)
+{
+    GLint previous = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previous);
+    glUseProgram(to);
+
+    GLint count = 0;
+    glGetProgramiv(from, GL_ACTIVE_UNIFORMS, &count);
+
+    for (GLint i = 0; i < count; i++)
+    {
+        GLchar name[256];
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(from, i, sizeof(name), NULL, &size, &type, name);
+
+        // a uniform that changed type in the new source keeps its default
+        const GLchar* names[] = { name };
+        GLuint index = GL_INVALID_INDEX;
+        glGetUniformIndices(to, 1, names, &index);
+        if (index == GL_INVALID_INDEX)
+            continue;
+
+        GLint newType = 0;
+        glGetActiveUniformsiv(to, 1, &index, GL_UNIFORM_TYPE, &newType);
+        if (static_cast<GLenum>(newType) != type)
+            continue;
+
+        // arrays are reported once as "name[0]"
+        std::string base = name;
+        if (size > 1 && base.ends_with("[0]"))
+            base.resize(base.size() - 3);
+
+        for (GLint element = 0; element < size; element++)
+        {
+            const std::string element_name = size > 1 ? base + "[" + std::to_string(element) + "]" : base;
+
+            GLint src = glGetUniformLocation(from, element_name.c_str());
+            GLint dst = glGetUniformLocation(to, element_name.c_str());
+            if (src < 0 || dst < 0)
+                continue;
+
+            GLfloat f[16];
+            GLint v[4];
+            GLuint u[4];
+
+            switch (type)
+            {
+                case GL_FLOAT:      glGetUniformfv(from, src, f); glUniform1fv(dst, 1, f); break;
+                case GL_FLOAT_VEC2: glGetUniformfv(from, src, f); glUniform2fv(dst, 1, f); break;
+                case GL_FLOAT_VEC3: glGetUniformfv(from, src, f); glUniform3fv(dst, 1, f); break;
+                case GL_FLOAT_VEC4: glGetUniformfv(from, src, f); glUniform4fv(dst, 1, f); break;
+                case GL_FLOAT_MAT2: glGetUniformfv(from, src, f); glUniformMatrix2fv(dst, 1, GL_FALSE, f); break;
+                case GL_FLOAT_MAT3: glGetUniformfv(from, src, f); glUniformMatrix3fv(dst, 1, GL_FALSE, f); break;
+                case GL_FLOAT_MAT4: glGetUniformfv(from, src, f); glUniformMatrix4fv(dst, 1, GL_FALSE, f); break;
+
+                case GL_INT_VEC2: case GL_BOOL_VEC2: glGetUniformiv(from, src, v); glUniform2iv(dst, 1, v); break;
+                case GL_INT_VEC3: case GL_BOOL_VEC3: glGetUniformiv(from, src, v); glUniform3iv(dst, 1, v); break;
+                case GL_INT_VEC4: case GL_BOOL_VEC4: glGetUniformiv(from, src, v); glUniform4iv(dst, 1, v); break;
+
+                case GL_UNSIGNED_INT:      glGetUniformuiv(from, src, u); glUniform1uiv(dst, 1, u); break;
+                case GL_UNSIGNED_INT_VEC2: glGetUniformuiv(from, src, u); glUniform2uiv(dst, 1, u); break;
+                case GL_UNSIGNED_INT_VEC3: glGetUniformuiv(from, src, u); glUniform3uiv(dst, 1, u); break;
+                case GL_UNSIGNED_INT_VEC4: glGetUniformuiv(from, src, u); glUniform4uiv(dst, 1, u); break;
+
+                // int, bool and every sampler and image type
+                default: glGetUniformiv(from, src, v); glUniform1iv(dst, 1, v); break;
+            }
+        }
+    }
+
+    glUseProgram(previous);
+}
+
+bool Shader::checkCompileErrors(GLuint shader, std::string type, bool fatal)
 {
     GLint success;
     GLchar infoLog[1024];
@@ -98,7 +530,8 @@ void Shader::checkCompileErrors(GLuint shader, std::string type)
         {
             glGetShaderInfoLog(shader, 1024, NULL, infoLog);
             std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
-            std::exit(11);
+            if (fatal)
+                std::exit(11);
         }
     }
     else
@@ -108,7 +541,9 @@ void Shader::checkCompileErrors(GLuint shader, std::string type)
         {
             glGetProgramInfoLog(shader, 1024, NULL, infoLog);
             std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
-            std::exit(12);
+            if (fatal)
+                std::exit(12);
         }
     }
+    return success;
 }
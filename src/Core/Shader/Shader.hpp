@@ -1,6 +1,7 @@
 #ifndef SHADER_H
 #define SHADER_H
 
+#include "Util/MoveOnly.hpp"
 #include "Util/Ptr.hpp"
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -9,16 +10,50 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
 
 class Shader
 {
+    MAKE_NON_MOVABLE(Shader)
     GENERATE_PTR(Shader)
 public:
-    unsigned int ID;
-    // constructor generates the shader on the fly
+    enum class ReloadStatus { Idle, Pending, Swapped, Failed };
+
+    unsigned int ID = 0;
+    // constructor only issues the compile, its status is checked on first use
+    // so the driver can work on several programs while the CPU moves on
     // ------------------------------------------------------------------------
     Shader(const std::string& vertexPath, const std::string& fragmentPath, const std::string& geometryPath = "");
+    // compute-only program, needs a 4.3 context
+    explicit Shader(const std::string& computePath);
+    ~Shader();
     void use();
+    // false while the driver is still compiling, never blocks
+    bool isReady() const;
+    void dispatch(unsigned int groups_x, unsigned int groups_y = 1, unsigned int groups_z = 1);
+
+    // hot reload: the new program is linked next to the old one and only
+    // replaces ID once it linked, a failed reload keeps the old program
+    bool usesFile(const std::string& filename) const;
+    bool beginReload();
+    ReloadStatus pollReload();
+
+    // every shader alive, so a changed file can be mapped to its programs
+    static const std::vector<Shader*>& getInstances();
+
+    // waits for every program still compiling and checks its status
+    static void finishAll();
+    static unsigned int countCompiling();
+
+    // lets the driver compile on its own threads through
+    // GL_KHR_parallel_shader_compile, false if the extension is missing
+    static bool enableParallelCompile();
+
+    // Linked programs are stored in directory and loaded instead of compiled
+    // next time. Needs GL 4.1 and a driver exposing binary formats.
+    static bool enableBinaryCache(const std::string& directory);
+    static unsigned int getBinaryCacheHits();
+    static unsigned int getBinaryCacheMisses();
 
 
     // utility uniform functions
@@ -46,6 +81,10 @@ public:
     {
         glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
     }
+    inline void setIVec2(const std::string &name, const glm::ivec2 &value) const
+    {
+        glUniform2iv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    }
     // ------------------------------------------------------------------------
     inline void setVec3(const std::string &name, const glm::vec3 &value) const
     {
@@ -81,7 +120,49 @@ public:
     }
 
 private:
-    void checkCompileErrors(GLuint shader, std::string type);
+    struct Stage {
+        GLenum type;
+        std::string path;
+    };
+
+    std::vector<Stage> m_Stages;
+
+    // set between the constructor and the first status check
+    bool m_Building = false;
+    bool m_BuildFromBinary = false;
+    std::vector<std::string> m_BuildSources;
+    std::vector<unsigned int> m_BuildStages;
+    std::string m_BuildCachePath;
+
+    // program and stages of a reload still being compiled, 0 when idle
+    unsigned int m_PendingID = 0;
+    std::vector<unsigned int> m_PendingStages;
+    std::string m_PendingCachePath;
+
+    // never destroyed, shaders released during static destruction still unregister
+    static std::vector<Shader*>& instances();
+    static bool s_ParallelCompile;
+
+    static std::string s_BinaryCacheDir;
+    static unsigned int s_BinaryCacheHits;
+    static unsigned int s_BinaryCacheMisses;
+
+    void build();
+    void compileSources();
+    void resolve();
+    void discardReload();
+
+    // identifies a program by its sources and the driver that compiles them
+    std::string binaryCachePath(const std::vector<std::string>& sources) const;
+    bool loadBinary(const std::string& path);
+    void saveBinary(const std::string& path) const;
+
+    static bool readSource(const std::string& path, std::string& code);
+    static const char* stageName(GLenum type);
+    static void copyUniforms(unsigned int from, unsigned int to);
+
+    // fatal errors exit, which is what a broken shader at startup should do
+    bool checkCompileErrors(GLuint shader, std::string type, bool fatal = true);
 };
 
 #endif
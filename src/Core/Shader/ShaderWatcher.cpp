@@ -0,0 +1,95 @@
+#include "ShaderWatcher.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+ShaderWatcher::ShaderWatcher(const std::string& directory):
+    m_Directory{directory}
+{
+#ifdef __linux__
+    m_Inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    // editors either rewrite the file or rename a temporary over it
+    if (m_Inotify >= 0 && inotify_add_watch(m_Inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        close(m_Inotify);
+        m_Inotify = -1;
+    }
+
+    if (m_Inotify >= 0) return;
+
+    std::cout << "WARNING::SHADER_WATCHER:: inotify unavailable, polling " << directory << std::endl;
+#endif
+
+    scan();
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+#ifdef __linux__
+    if (m_Inotify >= 0)
+        close(m_Inotify);
+#endif
+}
+
+std::vector<std::string> ShaderWatcher::poll()
+{
+    std::vector<std::string> changed;
+
+#ifdef __linux__
+    if (m_Inotify >= 0) {
+        alignas(inotify_event) char buffer[4096];
+
+        ssize_t length;
+        while ((length = read(m_Inotify, buffer, sizeof(buffer))) > 0) {
+            for (char* ptr = buffer; ptr < buffer + length; ) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(ptr);
+
+                if (event->len > 0 &&
+                    std::find(changed.begin(), changed.end(), event->name) == changed.end())
+                    changed.push_back(event->name);
+
+                ptr += sizeof(inotify_event) + event->len;
+            }
+        }
+
+        return changed;
+    }
+#endif
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now - m_LastScan < SCAN_INTERVAL)
+        return changed;
+
+    return scan();
+}
+
+std::vector<std::string> ShaderWatcher::scan()
+{
+    std::vector<std::string> changed;
+    std::error_code error;
+
+    m_LastScan = std::chrono::steady_clock::now();
+
+    for (const auto& entry : std::filesystem::directory_iterator(m_Directory, error)) {
+        if (!entry.is_regular_file(error)) continue;
+
+        const std::string name = entry.path().filename().string();
+        const auto time = entry.last_write_time(error);
+
+        auto known = m_WriteTimes.find(name);
+
+        if (known == m_WriteTimes.end()) {
+            m_WriteTimes.emplace(name, time);
+        } else if (known->second != time) {
+            known->second = time;
+            changed.push_back(name);
+        }
+    }
+
+    return changed;
+}
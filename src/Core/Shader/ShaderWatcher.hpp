@@ -0,0 +1,41 @@
+#ifndef SHADER_WATCHER_H
+#define SHADER_WATCHER_H
+
+#include "Util/MoveOnly.hpp"
+#include "Util/Ptr.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Reports the files written in a shader directory. Uses inotify on Linux,
+// elsewhere it compares modification times a few times per second.
+class ShaderWatcher {
+    MAKE_NON_MOVABLE(ShaderWatcher)
+    GENERATE_PTR(ShaderWatcher)
+private:
+    constexpr static std::chrono::milliseconds SCAN_INTERVAL{500};
+
+    std::string m_Directory;
+
+    int m_Inotify = -1;
+
+    std::unordered_map<std::string, std::filesystem::file_time_type> m_WriteTimes;
+    std::chrono::steady_clock::time_point m_LastScan;
+
+    std::vector<std::string> scan();
+
+public:
+    explicit ShaderWatcher(const std::string& directory);
+    ~ShaderWatcher();
+
+    // file names changed since the last call, never blocks
+    std::vector<std::string> poll();
+
+    inline bool isNative() const { return m_Inotify >= 0; }
+    inline const std::string& getDirectory() const { return m_Directory; }
+};
+
+#endif
@@ -4,6 +4,7 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include "Core/RenderStats.hpp"
 #include "Core/VertexBuffer.hpp"
 #include "Core/VertexArray.hpp"
 
@@ -45,6 +46,7 @@ public:
 
     void draw() {
         m_VAO->bind();
+        RenderStats::countDraw(GL_TRIANGLES, 6);
         glDrawArrays(GL_TRIANGLES, 0, 6);
         m_VAO->unbind();
     }
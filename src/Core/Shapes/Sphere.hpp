@@ -86,5 +86,10 @@ public:
     {
         Mesh::draw(wireframe, GL_TRIANGLE_STRIP);
     }
+
+    virtual void drawInstanced(unsigned int instances, GLenum primitive = GL_TRIANGLE_STRIP) override
+    {
+        Mesh::drawInstanced(instances, GL_TRIANGLE_STRIP);
+    }
 };
 #endif
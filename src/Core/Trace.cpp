@@ -0,0 +1,179 @@
+#include "Trace.hpp"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+
+std::mutex Trace::s_Mutex;
+std::vector<Trace::Event> Trace::s_Events;
+size_t Trace::s_Next = 0;
+size_t Trace::s_Recorded = 0;
+std::unordered_map<std::thread::id, unsigned int> Trace::s_Threads;
+std::vector<std::string> Trace::s_ThreadNames = {"GPU"};
+
+PFNGLPUSHDEBUGGROUPPROC Trace::s_PushDebugGroup = nullptr;
+PFNGLPOPDEBUGGROUPPROC Trace::s_PopDebugGroup = nullptr;
+
+Trace::Zone::Zone(const std::string& name, bool debug_group)
+    : m_Name(name), m_Start(Trace::now()), m_DebugGroup(debug_group)
+{
+    if (m_DebugGroup)
+        Trace::pushDebugGroup(m_Name);
+}
+
+Trace::Zone::~Zone()
+{
+    if (m_DebugGroup)
+        Trace::popDebugGroup();
+
+    Trace::record(m_Name, m_Start, Trace::now());
+}
+
+double Trace::now()
+{
+    static const auto epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+bool Trace::enableDebugGroups()
+{
+    bool supported = GLAD_GL_VERSION_4_3;
+
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+    for (GLint i = 0; i < count && !supported; i++)
+        supported = std::string(reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i))) == "GL_KHR_debug";
+
+    if (!supported)
+        return false;
+
+    // desktop KHR_debug has no suffix, the loader only fetched it for 4.3 contexts
+    s_PushDebugGroup = reinterpret_cast<PFNGLPUSHDEBUGGROUPPROC>(glfwGetProcAddress("glPushDebugGroup"));
+    s_PopDebugGroup = reinterpret_cast<PFNGLPOPDEBUGGROUPPROC>(glfwGetProcAddress("glPopDebugGroup"));
+
+    if (s_PushDebugGroup == nullptr || s_PopDebugGroup == nullptr) {
+        s_PushDebugGroup = nullptr;
+        s_PopDebugGroup = nullptr;
+    }
+
+    return s_PushDebugGroup != nullptr;
+}
+
+void Trace::pushDebugGroup(const std::string& name)
+{
+    if (s_PushDebugGroup)
+        s_PushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, static_cast<GLsizei>(name.size()), name.c_str());
+}
+
+void Trace::popDebugGroup()
+{
+    if (s_PopDebugGroup)
+        s_PopDebugGroup();
+}
+
+unsigned int Trace::threadIndex()
+{
+    auto it = s_Threads.find(std::this_thread::get_id());
+    if (it != s_Threads.end())
+        return it->second;
+
+    const unsigned int index = s_ThreadNames.size();
+    s_ThreadNames.push_back("Worker " + std::to_string(index));
+    s_Threads[std::this_thread::get_id()] = index;
+    return index;
+}
+
+void Trace::nameThread(const std::string& name)
+{
+    std::lock_guard lock(s_Mutex);
+    s_ThreadNames[threadIndex()] = name;
+}
+
+void Trace::push(Event event)
+{
+    if (s_Events.size() < CAPACITY)
+        s_Events.push_back(std::move(event));
+    else
+        s_Events[s_Next] = std::move(event);
+
+    s_Next = (s_Next + 1) % CAPACITY;
+    s_Recorded++;
+}
+
+void Trace::record(const std::string& name, double start, double end)
+{
+    std::lock_guard lock(s_Mutex);
+    push({name, threadIndex(), start, end - start});
+}
+
+void Trace::recordGpu(const std::string& name, double start, double end)
+{
+    std::lock_guard lock(s_Mutex);
+    push({name, GPU_THREAD, start, end - start});
+}
+
+static void writeString(std::ofstream& out, const std::string& value)
+{
+    out << '"';
+    for (char c : value) {
+        if (c == '"' || c == '\\')
+            out << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20)
+            out << ' ';
+        else
+            out << c;
+    }
+    out << '"';
+}
+
+bool Trace::write(const std::string& path)
+{
+    std::lock_guard lock(s_Mutex);
+
+    std::ofstream out(path);
+    if (!out)
+        return false;
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"GLRenderer\"}}";
+
+    for (unsigned int i = 0; i < s_ThreadNames.size(); i++) {
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i << ",\"args\":{\"name\":";
+        writeString(out, s_ThreadNames[i]);
+        out << "}}";
+        // keeps the GPU track on top and the threads in creation order
+        out << ",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i
+            << ",\"args\":{\"sort_index\":" << i << "}}";
+    }
+
+    for (const Event& event : s_Events) {
+        out << ",\n{\"name\":";
+        writeString(out, event.name);
+        out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+            << ",\"ts\":" << event.start << ",\"dur\":" << event.duration << "}";
+    }
+
+    out << "\n]}\n";
+    return out.good();
+}
+
+std::string Trace::defaultPath()
+{
+    const std::time_t time = std::time(nullptr);
+
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", std::localtime(&time));
+    return "trace-" + std::string(stamp) + ".json";
+}
+
+size_t Trace::getEventCount()
+{
+    std::lock_guard lock(s_Mutex);
+    return std::min<size_t>(s_Recorded, CAPACITY);
+}
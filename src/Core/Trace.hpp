@@ -0,0 +1,80 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <glad/glad.h>
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Ring buffer of timed zones from any thread plus the GPU timings resolved
+// by the profiler, written out as Chrome trace JSON (chrome://tracing or
+// ui.perfetto.dev). Times are microseconds on the steady clock.
+class Trace {
+public:
+    constexpr static unsigned int CAPACITY = 1 << 16;
+
+    // records the enclosing block on the calling thread, debug_group also
+    // brackets it with a KHR_debug group and must only be used on the GL thread
+    class Zone {
+    private:
+        std::string m_Name;
+        double m_Start;
+        bool m_DebugGroup;
+    public:
+        Zone(const std::string& name, bool debug_group = false);
+        ~Zone();
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+    };
+
+private:
+    struct Event {
+        std::string name;
+        unsigned int thread;
+        double start;
+        double duration;
+    };
+
+    // the GPU gets its own track next to the CPU threads
+    constexpr static unsigned int GPU_THREAD = 0;
+
+    static std::mutex s_Mutex;
+    static std::vector<Event> s_Events;
+    static size_t s_Next;
+    static size_t s_Recorded;
+    static std::unordered_map<std::thread::id, unsigned int> s_Threads;
+    static std::vector<std::string> s_ThreadNames;
+
+    static PFNGLPUSHDEBUGGROUPPROC s_PushDebugGroup;
+    static PFNGLPOPDEBUGGROUPPROC s_PopDebugGroup;
+
+    static unsigned int threadIndex();
+    static void push(Event event);
+
+public:
+    static double now();
+
+    // GL 4.3 or GL_KHR_debug, zones then show up in GL capture tools
+    static bool enableDebugGroups();
+    static void pushDebugGroup(const std::string& name);
+    static void popDebugGroup();
+
+    // names the calling thread's track, unnamed threads become "Worker N"
+    static void nameThread(const std::string& name);
+
+    static void record(const std::string& name, double start, double end);
+    static void recordGpu(const std::string& name, double start, double end);
+
+    // the oldest events are overwritten once CAPACITY is reached
+    static bool write(const std::string& path);
+    // trace-<date>-<time>.json in the working directory
+    static std::string defaultPath();
+
+    static size_t getEventCount();
+};
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <vector>
 
+#include "RenderStats.hpp"
 #include "Util/MoveOnly.hpp"
 #include "Util/Ptr.hpp"
 #include "VertexBuffer.hpp"
@@ -59,7 +60,7 @@ public:
 };
 
 class VertexArray {
-    MAKE_MOVE_ONLY(VertexArray)
+    MAKE_NON_MOVABLE(VertexArray)
     GENERATE_PTR(VertexArray)
 
 private:
@@ -95,6 +96,7 @@ public:
     }
 
     void bind() const {
+        RenderStats::s_Current.vertexArrayBinds++;
         glBindVertexArray(m_BufferID);
     }
 
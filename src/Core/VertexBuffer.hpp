@@ -7,7 +7,7 @@
 #include <GLFW/glfw3.h>
 
 class VertexBuffer {
-    MAKE_MOVE_ONLY(VertexBuffer)
+    MAKE_NON_MOVABLE(VertexBuffer)
     GENERATE_PTR(VertexBuffer)
 
 
@@ -0,0 +1,87 @@
+#version 330 core
+out vec3 FragColor;
+
+in vec2 TexCoords;
+
+// previous (larger) level of the chain, or the HDR scene for the first pass
+uniform sampler2D srcTexture;
+
+// only the first pass thresholds and de-flickers
+uniform bool firstPass;
+uniform float threshold = 1.0;
+uniform float knee = 0.5;
+
+float Luma(vec3 c)
+{
+    return dot(c, vec3(0.2126, 0.7152, 0.0722));
+}
+
+// soft knee so the cut at the threshold does not band
+vec3 Prefilter(vec3 c)
+{
+    float brightness = max(c.r, max(c.g, c.b));
+    float soft = clamp(brightness - threshold + knee, 0.0, 2.0 * knee);
+    soft = soft * soft / (4.0 * knee + 0.00001);
+    float contribution = max(soft, brightness - threshold) / max(brightness, 0.00001);
+    return c * contribution;
+}
+
+// weights each 2x2 box by inverse luma so single bright texels do not flicker
+vec3 KarisAverage(vec3 a, vec3 b, vec3 c, vec3 d)
+{
+    float wa = 1.0 / (1.0 + Luma(a));
+    float wb = 1.0 / (1.0 + Luma(b));
+    float wc = 1.0 / (1.0 + Luma(c));
+    float wd = 1.0 / (1.0 + Luma(d));
+    return (a * wa + b * wb + c * wc + d * wd) / (wa + wb + wc + wd);
+}
+
+void main()
+{
+    vec2 texel = 1.0 / vec2(textureSize(srcTexture, 0));
+    float x = texel.x;
+    float y = texel.y;
+
+    // 13 bilinear taps, as in the Call of Duty: Advanced Warfare bloom
+    // a - b - c
+    // - j - k -
+    // d - e - f
+    // - l - m -
+    // g - h - i
+    vec3 a = texture(srcTexture, TexCoords + vec2(-2*x,  2*y)).rgb;
+    vec3 b = texture(srcTexture, TexCoords + vec2(   0,  2*y)).rgb;
+    vec3 c = texture(srcTexture, TexCoords + vec2( 2*x,  2*y)).rgb;
+
+    vec3 d = texture(srcTexture, TexCoords + vec2(-2*x,    0)).rgb;
+    vec3 e = texture(srcTexture, TexCoords).rgb;
+    vec3 f = texture(srcTexture, TexCoords + vec2( 2*x,    0)).rgb;
+
+    vec3 g = texture(srcTexture, TexCoords + vec2(-2*x, -2*y)).rgb;
+    vec3 h = texture(srcTexture, TexCoords + vec2(   0, -2*y)).rgb;
+    vec3 i = texture(srcTexture, TexCoords + vec2( 2*x, -2*y)).rgb;
+
+    vec3 j = texture(srcTexture, TexCoords + vec2(-x,  y)).rgb;
+    vec3 k = texture(srcTexture, TexCoords + vec2( x,  y)).rgb;
+    vec3 l = texture(srcTexture, TexCoords + vec2(-x, -y)).rgb;
+    vec3 m = texture(srcTexture, TexCoords + vec2( x, -y)).rgb;
+
+    vec3 color;
+
+    if (firstPass) {
+        // five overlapping boxes: center 0.5, corners 0.125 each
+        color  = KarisAverage(j, k, l, m) * 0.5;
+        color += KarisAverage(a, b, d, e) * 0.125;
+        color += KarisAverage(b, c, e, f) * 0.125;
+        color += KarisAverage(d, e, g, h) * 0.125;
+        color += KarisAverage(e, f, h, i) * 0.125;
+        color = Prefilter(color);
+    } else {
+        color  = e * 0.125;
+        color += (a + c + g + i) * 0.03125;
+        color += (b + d + f + h) * 0.0625;
+        color += (j + k + l + m) * 0.125;
+    }
+
+    // keep negative values out of the accumulated chain
+    FragColor = max(color, 0.0001);
+}
@@ -0,0 +1,34 @@
+#version 330 core
+out vec3 FragColor;
+
+in vec2 TexCoords;
+
+// next (smaller) level of the chain, blended additively into the current one
+uniform sampler2D srcTexture;
+uniform float filterRadius;
+
+void main()
+{
+    // fixed radius in uv, the spread comes from the depth of the chain
+    float x = filterRadius;
+    float y = filterRadius * (float(textureSize(srcTexture, 0).x) / float(textureSize(srcTexture, 0).y));
+
+    // 3x3 tent
+    vec3 color = texture(srcTexture, TexCoords).rgb * 4.0;
+
+    color += (
+        texture(srcTexture, TexCoords + vec2( 0,  y)).rgb +
+        texture(srcTexture, TexCoords + vec2(-x,  0)).rgb +
+        texture(srcTexture, TexCoords + vec2( x,  0)).rgb +
+        texture(srcTexture, TexCoords + vec2( 0, -y)).rgb
+    ) * 2.0;
+
+    color += (
+        texture(srcTexture, TexCoords + vec2(-x,  y)).rgb +
+        texture(srcTexture, TexCoords + vec2( x,  y)).rgb +
+        texture(srcTexture, TexCoords + vec2(-x, -y)).rgb +
+        texture(srcTexture, TexCoords + vec2( x, -y)).rgb
+    );
+
+    FragColor = color / 16.0;
+}
@@ -0,0 +1,156 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D screenTexture;
+
+// FXAA 3.11 quality preset defaults
+uniform float edgeThresholdMin = 0.0312;
+uniform float edgeThresholdMax = 0.125;
+uniform float subpixelQuality = 0.75;
+
+#define ITERATIONS 12
+
+const float QUALITY[ITERATIONS] = float[](
+    1.0, 1.0, 1.0, 1.0, 1.0, 1.5, 2.0, 2.0, 2.0, 2.0, 4.0, 8.0
+);
+
+// the scene is still HDR here, compress it before measuring contrast
+float Luma(vec3 color)
+{
+    float l = dot(color, vec3(0.2126, 0.7152, 0.0722));
+    return sqrt(l / (1.0 + l));
+}
+
+float LumaAt(vec2 uv)
+{
+    return Luma(texture(screenTexture, uv).rgb);
+}
+
+void main()
+{
+    vec2 texelSize = 1.0 / vec2(textureSize(screenTexture, 0));
+
+    vec3 colorCenter = texture(screenTexture, TexCoords).rgb;
+
+    float lumaCenter = Luma(colorCenter);
+    float lumaDown  = Luma(textureOffset(screenTexture, TexCoords, ivec2( 0, -1)).rgb);
+    float lumaUp    = Luma(textureOffset(screenTexture, TexCoords, ivec2( 0,  1)).rgb);
+    float lumaLeft  = Luma(textureOffset(screenTexture, TexCoords, ivec2(-1,  0)).rgb);
+    float lumaRight = Luma(textureOffset(screenTexture, TexCoords, ivec2( 1,  0)).rgb);
+
+    float lumaMin = min(lumaCenter, min(min(lumaDown, lumaUp), min(lumaLeft, lumaRight)));
+    float lumaMax = max(lumaCenter, max(max(lumaDown, lumaUp), max(lumaLeft, lumaRight)));
+    float lumaRange = lumaMax - lumaMin;
+
+    // no edge, or too little contrast to notice
+    if (lumaRange < max(edgeThresholdMin, lumaMax * edgeThresholdMax)) {
+        FragColor = vec4(colorCenter, 1.0);
+        return;
+    }
+
+    float lumaDownLeft  = Luma(textureOffset(screenTexture, TexCoords, ivec2(-1, -1)).rgb);
+    float lumaUpRight   = Luma(textureOffset(screenTexture, TexCoords, ivec2( 1,  1)).rgb);
+    float lumaUpLeft    = Luma(textureOffset(screenTexture, TexCoords, ivec2(-1,  1)).rgb);
+    float lumaDownRight = Luma(textureOffset(screenTexture, TexCoords, ivec2( 1, -1)).rgb);
+
+    float lumaDownUp = lumaDown + lumaUp;
+    float lumaLeftRight = lumaLeft + lumaRight;
+
+    float lumaLeftCorners = lumaDownLeft + lumaUpLeft;
+    float lumaDownCorners = lumaDownLeft + lumaDownRight;
+    float lumaRightCorners = lumaDownRight + lumaUpRight;
+    float lumaUpCorners = lumaUpRight + lumaUpLeft;
+
+    float edgeHorizontal =
+        abs(-2.0 * lumaLeft + lumaLeftCorners) +
+        abs(-2.0 * lumaCenter + lumaDownUp) * 2.0 +
+        abs(-2.0 * lumaRight + lumaRightCorners);
+    float edgeVertical =
+        abs(-2.0 * lumaUp + lumaUpCorners) +
+        abs(-2.0 * lumaCenter + lumaLeftRight) * 2.0 +
+        abs(-2.0 * lumaDown + lumaDownCorners);
+
+    bool isHorizontal = edgeHorizontal >= edgeVertical;
+
+    // pick the side of the edge with the steepest gradient
+    float luma1 = isHorizontal ? lumaDown : lumaLeft;
+    float luma2 = isHorizontal ? lumaUp : lumaRight;
+    float gradient1 = luma1 - lumaCenter;
+    float gradient2 = luma2 - lumaCenter;
+
+    bool is1Steepest = abs(gradient1) >= abs(gradient2);
+    float gradientScaled = 0.25 * max(abs(gradient1), abs(gradient2));
+
+    float stepLength = isHorizontal ? texelSize.y : texelSize.x;
+    float lumaLocalAverage;
+
+    if (is1Steepest) {
+        stepLength = -stepLength;
+        lumaLocalAverage = 0.5 * (luma1 + lumaCenter);
+    } else {
+        lumaLocalAverage = 0.5 * (luma2 + lumaCenter);
+    }
+
+    // walk along the edge, half a pixel off center
+    vec2 currentUv = TexCoords;
+    if (isHorizontal)
+        currentUv.y += stepLength * 0.5;
+    else
+        currentUv.x += stepLength * 0.5;
+
+    vec2 offset = isHorizontal ? vec2(texelSize.x, 0.0) : vec2(0.0, texelSize.y);
+
+    vec2 uv1 = currentUv - offset * QUALITY[0];
+    vec2 uv2 = currentUv + offset * QUALITY[0];
+
+    float lumaEnd1 = LumaAt(uv1) - lumaLocalAverage;
+    float lumaEnd2 = LumaAt(uv2) - lumaLocalAverage;
+
+    bool reached1 = abs(lumaEnd1) >= gradientScaled;
+    bool reached2 = abs(lumaEnd2) >= gradientScaled;
+
+    for (int i = 1; i < ITERATIONS && !(reached1 && reached2); i++) {
+        if (!reached1) {
+            uv1 -= offset * QUALITY[i];
+            lumaEnd1 = LumaAt(uv1) - lumaLocalAverage;
+            reached1 = abs(lumaEnd1) >= gradientScaled;
+        }
+        if (!reached2) {
+            uv2 += offset * QUALITY[i];
+            lumaEnd2 = LumaAt(uv2) - lumaLocalAverage;
+            reached2 = abs(lumaEnd2) >= gradientScaled;
+        }
+    }
+
+    float distance1 = isHorizontal ? (TexCoords.x - uv1.x) : (TexCoords.y - uv1.y);
+    float distance2 = isHorizontal ? (uv2.x - TexCoords.x) : (uv2.y - TexCoords.y);
+
+    bool isDirection1 = distance1 < distance2;
+    float distanceFinal = min(distance1, distance2);
+    float edgeThickness = distance1 + distance2;
+
+    float pixelOffset = -distanceFinal / edgeThickness + 0.5;
+
+    // only shift when the closer edge end varies the same way as the center
+    bool isLumaCenterSmaller = lumaCenter < lumaLocalAverage;
+    bool correctVariation = ((isDirection1 ? lumaEnd1 : lumaEnd2) < 0.0) != isLumaCenterSmaller;
+    float finalOffset = correctVariation ? pixelOffset : 0.0;
+
+    // subpixel aliasing, based on the 3x3 average
+    float lumaAverage = (1.0 / 12.0) * (2.0 * (lumaDownUp + lumaLeftRight) + lumaLeftCorners + lumaRightCorners);
+    float subPixelOffset1 = clamp(abs(lumaAverage - lumaCenter) / lumaRange, 0.0, 1.0);
+    float subPixelOffset2 = (-2.0 * subPixelOffset1 + 3.0) * subPixelOffset1 * subPixelOffset1;
+    float subPixelOffsetFinal = subPixelOffset2 * subPixelOffset2 * subpixelQuality;
+
+    finalOffset = max(finalOffset, subPixelOffsetFinal);
+
+    vec2 finalUv = TexCoords;
+    if (isHorizontal)
+        finalUv.y += finalOffset * stepLength;
+    else
+        finalUv.x += finalOffset * stepLength;
+
+    FragColor = vec4(texture(screenTexture, finalUv).rgb, 1.0);
+}
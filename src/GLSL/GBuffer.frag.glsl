@@ -1,59 +1,118 @@
 #version 330 core
 
-layout (location = 0) out vec3 gPosition;
-layout (location = 1) out vec3 gNormal;
-layout (location = 2) out vec4 gAlbedoSpec;
-layout (location = 3) out vec4 gPositionLightSpace;
+// position is not stored, light passes rebuild it from depth
+layout (location = 0) out vec2 gNormal;
+layout (location = 1) out vec4 gAlbedoSpec;
+layout (location = 2) out vec4 gMaterial;
 
 in VS_OUT {
     vec3 FragPos;
     vec2 TexCoords;
     vec3 Normal;
-    vec4 FragPosLightSpace;
     mat3 TBN;
 } fs_in;
 
 struct MaterialSolid {
-    // vec3 ambient;
+    // phong
     vec3 diffuse;
     vec3 specular;
 
-    // float shininess;
+    // pbr
+    vec3 albedo;
+    float metallic;
+    float roughness;
+    float ao;
 };
 
 struct MaterialTexture {
+    // albedo and metallic maps share the diffuse and specular slots
     sampler2D diffuse;
     sampler2D specular;
     sampler2D normal;
-    // sampler2D shadow;
+    sampler2D roughness;
+    sampler2D ao;
 };
 
 uniform MaterialSolid material;
 uniform MaterialTexture materialMaps;
 
+uniform bool pbr;
+
 uniform bool hasDiffuse;
 uniform bool hasSpecular;
 uniform bool hasNormal;
 
+uniform bool hasAlbedo;
+uniform bool hasMetallic;
+uniform bool hasRoughness;
+uniform bool hasAo;
+
+uniform vec3 metallicChannel = vec3(1.0, 0.0, 0.0);
+uniform vec3 roughnessChannel = vec3(0.0, 1.0, 0.0);
+
+vec2 OctWrap(vec2 v)
+{
+    return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+vec2 EncodeNormal(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    n.xy = n.z >= 0.0 ? n.xy : OctWrap(n.xy);
+    return n.xy * 0.5 + 0.5;
+}
+
 void main()
 {
-    gPosition = fs_in.FragPos;
-    gPositionLightSpace = fs_in.FragPosLightSpace;
+    vec3 normal;
 
     if (hasNormal) {
-        gNormal = texture(materialMaps.normal, fs_in.TexCoords).rgb;
-        gNormal = gNormal * 2.0 - 1.0;
-        gNormal = normalize(fs_in.TBN * gNormal);
+        normal = texture(materialMaps.normal, fs_in.TexCoords).rgb;
+        normal = normal * 2.0 - 1.0;
+        normal = normalize(fs_in.TBN * normal);
     } else
-        gNormal = normalize(fs_in.Normal);
+        normal = normalize(fs_in.Normal);
 
-    if (hasDiffuse)
-        gAlbedoSpec.rgb = texture(materialMaps.diffuse, fs_in.TexCoords).rgb;
-    else
-        gAlbedoSpec.rgb = material.diffuse;
+    gNormal = EncodeNormal(normal);
+
+    if (pbr) {
+        if (hasAlbedo) {
+            vec4 albedoSample = texture(materialMaps.diffuse, fs_in.TexCoords);
+            if (albedoSample.a < 0.05)
+                discard;
+            gAlbedoSpec.rgb = albedoSample.rgb;
+        } else
+            gAlbedoSpec.rgb = material.albedo;
 
-    if (hasSpecular)
-        gAlbedoSpec.a = texture(materialMaps.specular, fs_in.TexCoords).r;
-    else
         gAlbedoSpec.a = 0.0;
+
+        vec3 metallicSample = texture(materialMaps.specular, fs_in.TexCoords).rgb;
+
+        gMaterial.r = hasMetallic ? dot(metallicSample, metallicChannel) : material.metallic;
+
+        if (hasRoughness)
+            gMaterial.g = dot(texture(materialMaps.roughness, fs_in.TexCoords).rgb, roughnessChannel);
+        else if (hasMetallic)
+            // most likely embedded in the metallic map's green channel
+            gMaterial.g = metallicSample.g;
+        else
+            gMaterial.g = material.roughness;
+
+        gMaterial.b = hasAo ? texture(materialMaps.ao, fs_in.TexCoords).r : material.ao;
+    } else {
+        if (hasDiffuse)
+            gAlbedoSpec.rgb = texture(materialMaps.diffuse, fs_in.TexCoords).rgb;
+        else
+            gAlbedoSpec.rgb = material.diffuse;
+
+        if (hasSpecular)
+            gAlbedoSpec.a = texture(materialMaps.specular, fs_in.TexCoords).r;
+        else
+            gAlbedoSpec.a = 0.0;
+
+        // fully rough dielectric when lit by the pbr light pass
+        gMaterial.rgb = vec3(0.0, 1.0, 1.0);
+    }
+
+    gMaterial.a = 1.0;
 }
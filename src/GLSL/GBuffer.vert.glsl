@@ -10,7 +10,6 @@ out VS_OUT {
     vec3 FragPos;
     vec2 TexCoords;
     vec3 Normal;
-    vec4 FragPosLightSpace;
     mat3 TBN;
 } vs_out;
 
@@ -18,7 +17,6 @@ out VS_OUT {
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
-uniform mat4 lightSpaceMatrix;
 
 void main()
 {
@@ -30,7 +28,6 @@ void main()
     vs_out.FragPos = vec3(model * vec4(aPos, 1.0));
     vs_out.Normal = transpose(inverse(mat3(model))) * aNormal;
     vs_out.TexCoords = aTexCoords;
-    vs_out.FragPosLightSpace = lightSpaceMatrix * vec4(vs_out.FragPos, 1.0);
     vs_out.TBN = mat3(T, B, N);
 
     gl_Position = projection * view * vec4(vs_out.FragPos, 1.0);
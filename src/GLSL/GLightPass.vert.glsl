@@ -13,8 +13,11 @@ out VS_OUT {
     mat3 TBN;
 } vs_out;
 
+// part of the target drawn at the current resolution scale
+uniform vec2 uvScale = vec2(1.0);
+
 void main()
 {
-    vs_out.TexCoords = aTexCoords;
+    vs_out.TexCoords = aTexCoords * uvScale;
     gl_Position = vec4(aPos.x, aPos.y, 0.0, 1.0);
 }
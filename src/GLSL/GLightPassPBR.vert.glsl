@@ -0,0 +1,22 @@
+
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTexCoords;
+
+// only need TexCoords here but needed to sync with pbr
+// shader and avoid duplication
+out VS_OUT {
+    vec2 TexCoords;
+    vec3 WorldPos;
+    vec3 Normal;
+    vec4 WorldPosLightSpace;
+} vs_out;
+
+// part of the target drawn at the current resolution scale
+uniform vec2 uvScale = vec2(1.0);
+
+void main()
+{
+    vs_out.TexCoords = aTexCoords * uvScale;
+    gl_Position = vec4(aPos.x, aPos.y, 0.0, 1.0);
+}
@@ -0,0 +1,274 @@
+#version 330 core
+#extension GL_ARB_texture_cube_map_array : enable
+
+layout (location = 0) out vec4 FragColor;
+
+flat in int LightIndex;
+
+struct DeferredTexture {
+    sampler2D gDepth;
+    sampler2D gNormal;
+    sampler2D gAlbedoSpec;
+    sampler2D gMaterial;
+};
+
+// point and spot lights share one array so a single instanced draw covers both
+struct VolumeLight {
+    vec3 position;
+    vec3 direction;
+    float cutOff;
+    float outerCutOff;
+    bool spot;
+
+    float constant;
+    float linear;
+    float quadratic;
+    float radius;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+    vec3 color;
+
+    // point lights only
+    int shadowLayer;
+    float shadowFar;
+
+    // spot lights only
+    mat4 shadowMatrix;
+    vec4 shadowRect;
+};
+
+#define NR_MAX_LIGHTS 10
+
+uniform VolumeLight lights[NR_MAX_LIGHTS];
+uniform DeferredTexture deferredMaps;
+
+uniform mat4 invViewProj;
+uniform vec3 viewPos;
+
+uniform bool pbr;
+uniform bool blinn;
+uniform float shininess = 32.0;
+
+uniform bool hasSSAO;
+uniform sampler2D ssaoMap;
+
+// only sampled when GL_ARB_texture_cube_map_array is available
+#ifdef GL_ARB_texture_cube_map_array
+uniform samplerCubeArrayShadow pointShadowMaps;
+#endif
+
+uniform sampler2D spotShadowAtlas;
+uniform float spotShadowNear;
+
+// the G-Buffer is only filled up to the scaled viewport
+uniform vec2 uvScale = vec2(1.0);
+
+const float PI = 3.14159265359;
+
+vec3 DecodeNormal(vec2 f)
+{
+    f = f * 2.0 - 1.0;
+    vec3 n = vec3(f.x, f.y, 1.0 - abs(f.x) - abs(f.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+vec3 WorldPosFromDepth(float depth, vec2 texCoords)
+{
+    vec4 ndc = vec4(vec3(texCoords, depth) * 2.0 - 1.0, 1.0);
+    vec4 worldPos = invViewProj * ndc;
+    return worldPos.xyz / worldPos.w;
+}
+
+// distance based cube shadow, layer < 0 means the light has no slot this frame
+float PointShadowCalculation(vec3 fragPos, vec3 normal, vec3 lightPos, int layer, float farPlane)
+{
+#ifdef GL_ARB_texture_cube_map_array
+    if (layer < 0)
+        return 0.0;
+
+    vec3 fragToLight = fragPos - lightPos;
+    float currentDepth = length(fragToLight) / farPlane;
+
+    if (currentDepth >= 1.0)
+        return 0.0;
+
+    float bias = max(0.1 * (1.0 - dot(normal, normalize(-fragToLight))), 0.02) / farPlane;
+
+    return 1.0 - texture(pointShadowMaps, vec4(fragToLight, float(layer)), currentDepth - bias);
+#else
+    return 0.0;
+#endif
+}
+
+// perspective tile of the spot shadow atlas, rect.xy is its corner, rect.z its
+// size and rect.w the far plane. Depths are compared linearly so the bias is in world units
+float SpotShadowCalculation(vec3 fragPos, vec3 normal, vec3 lightDir, mat4 shadowMatrix, vec4 rect)
+{
+    if (rect.z <= 0.0)
+        return 0.0;
+
+    vec4 lightSpace = shadowMatrix * vec4(fragPos, 1.0);
+    vec2 coords = lightSpace.xy / lightSpace.w * 0.5 + 0.5;
+
+    if (lightSpace.w <= 0.0 || lightSpace.w >= rect.w ||
+        any(lessThan(coords, vec2(0.0))) || any(greaterThan(coords, vec2(1.0))))
+        return 0.0;
+
+    float bias = max(0.05 * (1.0 - dot(normal, lightDir)), 0.01);
+
+    // PCF taps must not bleed into the neighbouring tiles
+    vec2 texelSize = 1.0 / vec2(textureSize(spotShadowAtlas, 0));
+    vec2 lo = rect.xy + 0.5 * texelSize;
+    vec2 hi = rect.xy + rect.z - 0.5 * texelSize;
+
+    float shadow = 0.0;
+    for (int x = -1; x <= 1; ++x)
+    {
+        for (int y = -1; y <= 1; ++y)
+        {
+            vec2 uv = clamp(rect.xy + coords * rect.z + vec2(x, y) * texelSize, lo, hi);
+            float z = texture(spotShadowAtlas, uv).r * 2.0 - 1.0;
+            float closest = 2.0 * spotShadowNear * rect.w / (rect.w + spotShadowNear - z * (rect.w - spotShadowNear));
+            shadow += lightSpace.w - bias > closest ? 1.0 : 0.0;
+        }
+    }
+
+    return shadow / 9.0;
+}
+
+// fades the light to exactly zero at the volume boundary
+float RadiusFalloff(float distance, float radius)
+{
+    float r = distance / radius;
+    float window = clamp(1.0 - r * r * r * r, 0.0, 1.0);
+    return window * window;
+}
+
+float SpotIntensity(VolumeLight light, vec3 lightDir)
+{
+    if (!light.spot)
+        return 1.0;
+
+    float theta = dot(lightDir, normalize(-light.direction));
+    float epsilon = light.cutOff - light.outerCutOff;
+    return clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
+}
+
+float DistributionGGX(vec3 N, vec3 H, float roughness)
+{
+    float a = roughness*roughness;
+    float a2 = a*a;
+    float NdotH = max(dot(N, H), 0.0);
+    float NdotH2 = NdotH*NdotH;
+
+    float denom = (NdotH2 * (a2 - 1.0) + 1.0);
+    return a2 / (PI * denom * denom);
+}
+
+float GeometrySchlickGGX(float NdotV, float roughness)
+{
+    float r = (roughness + 1.0);
+    float k = (r*r) / 8.0;
+
+    return NdotV / (NdotV * (1.0 - k) + k);
+}
+
+float GeometrySmith(vec3 N, vec3 V, vec3 L, float roughness)
+{
+    float NdotV = max(dot(N, V), 0.0);
+    float NdotL = max(dot(N, L), 0.0);
+    return GeometrySchlickGGX(NdotL, roughness) * GeometrySchlickGGX(NdotV, roughness);
+}
+
+vec3 fresnelSchlick(float cosTheta, vec3 F0)
+{
+    return F0 + (1.0 - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
+}
+
+vec3 CalcPhong(VolumeLight light, vec3 N, vec3 fragPos, vec3 V, vec4 albedoSpec, float ao, float shadow)
+{
+    vec3 L = normalize(light.position - fragPos);
+
+    float diff = max(dot(N, L), 0.0);
+    float spec;
+
+    if (blinn)
+        spec = pow(max(dot(N, normalize(L + V)), 0.0), shininess);
+    else
+        spec = pow(max(dot(V, reflect(-L, N)), 0.0), shininess);
+
+    float distance = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+    attenuation *= RadiusFalloff(distance, light.radius) * SpotIntensity(light, L);
+
+    vec3 ambient = light.ambient * albedoSpec.rgb * ao;
+    vec3 diffuse = light.diffuse * diff * albedoSpec.rgb;
+    vec3 specular = light.specular * spec * albedoSpec.a;
+
+    return (ambient + (1.0 - shadow) * (diffuse + specular)) * attenuation;
+}
+
+vec3 CalcPbr(VolumeLight light, vec3 N, vec3 fragPos, vec3 V, vec3 albedo, vec3 material, float shadow)
+{
+    float metallic = material.r;
+    float roughness = material.g;
+
+    vec3 L = normalize(light.position - fragPos);
+    vec3 H = normalize(L + V);
+
+    float distance = length(light.position - fragPos);
+    float attenuation = RadiusFalloff(distance, light.radius) / (distance * distance);
+    vec3 radiance = light.color * attenuation * SpotIntensity(light, L) * (1.0 - shadow);
+
+    vec3 F0 = mix(vec3(0.04), albedo, metallic);
+
+    float NDF = DistributionGGX(N, H, roughness);
+    float G   = GeometrySmith(N, V, L, roughness);
+    vec3 F    = fresnelSchlick(clamp(dot(H, V), 0.0, 1.0), F0);
+
+    vec3 specular = (NDF * G * F) /
+        (4.0 * max(dot(N, V), 0.0) * max(dot(N, L), 0.0) + 0.0001);
+
+    vec3 kD = (vec3(1.0) - F) * (1.0 - metallic);
+
+    float NdotL = max(dot(N, L), 0.0);
+
+    return (kD * albedo / PI + specular) * radiance * NdotL;
+}
+
+void main()
+{
+    vec2 texCoords = gl_FragCoord.xy / vec2(textureSize(deferredMaps.gDepth, 0));
+
+    float depth = texture(deferredMaps.gDepth, texCoords).r;
+    if (depth == 1.0)
+        discard;
+
+    VolumeLight light = lights[LightIndex];
+
+    vec3 fragPos = WorldPosFromDepth(depth, texCoords / uvScale);
+
+    // the stencil only bounds the union of all volumes
+    if (length(light.position - fragPos) > light.radius)
+        discard;
+
+    vec3 N = DecodeNormal(texture(deferredMaps.gNormal, texCoords).rg);
+    vec3 V = normalize(viewPos - fragPos);
+    vec4 albedoSpec = texture(deferredMaps.gAlbedoSpec, texCoords);
+
+    float ao = hasSSAO ? texture(ssaoMap, texCoords).r : 1.0;
+    float shadow = light.spot
+        ? SpotShadowCalculation(fragPos, N, normalize(light.position - fragPos), light.shadowMatrix, light.shadowRect)
+        : PointShadowCalculation(fragPos, N, light.position, light.shadowLayer, light.shadowFar);
+
+    vec3 result = pbr
+        ? CalcPbr(light, N, fragPos, V, albedoSpec.rgb, texture(deferredMaps.gMaterial, texCoords).rgb, shadow)
+        : CalcPhong(light, N, fragPos, V, albedoSpec, ao, shadow);
+
+    FragColor = vec4(result, 0.0);
+}
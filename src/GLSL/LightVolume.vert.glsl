@@ -0,0 +1,21 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+#define NR_MAX_LIGHTS 10
+
+// xyz center, w radius; one instance per light
+uniform vec4 lightSpheres[NR_MAX_LIGHTS];
+uniform mat4 viewProj;
+
+// the tessellated sphere sits inside the unit sphere, push it out
+uniform float volumeScale = 1.0;
+
+flat out int LightIndex;
+
+void main()
+{
+    vec4 sphere = lightSpheres[gl_InstanceID];
+    LightIndex = gl_InstanceID;
+
+    gl_Position = viewProj * vec4(sphere.xyz + aPos * sphere.w * volumeScale, 1.0);
+}
@@ -0,0 +1,17 @@
+#version 330 core
+out float FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D hdrTexture;
+
+uniform float minLogLum;
+uniform float maxLogLum;
+
+void main()
+{
+    float lum = dot(texture(hdrTexture, TexCoords).rgb, vec3(0.2126, 0.7152, 0.0722));
+
+    // mipmapping this averages the log, so the last level is the geometric mean
+    FragColor = clamp(log2(max(lum, 0.0001)), minLogLum, maxLogLum);
+}
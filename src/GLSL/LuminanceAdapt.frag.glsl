@@ -0,0 +1,18 @@
+#version 330 core
+out float FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D logLuminance;
+uniform sampler2D previousLuminance;
+
+uniform float lastLevel;
+uniform float adaptRate;
+
+void main()
+{
+    float lum = exp2(textureLod(logLuminance, vec2(0.5), lastLevel).r);
+    float previous = texture(previousLuminance, vec2(0.5)).r;
+
+    FragColor = previous + (lum - previous) * adaptRate;
+}
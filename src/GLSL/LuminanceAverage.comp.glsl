@@ -0,0 +1,48 @@
+#version 430 core
+
+#define HISTOGRAM_BINS 256
+
+layout (local_size_x = HISTOGRAM_BINS) in;
+
+layout (r32ui, binding = 0) uniform uimage2D histogram;
+layout (r32f, binding = 1) uniform writeonly image2D adaptedLuminance;
+
+// last frame's result, the two 1x1 targets are swapped every frame
+uniform sampler2D previousLuminance;
+
+uniform float minLogLum;
+uniform float logLumRange;
+uniform float adaptRate;
+uniform float pixelCount;
+
+shared float weightedBins[HISTOGRAM_BINS];
+
+void main()
+{
+    uint bin = gl_LocalInvocationIndex;
+    uint count = imageLoad(histogram, ivec2(bin, 0)).r;
+
+    weightedBins[bin] = float(count) * float(bin);
+
+    // ready for the next frame
+    imageStore(histogram, ivec2(bin, 0), uvec4(0u));
+
+    barrier();
+
+    for (uint cutoff = HISTOGRAM_BINS >> 1; cutoff > 0u; cutoff >>= 1) {
+        if (bin < cutoff)
+            weightedBins[bin] += weightedBins[bin + cutoff];
+        barrier();
+    }
+
+    if (bin == 0u) {
+        // count is the near-black bin here
+        float litPixels = max(pixelCount - float(count), 1.0);
+        float weightedLogAverage = weightedBins[0] / litPixels - 1.0;
+
+        float lum = exp2(weightedLogAverage / 254.0 * logLumRange + minLogLum);
+        float previous = texelFetch(previousLuminance, ivec2(0), 0).r;
+
+        imageStore(adaptedLuminance, ivec2(0), vec4(previous + (lum - previous) * adaptRate));
+    }
+}
@@ -0,0 +1,45 @@
+#version 430 core
+
+#define HISTOGRAM_BINS 256
+
+// one invocation per bin, so the shared histogram clears and flushes in one step
+layout (local_size_x = 16, local_size_y = 16) in;
+
+layout (r32ui, binding = 0) uniform uimage2D histogram;
+
+uniform sampler2D hdrTexture;
+
+uniform float minLogLum;
+uniform float invLogLumRange;
+
+// only the scaled viewport of hdrTexture holds this frame
+uniform ivec2 viewportSize;
+
+shared uint localBins[HISTOGRAM_BINS];
+
+// bin 0 collects near-black pixels so they can be left out of the average
+uint LuminanceToBin(vec3 color)
+{
+    float lum = dot(color, vec3(0.2126, 0.7152, 0.0722));
+
+    if (lum < 0.005)
+        return 0u;
+
+    float logLum = clamp((log2(lum) - minLogLum) * invLogLumRange, 0.0, 1.0);
+    return uint(logLum * 254.0 + 1.0);
+}
+
+void main()
+{
+    localBins[gl_LocalInvocationIndex] = 0u;
+    barrier();
+
+    ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+
+    if (all(lessThan(coord, viewportSize)))
+        atomicAdd(localBins[LuminanceToBin(texelFetch(hdrTexture, coord, 0).rgb)], 1u);
+
+    barrier();
+
+    imageAtomicAdd(histogram, ivec2(gl_LocalInvocationIndex, 0), localBins[gl_LocalInvocationIndex]);
+}
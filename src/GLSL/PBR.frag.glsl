@@ -1,4 +1,5 @@
 #version 330 core
+#extension GL_ARB_texture_cube_map_array : enable
 
 out vec4 FragColor;
 
@@ -24,6 +25,22 @@ struct MaterialTexture {
     sampler2D aoMap;
 };
 
+struct DeferredTexture {
+    sampler2D gDepth;
+    sampler2D gNormal;
+    sampler2D gAlbedoSpec;
+    sampler2D gMaterial;
+};
+
+uniform bool deferred;
+uniform DeferredTexture deferredMaps;
+uniform mat4 invViewProj;
+uniform mat4 lightSpaceMatrix;
+
+// set once in main, either from the vertex stage or the G-Buffer
+vec3 _WorldPos;
+vec4 _WorldPosLightSpace;
+
 uniform bool gammaCorrect=true;
 
 uniform bool hasAlbedo;
@@ -46,6 +63,9 @@ uniform bool hasIBLMaps=false;
 struct PointLight {
     vec3 position;
     vec3 color;
+
+    int shadowLayer;
+    float shadowFar;
 };
 
 struct DirectionalLight {
@@ -66,6 +86,17 @@ uniform vec3 camPos;
 uniform sampler2D shadowMap;
 uniform bool hasShadow;
 
+// only sampled when GL_ARB_texture_cube_map_array is available
+#ifdef GL_ARB_texture_cube_map_array
+uniform samplerCubeArrayShadow pointShadowMaps;
+#endif
+
+uniform bool hasSSAO;
+uniform sampler2D ssaoMap;
+
+// deferred TexCoords only span the scaled viewport
+uniform vec2 uvScale = vec2(1.0);
+
 const float PI = 3.14159265359;
 // ----------------------------------------------------------------------------
 // Easy trick to get tangent-normals to world-space to keep PBR code simplified.
@@ -166,6 +197,27 @@ float ShadowCalculation(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir) {
     return shadow;
 }
 
+// distance based cube shadow, layer < 0 means the light has no slot this frame
+float PointShadowCalculation(vec3 fragPos, vec3 normal, vec3 lightPos, int layer, float farPlane)
+{
+#ifdef GL_ARB_texture_cube_map_array
+    if (layer < 0)
+        return 0.0;
+
+    vec3 fragToLight = fragPos - lightPos;
+    float currentDepth = length(fragToLight) / farPlane;
+
+    if (currentDepth >= 1.0)
+        return 0.0;
+
+    float bias = max(0.1 * (1.0 - dot(normal, normalize(-fragToLight))), 0.02) / farPlane;
+
+    return 1.0 - texture(pointShadowMaps, vec4(fragToLight, float(layer)), currentDepth - bias);
+#else
+    return 0.0;
+#endif
+}
+
 vec3 CalcPointLightRadiance(
     PointLight light,
     vec3 N,
@@ -175,12 +227,13 @@ vec3 CalcPointLightRadiance(
     float roughness,
     float metallic
 ) {
-    vec3 L = normalize(light.position - fs_in.WorldPos);
+    vec3 L = normalize(light.position - _WorldPos);
     vec3 H = normalize(L + V);
 
-    float distance = length(light.position - fs_in.WorldPos);
+    float distance = length(light.position - _WorldPos);
     float attenuation = 1.0 / (distance * distance);
-    vec3 radiance = light.color * attenuation;
+    float shadow = PointShadowCalculation(_WorldPos, N, light.position, light.shadowLayer, light.shadowFar);
+    vec3 radiance = light.color * attenuation * (1.0 - shadow);
 
     float NDF = DistributionGGX(N, H, roughness);
     float G   = GeometrySmith(N, V, L, roughness);
@@ -232,64 +285,106 @@ vec3 CalcDirLightRadiance(
     vec3 Lo = (kD * albedo / PI + specular) * light.color * NdotL;
 
     if (hasShadow) {
-        float shadow = ShadowCalculation(fs_in.WorldPosLightSpace, N, -light.direction);
+        float shadow = ShadowCalculation(_WorldPosLightSpace, N, -light.direction);
         Lo = (1.0 - shadow) * Lo;
     }
     return Lo;
 }
 
+vec3 DecodeNormal(vec2 f)
+{
+    f = f * 2.0 - 1.0;
+    vec3 n = vec3(f.x, f.y, 1.0 - abs(f.x) - abs(f.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+vec3 WorldPosFromDepth(float depth, vec2 texCoords)
+{
+    vec4 ndc = vec4(vec3(texCoords, depth) * 2.0 - 1.0, 1.0);
+    vec4 worldPos = invViewProj * ndc;
+    return worldPos.xyz / worldPos.w;
+}
+
 void main()
 {
     vec3 _Albedo, _Normal;
     float _Metallic, _Roughness, _Ao;
 
-    if (hasAlbedo) {
-        vec4 albedoSample = texture(materialMaps.albedoMap, fs_in.TexCoords);
-        // TODO: Make this bias better
-        if (albedoSample.a < 0.05)
+    if (deferred) {
+        float depth = texture(deferredMaps.gDepth, fs_in.TexCoords).r;
+
+        // nothing was written here, skybox covers it later
+        if (depth == 1.0)
             discard;
-        _Albedo = albedoSample.rgb;
-    }
-    else {
-        _Albedo = material.albedo;
-    }
 
-    _Normal = hasNormal ? getNormalFromMap()
-        : fs_in.Normal;
+        _WorldPos = WorldPosFromDepth(depth, fs_in.TexCoords / uvScale);
+        _WorldPosLightSpace = lightSpaceMatrix * vec4(_WorldPos, 1.0);
 
-    if (hasMetallic) {
-        vec3 metal_sample = texture(materialMaps.metallicMap, fs_in.TexCoords).rgb;
+        _Normal = DecodeNormal(texture(deferredMaps.gNormal, fs_in.TexCoords).rg);
+        _Albedo = texture(deferredMaps.gAlbedoSpec, fs_in.TexCoords).rgb;
 
-        if (metallicChannel.r != 0) _Metallic = metal_sample.r;
-        if (metallicChannel.g != 0) _Metallic = metal_sample.g;
-        if (metallicChannel.b != 0) _Metallic = metal_sample.b;
-    }
-    else {
-        _Metallic = material.metallic;
-    }
+        vec3 materialSample = texture(deferredMaps.gMaterial, fs_in.TexCoords).rgb;
+        _Metallic = materialSample.r;
+        _Roughness = materialSample.g;
+        _Ao = materialSample.b;
+    } else {
+        _WorldPos = fs_in.WorldPos;
+        _WorldPosLightSpace = fs_in.WorldPosLightSpace;
+
+        if (hasAlbedo) {
+            vec4 albedoSample = texture(materialMaps.albedoMap, fs_in.TexCoords);
+            // TODO: Make this bias better
+            if (albedoSample.a < 0.05)
+                discard;
+            _Albedo = albedoSample.rgb;
+        }
+        else {
+            _Albedo = material.albedo;
+        }
 
-    if (hasRoughness) {
-        vec3 rough_sample = texture(materialMaps.roughnessMap, fs_in.TexCoords).rgb;
+        _Normal = hasNormal ? getNormalFromMap()
+            : fs_in.Normal;
 
-        if (roughnessChannel.r != 0) _Roughness = rough_sample.r;
-        if (roughnessChannel.g != 0) _Roughness = rough_sample.g;
-        if (roughnessChannel.b != 0) _Roughness = rough_sample.b;
-    }
-    else if (hasMetallic) {
-        // If does not include a dedicated roughness map most likely its embedded
-        // in metallic map's green channel
-        _Roughness = texture(materialMaps.metallicMap, fs_in.TexCoords).g;
-    } else {
-        _Roughness = material.roughness;
-    }
+        if (hasMetallic) {
+            vec3 metal_sample = texture(materialMaps.metallicMap, fs_in.TexCoords).rgb;
+
+            if (metallicChannel.r != 0) _Metallic = metal_sample.r;
+            if (metallicChannel.g != 0) _Metallic = metal_sample.g;
+            if (metallicChannel.b != 0) _Metallic = metal_sample.b;
+        }
+        else {
+            _Metallic = material.metallic;
+        }
+
+        if (hasRoughness) {
+            vec3 rough_sample = texture(materialMaps.roughnessMap, fs_in.TexCoords).rgb;
 
-    _Ao = hasAo ? texture(materialMaps.aoMap, fs_in.TexCoords).r
-        : material.ao;
+            if (roughnessChannel.r != 0) _Roughness = rough_sample.r;
+            if (roughnessChannel.g != 0) _Roughness = rough_sample.g;
+            if (roughnessChannel.b != 0) _Roughness = rough_sample.b;
+        }
+        else if (hasMetallic) {
+            // If does not include a dedicated roughness map most likely its embedded
+            // in metallic map's green channel
+            _Roughness = texture(materialMaps.metallicMap, fs_in.TexCoords).g;
+        } else {
+            _Roughness = material.roughness;
+        }
+
+        _Ao = hasAo ? texture(materialMaps.aoMap, fs_in.TexCoords).r
+            : material.ao;
+
+        if (gammaCorrect && hasAlbedo) _Albedo = pow(_Albedo, vec3(2.2));
+    }
 
-    if (gammaCorrect && hasAlbedo) _Albedo = pow(_Albedo, vec3(2.2));
+    if (hasSSAO)
+        _Ao *= texture(ssaoMap, gl_FragCoord.xy / vec2(textureSize(ssaoMap, 0))).r;
 
     vec3 N = normalize(_Normal);
-    vec3 V = normalize(camPos - fs_in.WorldPos);
+    vec3 V = normalize(camPos - _WorldPos);
     vec3 R = reflect(-V, N);
 
     vec3 F0 = vec3(0.04);
@@ -1,4 +1,5 @@
 #version 330 core
+#extension GL_ARB_texture_cube_map_array : enable
 
 struct MaterialSolid {
     vec3 ambient;
@@ -16,10 +17,9 @@ struct MaterialTexture {
 };
 
 struct DeferredTexture {
-    sampler2D gPosition;
+    sampler2D gDepth;
     sampler2D gNormal;
     sampler2D gAlbedoSpec;
-    sampler2D gPositionLightSpace;
 };
 
 struct DirectionalLight {
@@ -40,6 +40,9 @@ struct PointLight {
     vec3 ambient;
     vec3 diffuse;
     vec3 specular;
+
+    int shadowLayer;
+    float shadowFar;
 };
 
 struct SpotLight {
@@ -55,13 +58,15 @@ struct SpotLight {
     vec3 ambient;
     vec3 diffuse;
     vec3 specular;
+
+    mat4 shadowMatrix;
+    vec4 shadowRect;
 };
 
 #define NR_POINT_LIGHTS 10
 #define NR_SPOT_LIGHTS 10
 
 layout (location = 0) out vec4 FragColor;
-layout (location = 1) out vec4 BrightColor;
 
 in VS_OUT {
     vec3 FragPos;
@@ -80,6 +85,8 @@ uniform MaterialTexture materialMaps;
 uniform DeferredTexture deferredMaps;
 
 uniform bool deferred;
+uniform mat4 invViewProj;
+uniform mat4 lightSpaceMatrix;
 
 uniform DirectionalLight directionalLight;
 
@@ -93,14 +100,52 @@ uniform bool hasSpecular;
 uniform bool hasShadow;
 uniform bool hasNormal;
 
+// only sampled when GL_ARB_texture_cube_map_array is available
+#ifdef GL_ARB_texture_cube_map_array
+uniform samplerCubeArrayShadow pointShadowMaps;
+#endif
+
+uniform sampler2D spotShadowAtlas;
+uniform float spotShadowNear;
+
 uniform bool blinn;
-uniform float bloomLevel=1.2f;
 
-vec3 CalcDirLight(DirectionalLight light, vec3 normal, vec3 viewDir);
+uniform bool hasSSAO;
+uniform sampler2D ssaoMap;
+
+// deferred TexCoords only span the scaled viewport
+uniform vec2 uvScale = vec2(1.0);
+
+vec3 CalcDirLight(DirectionalLight light, vec3 normal, vec3 viewDir, vec4 fragPosLightSpace);
 vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
 vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
 
 float ShadowCalculation(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir);
+float PointShadowCalculation(vec3 fragPos, vec3 normal, vec3 lightPos, int layer, float farPlane);
+float SpotShadowCalculation(vec3 fragPos, vec3 normal, vec3 lightDir, mat4 shadowMatrix, vec4 rect);
+
+vec3 DecodeNormal(vec2 f)
+{
+    f = f * 2.0 - 1.0;
+    vec3 n = vec3(f.x, f.y, 1.0 - abs(f.x) - abs(f.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+vec3 WorldPosFromDepth(float depth, vec2 texCoords)
+{
+    vec4 ndc = vec4(vec3(texCoords, depth) * 2.0 - 1.0, 1.0);
+    vec4 worldPos = invViewProj * ndc;
+    return worldPos.xyz / worldPos.w;
+}
+
+// the SSAO target matches the render target, so it is addressed in screen space
+float ScreenSpaceAO()
+{
+    return hasSSAO ? texture(ssaoMap, gl_FragCoord.xy / vec2(textureSize(ssaoMap, 0))).r : 1.0;
+}
 
 vec3 CalcAmbient(vec3 lightAmbient)
 {
@@ -112,7 +157,7 @@ vec3 CalcAmbient(vec3 lightAmbient)
     } else {
         ambient = lightAmbient * material.ambient;
     }
-    return ambient;
+    return ambient * ScreenSpaceAO();
 }
 
 vec3 CalcDiffuse(vec3 lightDiffuse, float diff)
@@ -144,12 +189,21 @@ vec3 CalcSpecular(vec3 lightSpecular, float spec)
 void main() {
 
     vec3 _FragPos, _Normal;
+    vec4 _FragPosLightSpace;
 
     if (deferred) {
-        _FragPos = texture(deferredMaps.gPosition, fs_in.TexCoords).rgb;
-        _Normal = texture(deferredMaps.gNormal, fs_in.TexCoords).rgb;
+        float depth = texture(deferredMaps.gDepth, fs_in.TexCoords).r;
+
+        // nothing was written here, skybox covers it later
+        if (depth == 1.0)
+            discard;
+
+        _FragPos = WorldPosFromDepth(depth, fs_in.TexCoords / uvScale);
+        _Normal = DecodeNormal(texture(deferredMaps.gNormal, fs_in.TexCoords).rg);
+        _FragPosLightSpace = lightSpaceMatrix * vec4(_FragPos, 1.0);
     } else {
         _FragPos = fs_in.FragPos;
+        _FragPosLightSpace = fs_in.FragPosLightSpace;
         if (hasNormal) {
             _Normal = texture(materialMaps.normal, fs_in.TexCoords).rgb;
             _Normal = _Normal * 2.0 - 1.0;
@@ -160,7 +214,7 @@ void main() {
 
     vec3 viewDir = normalize(viewPos - _FragPos);
 
-    vec3 result = CalcDirLight(directionalLight, _Normal, viewDir);
+    vec3 result = CalcDirLight(directionalLight, _Normal, viewDir, _FragPosLightSpace);
 
     // phase 2: point lights
     for(int i = 0; i < pointLightsSize; i++)
@@ -171,17 +225,10 @@ void main() {
         result += CalcSpotLight(spotLights[i], _Normal, _FragPos, viewDir);
 
     FragColor = vec4(result, 1.0);
-
-    float brightness = dot(FragColor.rgb, vec3(0.2126, 0.7152, 0.0722));
-
-    BrightColor =
-        brightness > bloomLevel ?
-        vec4(FragColor.rgb, 1.0) :
-        vec4(0.0, 0.0, 0.0, 1.0);
 }
 
 
-vec3 CalcDirLight(DirectionalLight light, vec3 normal, vec3 viewDir) {
+vec3 CalcDirLight(DirectionalLight light, vec3 normal, vec3 viewDir, vec4 fragPosLightSpace) {
     vec3 lightDir = normalize(-light.direction);
 
     // diffuse shading
@@ -207,12 +254,7 @@ vec3 CalcDirLight(DirectionalLight light, vec3 normal, vec3 viewDir) {
     vec3 lighting;
 
     if (hasShadow) {
-        vec4 _FragPosLightSpace =
-            deferred ?
-            texture(deferredMaps.gPositionLightSpace, fs_in.TexCoords) :
-            fs_in.FragPosLightSpace;
-
-        float shadow = ShadowCalculation(_FragPosLightSpace, normal, lightDir);
+        float shadow = ShadowCalculation(fragPosLightSpace, normal, lightDir);
         lighting = (ambient + (1.0 - shadow) * (diffuse + specular));
     } else {
         lighting = ambient + diffuse + specular;
@@ -250,7 +292,9 @@ vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     diffuse *= attenuation;
     specular *= attenuation;
 
-    return (ambient + diffuse + specular);
+    float shadow = PointShadowCalculation(fragPos, normal, light.position, light.shadowLayer, light.shadowFar);
+
+    return (ambient + (1.0 - shadow) * (diffuse + specular));
 }
 
 // calculates the color when using a spot light.
@@ -279,7 +323,9 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     diffuse *= attenuation * intensity;
     specular *= attenuation * intensity;
 
-    return (ambient + diffuse + specular);
+    float shadow = SpotShadowCalculation(fragPos, normal, lightDir, light.shadowMatrix, light.shadowRect);
+
+    return (ambient + (1.0 - shadow) * (diffuse + specular));
 }
 
 float ShadowCalculation(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir) {
@@ -314,3 +360,60 @@ float ShadowCalculation(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir) {
     return shadow;
 
 }
+
+// distance based cube shadow, layer < 0 means the light has no slot this frame
+float PointShadowCalculation(vec3 fragPos, vec3 normal, vec3 lightPos, int layer, float farPlane)
+{
+#ifdef GL_ARB_texture_cube_map_array
+    if (layer < 0)
+        return 0.0;
+
+    vec3 fragToLight = fragPos - lightPos;
+    float currentDepth = length(fragToLight) / farPlane;
+
+    if (currentDepth >= 1.0)
+        return 0.0;
+
+    float bias = max(0.1 * (1.0 - dot(normal, normalize(-fragToLight))), 0.02) / farPlane;
+
+    return 1.0 - texture(pointShadowMaps, vec4(fragToLight, float(layer)), currentDepth - bias);
+#else
+    return 0.0;
+#endif
+}
+
+// perspective tile of the spot shadow atlas, rect.xy is its corner, rect.z its
+// size and rect.w the far plane. Depths are compared linearly so the bias is in world units
+float SpotShadowCalculation(vec3 fragPos, vec3 normal, vec3 lightDir, mat4 shadowMatrix, vec4 rect)
+{
+    if (rect.z <= 0.0)
+        return 0.0;
+
+    vec4 lightSpace = shadowMatrix * vec4(fragPos, 1.0);
+    vec2 coords = lightSpace.xy / lightSpace.w * 0.5 + 0.5;
+
+    if (lightSpace.w <= 0.0 || lightSpace.w >= rect.w ||
+        any(lessThan(coords, vec2(0.0))) || any(greaterThan(coords, vec2(1.0))))
+        return 0.0;
+
+    float bias = max(0.05 * (1.0 - dot(normal, lightDir)), 0.01);
+
+    // PCF taps must not bleed into the neighbouring tiles
+    vec2 texelSize = 1.0 / vec2(textureSize(spotShadowAtlas, 0));
+    vec2 lo = rect.xy + 0.5 * texelSize;
+    vec2 hi = rect.xy + rect.z - 0.5 * texelSize;
+
+    float shadow = 0.0;
+    for (int x = -1; x <= 1; ++x)
+    {
+        for (int y = -1; y <= 1; ++y)
+        {
+            vec2 uv = clamp(rect.xy + coords * rect.z + vec2(x, y) * texelSize, lo, hi);
+            float z = texture(spotShadowAtlas, uv).r * 2.0 - 1.0;
+            float closest = 2.0 * spotShadowNear * rect.w / (rect.w + spotShadowNear - z * (rect.w - spotShadowNear));
+            shadow += lightSpace.w - bias > closest ? 1.0 : 0.0;
+        }
+    }
+
+    return shadow / 9.0;
+}
@@ -0,0 +1,12 @@
+#version 330 core
+
+in vec3 FragPos;
+
+uniform vec3 lightPos;
+uniform float farPlane;
+
+// linear distance, the lighting shaders compare against the same measure
+void main()
+{
+    gl_FragDepth = length(FragPos - lightPos) / farPlane;
+}
@@ -0,0 +1,37 @@
+#version 330 core
+
+layout (triangles) in;
+layout (triangle_strip, max_vertices = 18) out;
+
+uniform mat4 faceMatrices[6];
+// first face of this light's cube in the array
+uniform int layerBase;
+
+out vec3 FragPos;
+
+void main()
+{
+    for (int face = 0; face < 6; face++) {
+        vec4 clip[3];
+        for (int i = 0; i < 3; i++)
+            clip[i] = faceMatrices[face] * gl_in[i].gl_Position;
+
+        // skip faces the triangle lies fully outside of on one side
+        bvec3 outside = bvec3(false);
+        for (int axis = 0; axis < 3; axis++) {
+            outside[axis] =
+                (clip[0][axis] >  clip[0].w && clip[1][axis] >  clip[1].w && clip[2][axis] >  clip[2].w) ||
+                (clip[0][axis] < -clip[0].w && clip[1][axis] < -clip[1].w && clip[2][axis] < -clip[2].w);
+        }
+        if (any(outside))
+            continue;
+
+        for (int i = 0; i < 3; i++) {
+            gl_Layer = layerBase + face;
+            FragPos = gl_in[i].gl_Position.xyz;
+            gl_Position = clip[i];
+            EmitVertex();
+        }
+        EndPrimitive();
+    }
+}
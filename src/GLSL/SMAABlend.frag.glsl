@@ -0,0 +1,42 @@
+#version 330 core
+out vec4 FragColor;
+
+uniform sampler2D screenTexture;
+uniform sampler2D weightsTexture;
+
+vec4 Fetch(sampler2D tex, ivec2 p)
+{
+    return texelFetch(tex, clamp(p, ivec2(0), textureSize(tex, 0) - 1), 0);
+}
+
+void main()
+{
+    ivec2 p = ivec2(gl_FragCoord.xy);
+
+    vec4 own = Fetch(weightsTexture, p);
+
+    // the edges above and to the right are stored by those neighbors
+    float wBottom = own.r;
+    float wTop = Fetch(weightsTexture, p + ivec2(0, 1)).g;
+    float wLeft = own.b;
+    float wRight = Fetch(weightsTexture, p + ivec2(1, 0)).a;
+
+    float total = wBottom + wTop + wLeft + wRight;
+
+    vec3 color = Fetch(screenTexture, p).rgb;
+
+    if (total < 0.00001) {
+        FragColor = vec4(color, 1.0);
+        return;
+    }
+
+    vec3 neighbors =
+        Fetch(screenTexture, p + ivec2(0, -1)).rgb * wBottom +
+        Fetch(screenTexture, p + ivec2(0,  1)).rgb * wTop +
+        Fetch(screenTexture, p + ivec2(-1, 0)).rgb * wLeft +
+        Fetch(screenTexture, p + ivec2( 1, 0)).rgb * wRight;
+
+    FragColor = vec4(total > 1.0
+        ? neighbors / total
+        : color * (1.0 - total) + neighbors, 1.0);
+}
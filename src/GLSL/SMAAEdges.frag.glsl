@@ -0,0 +1,50 @@
+#version 330 core
+// r: edge with the left neighbor, g: edge with the bottom neighbor
+out vec2 FragColor;
+
+uniform sampler2D screenTexture;
+
+uniform float threshold = 0.1;
+// edges much weaker than a neighboring one are dropped
+uniform float contrastAdaptation = 2.0;
+
+float Luma(vec3 color)
+{
+    float l = dot(color, vec3(0.2126, 0.7152, 0.0722));
+    return sqrt(l / (1.0 + l));
+}
+
+float LumaAt(ivec2 p)
+{
+    ivec2 size = textureSize(screenTexture, 0);
+    return Luma(texelFetch(screenTexture, clamp(p, ivec2(0), size - 1), 0).rgb);
+}
+
+void main()
+{
+    ivec2 p = ivec2(gl_FragCoord.xy);
+
+    float L = LumaAt(p);
+    float lumaLeft = LumaAt(p + ivec2(-1, 0));
+    float lumaBottom = LumaAt(p + ivec2(0, -1));
+
+    vec2 delta = abs(L - vec2(lumaLeft, lumaBottom));
+    vec2 edges = step(threshold, delta);
+
+    if (dot(edges, vec2(1.0)) == 0.0)
+        discard;
+
+    // local contrast adaptation
+    float lumaRight = LumaAt(p + ivec2(1, 0));
+    float lumaTop = LumaAt(p + ivec2(0, 1));
+    vec2 maxDelta = max(delta, abs(L - vec2(lumaRight, lumaTop)));
+
+    float lumaLeftLeft = LumaAt(p + ivec2(-2, 0));
+    float lumaBottomBottom = LumaAt(p + ivec2(0, -2));
+    maxDelta = max(maxDelta, abs(vec2(lumaLeft, lumaBottom) - vec2(lumaLeftLeft, lumaBottomBottom)));
+
+    float finalDelta = max(maxDelta.x, maxDelta.y);
+    edges *= step(finalDelta, contrastAdaptation * delta);
+
+    FragColor = edges;
+}
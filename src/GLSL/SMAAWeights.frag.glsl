@@ -0,0 +1,95 @@
+#version 330 core
+// r/g: coverage above/below the bottom edge of this pixel
+// b/a: coverage right/left of the left edge of this pixel
+out vec4 FragColor;
+
+uniform sampler2D edgesTexture;
+
+#define MAX_SEARCH_STEPS 16
+
+ivec2 size;
+
+vec2 Edges(ivec2 p)
+{
+    return texelFetch(edgesTexture, clamp(p, ivec2(0), size - 1), 0).rg;
+}
+
+// direction of the edge crossing a run end, 0 for none or both
+float Crossing(float positive, float negative)
+{
+    return positive - negative;
+}
+
+// Silhouette height over a run [a, b]: ends with a crossing edge are
+// bent half a pixel towards it and the line meets the run in its middle
+float Height(float t, float a, float b, float sA, float sB)
+{
+    float mid = 0.5 * (a + b);
+    return t < mid
+        ? 0.5 * sA * (mid - t) / (mid - a)
+        : 0.5 * sB * (t - mid) / (b - mid);
+}
+
+// Coverage of the pixel [0, 1] on either side of the run, both pieces are
+// linear so the midpoint rule is exact
+vec2 Area(float a, float b, float sA, float sB)
+{
+    float mid = 0.5 * (a + b);
+    vec2 area = vec2(0.0);
+
+    float x0 = 0.0, x1 = min(1.0, mid);
+    if (x1 > x0) {
+        float h = Height(0.5 * (x0 + x1), a, b, sA, sB) * (x1 - x0);
+        area += vec2(max(h, 0.0), max(-h, 0.0));
+    }
+
+    float x2 = max(0.0, mid), x3 = 1.0;
+    if (x3 > x2) {
+        float h = Height(0.5 * (x2 + x3), a, b, sA, sB) * (x3 - x2);
+        area += vec2(max(h, 0.0), max(-h, 0.0));
+    }
+
+    return area;
+}
+
+void main()
+{
+    size = textureSize(edgesTexture, 0);
+
+    ivec2 p = ivec2(gl_FragCoord.xy);
+    vec2 e = Edges(p);
+
+    vec4 weights = vec4(0.0);
+
+    // horizontal run along the bottom border
+    if (e.g > 0.0) {
+        int left = 0, right = 0;
+
+        while (left < MAX_SEARCH_STEPS && Edges(p + ivec2(-left - 1, 0)).g > 0.0)
+            left++;
+        while (right < MAX_SEARCH_STEPS && Edges(p + ivec2(right + 1, 0)).g > 0.0)
+            right++;
+
+        float sA = Crossing(Edges(p + ivec2(-left, 0)).r, Edges(p + ivec2(-left, -1)).r);
+        float sB = Crossing(Edges(p + ivec2(right + 1, 0)).r, Edges(p + ivec2(right + 1, -1)).r);
+
+        weights.rg = Area(float(-left), float(right + 1), sA, sB);
+    }
+
+    // vertical run along the left border
+    if (e.r > 0.0) {
+        int down = 0, up = 0;
+
+        while (down < MAX_SEARCH_STEPS && Edges(p + ivec2(0, -down - 1)).r > 0.0)
+            down++;
+        while (up < MAX_SEARCH_STEPS && Edges(p + ivec2(0, up + 1)).r > 0.0)
+            up++;
+
+        float sA = Crossing(Edges(p + ivec2(0, -down)).g, Edges(p + ivec2(-1, -down)).g);
+        float sB = Crossing(Edges(p + ivec2(0, up + 1)).g, Edges(p + ivec2(-1, up + 1)).g);
+
+        weights.ba = Area(float(-down), float(up + 1), sA, sB);
+    }
+
+    FragColor = weights;
+}
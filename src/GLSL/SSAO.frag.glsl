@@ -0,0 +1,80 @@
+#version 330 core
+// r: ambient occlusion, g: linear view depth for the bilateral upsample
+out vec2 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D gDepth;
+uniform sampler2D gNormal;
+uniform sampler2D noiseTexture;
+
+#define MAX_KERNEL_SIZE 64
+
+uniform vec3 samples[MAX_KERNEL_SIZE];
+uniform int kernelSize = 16;
+uniform float radius = 0.5;
+uniform float bias = 0.025;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform mat4 invProjection;
+
+// the 4x4 noise tiles over the (reduced) target
+uniform vec2 noiseScale;
+
+// TexCoords only span the scaled viewport, positions are rebuilt in full screen uv
+uniform vec2 uvScale = vec2(1.0);
+
+vec3 DecodeNormal(vec2 f)
+{
+    f = f * 2.0 - 1.0;
+    vec3 n = vec3(f.x, f.y, 1.0 - abs(f.x) - abs(f.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+vec3 ViewPosFromDepth(float depth, vec2 texCoords)
+{
+    vec4 ndc = vec4(vec3(texCoords, depth) * 2.0 - 1.0, 1.0);
+    vec4 viewPos = invProjection * ndc;
+    return viewPos.xyz / viewPos.w;
+}
+
+void main()
+{
+    float depth = texture(gDepth, TexCoords).r;
+
+    // sky, nothing to occlude
+    if (depth == 1.0) {
+        FragColor = vec2(1.0, 0.0);
+        return;
+    }
+
+    vec3 fragPos = ViewPosFromDepth(depth, TexCoords / uvScale);
+    vec3 normal = normalize(mat3(view) * DecodeNormal(texture(gNormal, TexCoords).rg));
+    vec3 randomVec = normalize(texture(noiseTexture, TexCoords * noiseScale).xyz);
+
+    // Gram-Schmidt: random rotation about the normal
+    vec3 tangent = normalize(randomVec - normal * dot(randomVec, normal));
+    vec3 bitangent = cross(normal, tangent);
+    mat3 TBN = mat3(tangent, bitangent, normal);
+
+    float occlusion = 0.0;
+    int size = min(kernelSize, MAX_KERNEL_SIZE);
+
+    for (int i = 0; i < size; ++i) {
+        vec3 samplePos = fragPos + TBN * samples[i] * radius;
+
+        vec4 offset = projection * vec4(samplePos, 1.0);
+        offset.xy = (offset.xy / offset.w) * 0.5 + 0.5;
+
+        float sampleDepth = ViewPosFromDepth(texture(gDepth, offset.xy * uvScale).r, offset.xy).z;
+
+        float rangeCheck = smoothstep(0.0, 1.0, radius / abs(fragPos.z - sampleDepth));
+        occlusion += (sampleDepth >= samplePos.z + bias ? 1.0 : 0.0) * rangeCheck;
+    }
+
+    FragColor = vec2(1.0 - occlusion / float(size), -fragPos.z);
+}
@@ -0,0 +1,53 @@
+#version 330 core
+out float FragColor;
+
+in vec2 TexCoords;
+
+// reduced resolution, r: occlusion, g: linear view depth
+uniform sampler2D ssaoInput;
+// full resolution depth the result is upsampled against
+uniform sampler2D gDepth;
+
+uniform mat4 invProjection;
+uniform vec2 uvScale = vec2(1.0);
+
+// higher keeps edges sharper, lower blurs more across depth changes
+uniform float depthSharpness = 20.0;
+
+float LinearDepth(float depth, vec2 texCoords)
+{
+    vec4 ndc = vec4(vec3(texCoords, depth) * 2.0 - 1.0, 1.0);
+    vec4 viewPos = invProjection * ndc;
+    return -viewPos.z / viewPos.w;
+}
+
+void main()
+{
+    float depth = texture(gDepth, TexCoords).r;
+
+    if (depth == 1.0) {
+        FragColor = 1.0;
+        return;
+    }
+
+    float z = LinearDepth(depth, TexCoords / uvScale);
+    vec2 texelSize = 1.0 / vec2(textureSize(ssaoInput, 0));
+
+    float result = 0.0;
+    float totalWeight = 0.0;
+
+    // 4x4 matches the noise tile, taps that sit on another surface are dropped
+    for (int x = -2; x < 2; ++x) {
+        for (int y = -2; y < 2; ++y) {
+            vec2 tap = texture(ssaoInput, TexCoords + (vec2(x, y) + 0.5) * texelSize).rg;
+
+            float weight = exp(-abs(z - tap.g) / z * depthSharpness);
+            result += tap.r * weight;
+            totalWeight += weight;
+        }
+    }
+
+    FragColor = totalWeight > 0.0001
+        ? result / totalWeight
+        : texture(ssaoInput, TexCoords).r;
+}
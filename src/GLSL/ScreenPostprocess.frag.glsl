@@ -15,9 +15,20 @@ uniform bool grayscale;
 uniform bool gamma;
 uniform bool hdr;
 uniform bool bloom;
+uniform float bloomStrength=0.15;
 
 uniform float exposure=1.0;
 
+// 1x1 adapted scene luminance written on the GPU, never read back
+uniform bool autoExposure;
+uniform sampler2D adaptedLuminance;
+uniform float exposureKey=0.18;
+
+// dynamic resolution: the scene only covers sourceScale of screenTexture
+uniform vec2 sourceScale = vec2(1.0);
+uniform bool upscale;
+uniform float upscaleSharpness = 0.25;
+
 const float offset = 1.0 / 600.0;
 
 vec2 offsets[9] = vec2[](
@@ -32,6 +43,71 @@ vec2 offsets[9] = vec2[](
     vec2( offset, -offset) // bottom-right
 );
 
+// keeps filter taps inside the part of screenTexture drawn this frame
+vec2 ClampToSource(vec2 uv, vec2 texelSize)
+{
+    return clamp(uv, 0.5 * texelSize, sourceScale - 0.5 * texelSize);
+}
+
+// 9 tap Catmull-Rom, the bilinear filter folds the middle two weights of each axis
+vec3 SampleCatmullRom(vec2 uv)
+{
+    vec2 texSize = vec2(textureSize(screenTexture, 0));
+    vec2 texelSize = 1.0 / texSize;
+
+    vec2 samplePos = uv * texSize;
+    vec2 texPos1 = floor(samplePos - 0.5) + 0.5;
+    vec2 f = samplePos - texPos1;
+
+    vec2 w0 = f * (-0.5 + f * (1.0 - 0.5 * f));
+    vec2 w1 = 1.0 + f * f * (-2.5 + 1.5 * f);
+    vec2 w2 = f * (0.5 + f * (2.0 - 1.5 * f));
+    vec2 w3 = f * f * (-0.5 + 0.5 * f);
+
+    vec2 w12 = w1 + w2;
+
+    vec2 uv0 = ClampToSource((texPos1 - 1.0) * texelSize, texelSize);
+    vec2 uv12 = ClampToSource((texPos1 + w2 / w12) * texelSize, texelSize);
+    vec2 uv3 = ClampToSource((texPos1 + 2.0) * texelSize, texelSize);
+
+    vec3 result =
+        texture(screenTexture, vec2(uv0.x,  uv0.y)).rgb * w0.x  * w0.y +
+        texture(screenTexture, vec2(uv12.x, uv0.y)).rgb * w12.x * w0.y +
+        texture(screenTexture, vec2(uv3.x,  uv0.y)).rgb * w3.x  * w0.y +
+
+        texture(screenTexture, vec2(uv0.x,  uv12.y)).rgb * w0.x  * w12.y +
+        texture(screenTexture, vec2(uv12.x, uv12.y)).rgb * w12.x * w12.y +
+        texture(screenTexture, vec2(uv3.x,  uv12.y)).rgb * w3.x  * w12.y +
+
+        texture(screenTexture, vec2(uv0.x,  uv3.y)).rgb * w0.x  * w3.y +
+        texture(screenTexture, vec2(uv12.x, uv3.y)).rgb * w12.x * w3.y +
+        texture(screenTexture, vec2(uv3.x,  uv3.y)).rgb * w3.x  * w3.y;
+
+    // the negative lobes can ring below zero around bright HDR edges
+    return max(result, vec3(0.0));
+}
+
+// Catmull-Rom upsample plus an unsharp mask limited to the source neighborhood
+vec3 process_upscale(vec2 uv) {
+    vec3 color = SampleCatmullRom(uv);
+
+    if (upscaleSharpness <= 0.0)
+        return color;
+
+    vec2 texelSize = 1.0 / vec2(textureSize(screenTexture, 0));
+
+    vec3 n = texture(screenTexture, ClampToSource(uv + vec2(0.0, texelSize.y), texelSize)).rgb;
+    vec3 s = texture(screenTexture, ClampToSource(uv - vec2(0.0, texelSize.y), texelSize)).rgb;
+    vec3 e = texture(screenTexture, ClampToSource(uv + vec2(texelSize.x, 0.0), texelSize)).rgb;
+    vec3 w = texture(screenTexture, ClampToSource(uv - vec2(texelSize.x, 0.0), texelSize)).rgb;
+
+    vec3 minColor = min(min(min(n, s), min(e, w)), color);
+    vec3 maxColor = max(max(max(n, s), max(e, w)), color);
+
+    vec3 sharpened = color + (color - (n + s + e + w) * 0.25) * upscaleSharpness;
+    return clamp(sharpened, minColor, maxColor);
+}
+
 vec3 process_sharpness() {
     const float sharpness_kernel[9] = float[] (
         -1, -1, -1,
@@ -42,7 +118,7 @@ vec3 process_sharpness() {
     vec3 sampleTex[9];
     for (int i = 0; i < 9; i++) {
         // multiply sharpness amount
-        sampleTex[i] = vec3(texture(screenTexture, TexCoords.st
+        sampleTex[i] = vec3(texture(screenTexture, TexCoords.st * sourceScale
                             + (offsets[i] * sharpness)));
     }
 
@@ -63,7 +139,7 @@ vec3 process_blur() {
 
     vec3 sampleTex[9];
     for (int i = 0; i < 9; i++) {
-        sampleTex[i] = vec3(texture(screenTexture, TexCoords.st
+        sampleTex[i] = vec3(texture(screenTexture, TexCoords.st * sourceScale
                             + offsets[i]));
     }
 
@@ -84,7 +160,9 @@ void main()
     } else if (blur) {
         color = process_blur();
     } else {
-        color = texture(screenTexture, TexCoords).rgb;
+        color = upscale
+            ? process_upscale(TexCoords * sourceScale)
+            : texture(screenTexture, TexCoords).rgb;
 
         if (grayscale) {
             const float r_weight = 0.2126;
@@ -99,11 +177,17 @@ void main()
     }
 
     if (bloom)
-        color += texture(bloomTexture, TexCoords).rgb;
+        color += texture(bloomTexture, TexCoords).rgb * bloomStrength;
 
     if (hdr) {
         //color = color / (color + vec3(1.0));
-        color = vec3(1.0) - exp(-color * exposure);
+        float _exposure = exposure;
+
+        // manual exposure stays on top as compensation
+        if (autoExposure)
+            _exposure *= exposureKey / max(texture(adaptedLuminance, vec2(0.5)).r, 0.0001);
+
+        color = vec3(1.0) - exp(-color * _exposure);
     }
 
     if (gamma)
@@ -0,0 +1,108 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+// current frame, rendered with a jittered projection
+uniform sampler2D screenTexture;
+uniform sampler2D historyTexture;
+uniform sampler2D depthTexture;
+
+uniform mat4 invViewProj;
+// last frame, without jitter
+uniform mat4 prevViewProj;
+// offset of the current jitter in uv
+uniform vec2 jitter;
+
+// parts of the targets covered this and last frame
+uniform vec2 uvScale = vec2(1.0);
+uniform vec2 prevUvScale = vec2(1.0);
+
+uniform float feedback = 0.9;
+uniform bool resetHistory;
+
+vec3 RGBToYCoCg(vec3 c)
+{
+    return vec3(
+        dot(c, vec3( 0.25, 0.5,  0.25)),
+        dot(c, vec3( 0.5,  0.0, -0.5)),
+        dot(c, vec3(-0.25, 0.5, -0.25))
+    );
+}
+
+vec3 YCoCgToRGB(vec3 c)
+{
+    return vec3(c.x + c.y - c.z, c.x + c.z, c.x - c.y - c.z);
+}
+
+// blend in a compressed range so single bright pixels do not flicker
+vec3 Tonemap(vec3 c)
+{
+    return c / (1.0 + max(c.r, max(c.g, c.b)));
+}
+
+vec3 TonemapInverse(vec3 c)
+{
+    return c / max(1.0 - max(c.r, max(c.g, c.b)), 0.0001);
+}
+
+void main()
+{
+    vec3 current = texture(screenTexture, TexCoords).rgb;
+
+    if (resetHistory) {
+        FragColor = vec4(current, 1.0);
+        return;
+    }
+
+    vec2 texelSize = 1.0 / vec2(textureSize(screenTexture, 0));
+
+    // neighborhood bounds for the history, and the closest depth so
+    // edges move with the foreground
+    vec3 minColor = vec3(1e9), maxColor = vec3(-1e9);
+    float closestDepth = 1.0;
+    vec2 closestUv = TexCoords;
+
+    for (int x = -1; x <= 1; ++x) {
+        for (int y = -1; y <= 1; ++y) {
+            vec2 uv = TexCoords + vec2(x, y) * texelSize;
+
+            vec3 c = RGBToYCoCg(Tonemap(texture(screenTexture, uv).rgb));
+            minColor = min(minColor, c);
+            maxColor = max(maxColor, c);
+
+            float depth = texture(depthTexture, uv).r;
+            if (depth < closestDepth) {
+                closestDepth = depth;
+                closestUv = uv;
+            }
+        }
+    }
+
+    // per pixel motion from reprojecting the depth into the last frame
+    vec2 screenUv = closestUv / uvScale;
+    vec4 worldPos = invViewProj * vec4(vec3(screenUv, closestDepth) * 2.0 - 1.0, 1.0);
+    vec4 prevClip = prevViewProj * (worldPos / worldPos.w);
+
+    if (prevClip.w <= 0.0) {
+        FragColor = vec4(current, 1.0);
+        return;
+    }
+
+    vec2 prevUv = (prevClip.xy / prevClip.w) * 0.5 + 0.5;
+    vec2 motion = (screenUv - jitter) - prevUv;
+    vec2 historyUv = TexCoords / uvScale - motion;
+
+    // disoccluded from off screen
+    if (any(lessThan(historyUv, vec2(0.0))) || any(greaterThan(historyUv, vec2(1.0)))) {
+        FragColor = vec4(current, 1.0);
+        return;
+    }
+
+    vec3 history = RGBToYCoCg(Tonemap(texture(historyTexture, historyUv * prevUvScale).rgb));
+    history = clamp(history, minColor, maxColor);
+
+    vec3 result = mix(RGBToYCoCg(Tonemap(current)), history, feedback);
+
+    FragColor = vec4(TonemapInverse(YCoCgToRGB(result)), 1.0);
+}
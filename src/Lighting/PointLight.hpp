@@ -122,5 +122,21 @@ public:
     inline void setDistance(const unsigned int distance) {
         this->m_Attenuation = dist_to_atten(distance);
     }
+
+    // Distance at which the brightest channel drops under 5/256,
+    // solved from the attenuation polynomial
+    inline float getRadius() const {
+        glm::vec3 peak = glm::max(glm::max(getAmbient(), getDiffuse()), getSpecular());
+        float i_max = std::fmax(std::fmax(peak.r, peak.g), peak.b);
+
+        const Attenuation& a = m_Attenuation;
+        float c = a.constant - i_max * (256.f / 5.f);
+
+        if (a.quadratic <= 0.f)
+            return a.linear > 0.f ? -c / a.linear : 0.f;
+
+        return (-a.linear + std::sqrt(a.linear * a.linear - 4.f * a.quadratic * c))
+            / (2.f * a.quadratic);
+    }
 };
 #endif
@@ -1,4 +1,5 @@
 #include "Model.hpp"
+#include "Core/Trace.hpp"
 #include "3rdParty/assimp/code/AssetLib/3MF/3MFXmlTags.h"
 #include "Lighting/Material.hpp"
 #include "Lighting/PBRMaterial.hpp"
@@ -14,13 +15,46 @@ Model::Model(const std::string& path, bool pbr, ColorChannel metallic, ColorChan
     m_Pbr = pbr;
     m_MetallicChannel = metallic;
     m_RoughnessChannel = roughness;
-    loadModel(path);
+    loadModel(importScene(path, pbr, false));
 }
 
+Model::Model(const Import& imported, bool pbr, ColorChannel metallic, ColorChannel roughness) {
+    m_Pbr = pbr;
+    m_MetallicChannel = metallic;
+    m_RoughnessChannel = roughness;
+    loadModel(imported);
+}
+
+const std::vector<aiTextureType>& Model::textureTypes(bool pbr) {
+    static const std::vector<aiTextureType> pbrTypes = {
+        aiTextureType_BASE_COLOR,
+        aiTextureType_NORMALS,
+        aiTextureType_METALNESS,
+        aiTextureType_DIFFUSE_ROUGHNESS,
+        aiTextureType_AMBIENT_OCCLUSION
+    };
+    static const std::vector<aiTextureType> phongTypes = {
+        aiTextureType_DIFFUSE,
+        aiTextureType_SPECULAR,
+        aiTextureType_HEIGHT
+    };
+
+    return pbr ? pbrTypes : phongTypes;
+}
+
+std::future<Model::Import> Model::importAsync(const std::string& path, bool pbr) {
+    return std::async(std::launch::async, [path, pbr] { return importScene(path, pbr, true); });
+}
 
-void Model::loadModel(std::string path) {
-    Assimp::Importer importer;
-    const aiScene* scene = importer.ReadFile(path,
+Model::Import Model::importScene(const std::string& path, bool pbr, bool prefetch_textures) {
+    Trace::Zone zone("Import " + std::filesystem::path(path).filename().string());
+
+    Import result;
+    result.path = path;
+    result.started = glfwGetTime();
+    result.importer = std::make_shared<Assimp::Importer>();
+
+    const aiScene* scene = result.importer->ReadFile(path,
         aiProcess_Triangulate |
         aiProcess_FlipUVs |
         aiProcess_GenNormals |
@@ -42,9 +76,35 @@ void Model::loadModel(std::string path) {
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE ||
         !scene->mRootNode)
     {
-        std::cout << "ERROR::ASSIMP::" << importer.GetErrorString() << std::endl;
+        std::cout << "ERROR::ASSIMP::" << result.importer->GetErrorString() << std::endl;
+    }
+    result.scene = scene;
+
+    // same paths and config loadMaterialTextures() asks for later
+    if (scene && prefetch_textures) {
+        const std::string directory = path.substr(0, path.find_last_of('/'));
+
+        TextureConfig tx_conf;
+        tx_conf.flip = false;
+
+        for (unsigned int i = 0; i < scene->mNumMaterials; i++) {
+            for (aiTextureType type : textureTypes(pbr)) {
+                for (unsigned int j = 0; j < scene->mMaterials[i]->GetTextureCount(type); j++) {
+                    aiString str;
+                    scene->mMaterials[i]->GetTexture(type, j, &str);
+                    Texture::prefetch(directory + '/' + str.C_Str(), tx_conf);
+                }
+            }
+        }
     }
-    m_Directory = path.substr(0, path.find_last_of('/'));
+
+    result.finished = glfwGetTime();
+    return result;
+}
+
+void Model::loadModel(const Import& imported) {
+    const aiScene* scene = imported.scene;
+    m_Directory = imported.path.substr(0, imported.path.find_last_of('/'));
 
     std::cout << "ASSIMP::LOAD_MODEL" << std::endl;
     processNode(scene->mRootNode, scene);
@@ -70,12 +130,8 @@ void Model::processNode(aiNode* node, const aiScene* scene) {
     }
 }
 
-Mesh::Ptr Model::processMesh(aiMesh* mesh, const aiScene* scene) {
+std::vector<Vertex> Model::convertVertices(const aiMesh* mesh) {
     std::vector<Vertex> vertices;
-    std::vector<unsigned int> indices;
-    std::vector<Texture::Ptr> textures;
-
-    std::cout << "ASSIMP::VERTEX_COUNT::" << mesh->mNumVertices << std::endl;
 
     for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
         Vertex vertex;
@@ -122,9 +178,19 @@ Mesh::Ptr Model::processMesh(aiMesh* mesh, const aiScene* scene) {
         }
 
         vertices.push_back(vertex);
-
     }
 
+    return vertices;
+}
+
+Mesh::Ptr Model::processMesh(aiMesh* mesh, const aiScene* scene) {
+    std::vector<unsigned int> indices;
+    std::vector<Texture::Ptr> textures;
+
+    std::cout << "ASSIMP::VERTEX_COUNT::" << mesh->mNumVertices << std::endl;
+
+    std::vector<Vertex> vertices = convertVertices(mesh);
+
     std::cout << "ASSIMP::FACE_COUNT::" << mesh->mNumFaces << std::endl;
     for (unsigned int i = 0; i < mesh->mNumFaces; i++)
     {
@@ -141,25 +207,9 @@ Mesh::Ptr Model::processMesh(aiMesh* mesh, const aiScene* scene) {
             return loadMaterialTextures(mtl, type);
         };
 
-        if (m_Pbr) {
-            std::vector<Texture::Ptr> albedoMaps = loadTex(aiTextureType_BASE_COLOR);
-            textures.insert(textures.end(), albedoMaps.begin(), albedoMaps.end());
-            std::vector<Texture::Ptr> normalMaps = loadTex(aiTextureType_NORMALS);
-            textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
-            std::vector<Texture::Ptr> metallicMaps = loadTex(aiTextureType_METALNESS);
-            textures.insert(textures.end(), metallicMaps.begin(), metallicMaps.end());
-            std::vector<Texture::Ptr> roughnessMaps = loadTex(aiTextureType_DIFFUSE_ROUGHNESS);
-            textures.insert(textures.end(), roughnessMaps.begin(), roughnessMaps.end());
-            std::vector<Texture::Ptr> aoMaps = loadTex(aiTextureType_AMBIENT_OCCLUSION);
-            textures.insert(textures.end(), aoMaps.begin(), aoMaps.end());
-        }
-        else {
-            std::vector<Texture::Ptr> diffuseMaps = loadTex(aiTextureType_DIFFUSE);
-            textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
-            std::vector<Texture::Ptr> specularMaps = loadTex(aiTextureType_SPECULAR);
-            textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
-            std::vector<Texture::Ptr> normalMaps = loadTex(aiTextureType_HEIGHT);
-            textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
+        for (aiTextureType type : textureTypes(m_Pbr)) {
+            std::vector<Texture::Ptr> maps = loadTex(type);
+            textures.insert(textures.end(), maps.begin(), maps.end());
         }
     }
 
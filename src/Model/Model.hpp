@@ -20,6 +20,8 @@
 #include <iostream>
 #include <vector>
 #include <filesystem>
+#include <future>
+#include <memory>
 
 
 
@@ -30,6 +32,23 @@ class Model : public MeshGroup {
     using ColorChannel = TextureConfig::ColorChannel;
 public:
 
+    // The CPU side of loading: the Assimp import plus decoding the
+    // textures it references. Needs no GL context.
+    struct Import {
+        std::string path;
+        // owns the scene
+        std::shared_ptr<Assimp::Importer> importer;
+        const aiScene* scene = nullptr;
+
+        // glfwGetTime() on the worker, for the startup timeline
+        double started = 0.0, finished = 0.0;
+    };
+
+    static Import importScene(const std::string& path, bool pbr, bool prefetch_textures);
+    // the vertex half of processMesh(), CPU only
+    static std::vector<Vertex> convertVertices(const aiMesh* mesh);
+    // runs importScene() on a worker thread
+    static std::future<Import> importAsync(const std::string& path, bool pbr = false);
 
     Model(
         const std::string& path, bool pbr = false,
@@ -37,6 +56,13 @@ public:
         ColorChannel roughness = ColorChannel::GREEN
     );
 
+    // creates the meshes and uploads the textures of a finished import
+    Model(
+        const Import& imported, bool pbr = false,
+        ColorChannel metallic = ColorChannel::RED,
+        ColorChannel roughness = ColorChannel::GREEN
+    );
+
     void addModelTexture(const Texture::Ptr& texture)
     {
         if (!isSingleMesh())
@@ -55,7 +81,9 @@ private:
     ColorChannel m_RoughnessChannel;
 
 
-    void loadModel(std::string path);
+    void loadModel(const Import& imported);
+
+    static const std::vector<aiTextureType>& textureTypes(bool pbr);
 
     void processNode(aiNode* node, const aiScene* scene);
     Mesh::Ptr processMesh(aiMesh* mesh, const aiScene* scene);
@@ -0,0 +1,382 @@
+#include "Benchmark.hpp"
+#include "Core/Profiler.hpp"
+#include "Core/RenderStats.hpp"
+#include "Core/Trace.hpp"
+#include "Renderer/Stress.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <type_traits>
+
+namespace renderer::benchmark {
+
+static_assert(std::is_trivially_copyable_v<SessionFrame>, "sessions are stored as raw frames");
+
+constexpr static char SESSION_MAGIC[4] = {'G', 'L', 'R', 'S'};
+constexpr static uint32_t SESSION_VERSION = 1;
+
+bool SessionRecorder::open(const std::string& path) {
+    m_File.open(path, std::ios::binary);
+    if (!m_File)
+        return false;
+
+    const uint32_t header[] = {SESSION_VERSION, sizeof(SessionFrame)};
+    m_File.write(SESSION_MAGIC, sizeof(SESSION_MAGIC));
+    m_File.write(reinterpret_cast<const char*>(header), sizeof(header));
+    return m_File.good();
+}
+
+void SessionRecorder::record(float delta) {
+    if (!m_File.is_open())
+        return;
+
+    SessionFrame frame;
+    frame.delta = delta;
+    frame.position = camera::CAMERA_STATE.Position;
+    frame.yaw = camera::CAMERA_STATE.Yaw;
+    frame.pitch = camera::CAMERA_STATE.Pitch;
+    frame.zoom = camera::CAMERA_STATE.Zoom;
+    frame.state = ENGINE_STATE;
+
+    m_File.write(reinterpret_cast<const char*>(&frame), sizeof(frame));
+}
+
+bool loadSession(const std::string& path, std::vector<SessionFrame>& frames) {
+    std::ifstream file(path, std::ios::binary);
+
+    char magic[4] = {};
+    uint32_t header[2] = {};
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+
+    if (!file || std::memcmp(magic, SESSION_MAGIC, sizeof(magic)) != 0) {
+        std::cerr << "ERROR::BENCHMARK::NOT_A_SESSION::" << path << std::endl;
+        return false;
+    }
+
+    if (header[0] != SESSION_VERSION || header[1] != sizeof(SessionFrame)) {
+        std::cerr << "ERROR::BENCHMARK::SESSION_FROM_ANOTHER_BUILD::" << path << std::endl;
+        return false;
+    }
+
+    SessionFrame frame;
+    while (file.read(reinterpret_cast<char*>(&frame), sizeof(frame)))
+        frames.push_back(frame);
+
+    return !frames.empty();
+}
+
+bool loadPath(const std::string& path, std::vector<CameraKey>& keys) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "ERROR::BENCHMARK::PATH_NOT_FOUND::" << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        line = line.substr(0, line.find('#'));
+
+        CameraKey key;
+        std::istringstream values(line);
+        if (values >> key.time >> key.position.x >> key.position.y >> key.position.z >> key.yaw >> key.pitch)
+            keys.push_back(key);
+    }
+
+    std::sort(keys.begin(), keys.end(), [](const CameraKey& a, const CameraKey& b) {
+        return a.time < b.time;
+    });
+
+    return keys.size() >= 2;
+}
+
+std::vector<CameraKey> defaultPath() {
+    return {
+        { 0.f, glm::vec3(-11.f, 1.5f, -0.5f),   0.f,   5.f},
+        { 4.f, glm::vec3(  0.f, 2.5f,  0.5f),  30.f,  10.f},
+        { 8.f, glm::vec3( 10.f, 2.0f,  0.0f), 180.f,   0.f},
+        {12.f, glm::vec3(  0.f, 6.0f, -3.0f), 200.f, -15.f},
+        {16.f, glm::vec3(-11.f, 1.5f, -0.5f), 360.f,   5.f},
+    };
+}
+
+template<typename T>
+static T catmullRom(const T& p0, const T& p1, const T& p2, const T& p3, float t) {
+    const float t2 = t * t, t3 = t2 * t;
+    return 0.5f * ((2.f * p1) + (p2 - p0) * t + (2.f * p0 - 5.f * p1 + 4.f * p2 - p3) * t2
+        + (3.f * p1 - p0 - 3.f * p2 + p3) * t3);
+}
+
+CameraKey samplePath(const std::vector<CameraKey>& keys, float time) {
+    // loops, the last key should match the first for a seamless one
+    const float start = keys.front().time, duration = keys.back().time - start;
+    if (duration > 0.f)
+        time = start + std::fmod(time, duration);
+
+    size_t i = 0;
+    while (i + 2 < keys.size() && keys[i + 1].time <= time)
+        i++;
+
+    const CameraKey& k0 = keys[i > 0 ? i - 1 : 0];
+    const CameraKey& k1 = keys[i];
+    const CameraKey& k2 = keys[i + 1];
+    const CameraKey& k3 = keys[std::min(i + 2, keys.size() - 1)];
+
+    const float span = k2.time - k1.time;
+    const float t = span > 0.f ? std::clamp((time - k1.time) / span, 0.f, 1.f) : 0.f;
+
+    CameraKey key;
+    key.time = time;
+    key.position = catmullRom(k0.position, k1.position, k2.position, k3.position, t);
+    key.yaw = catmullRom(k0.yaw, k1.yaw, k2.yaw, k3.yaw, t);
+    key.pitch = std::clamp(catmullRom(k0.pitch, k1.pitch, k2.pitch, k3.pitch, t), -89.f, 89.f);
+    return key;
+}
+
+Distribution distribution(std::vector<double> samples) {
+    Distribution result {};
+    result.samples = samples.size();
+    if (samples.empty())
+        return result;
+
+    std::sort(samples.begin(), samples.end());
+
+    double sum = 0.0;
+    for (double sample : samples)
+        sum += sample;
+
+    const auto percentile = [&](double p) {
+        const size_t rank = static_cast<size_t>(std::ceil(p * samples.size()));
+        return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+    };
+
+    result.min = samples.front();
+    result.avg = sum / samples.size();
+    result.p50 = percentile(.50);
+    result.p95 = percentile(.95);
+    result.p99 = percentile(.99);
+    result.max = samples.back();
+    return result;
+}
+
+void writeDistribution(std::ostream& out, std::vector<double> samples) {
+    if (samples.empty()) {
+        out << "null";
+        return;
+    }
+
+    const Distribution d = distribution(std::move(samples));
+
+    out << "{\"min\": " << d.min
+        << ", \"avg\": " << d.avg
+        << ", \"p50\": " << d.p50
+        << ", \"p95\": " << d.p95
+        << ", \"p99\": " << d.p99
+        << ", \"max\": " << d.max
+        << ", \"samples\": " << d.samples << "}";
+}
+
+std::string glString(GLenum name) {
+    const GLubyte* value = glGetString(name);
+    std::string result = value ? reinterpret_cast<const char*>(value) : "";
+    std::replace(result.begin(), result.end(), '"', '\'');
+    return result;
+}
+
+bool measure(const Options& options, Samples& samples) {
+    // repeated runs and sweep rows start from the same light positions
+    stress::reset();
+
+    std::vector<SessionFrame> session;
+    std::vector<CameraKey> keys;
+
+    const bool replay = options.source.ends_with(".session");
+
+    if (replay) {
+        if (!loadSession(options.source, session))
+            return false;
+    } else if (options.source.empty()) {
+        keys = defaultPath();
+    } else if (!loadPath(options.source, keys)) {
+        return false;
+    }
+
+    const unsigned int frames = replay
+        ? std::min<unsigned int>(options.frames, session.size())
+        : options.frames;
+
+    samples = Samples();
+    samples.frames = frames;
+    samples.replay = replay;
+
+    // warmup frames all render the first one, so caches and history buffers settle on it
+    const auto apply = [&](unsigned int frame) {
+        if (replay) {
+            const SessionFrame& recorded = session[frame];
+            ENGINE_STATE = recorded.state;
+            camera::CAMERA_STATE.Position = recorded.position;
+            camera::CAMERA_STATE.Yaw = recorded.yaw;
+            camera::CAMERA_STATE.Pitch = recorded.pitch;
+            camera::CAMERA_STATE.Zoom = recorded.zoom;
+            g_FixedTimestep = recorded.delta;
+        } else {
+            const CameraKey key = samplePath(keys, frame * FIXED_TIMESTEP);
+            camera::CAMERA_STATE.Position = key.position;
+            camera::CAMERA_STATE.Yaw = key.yaw;
+            camera::CAMERA_STATE.Pitch = key.pitch;
+            g_FixedTimestep = FIXED_TIMESTEP;
+        }
+    };
+
+    if (ENGINE_STATE.DYNAMIC_RES_ENBL)
+        std::cerr << "WARNING::BENCHMARK::DYNAMIC_RESOLUTION_FOLLOWS_GPU_TIME" << std::endl;
+
+    RenderStats& totals = samples.totals;
+
+    uint64_t first_frame = 0;
+    profiler->setFrameCallback([&](uint64_t frame, float gpu, float) {
+        if (frame >= first_frame && frame < first_frame + frames)
+            samples.gpuMs.push_back(gpu);
+    });
+
+    for (unsigned int i = 0; i < options.warmup + frames; i++) {
+        const bool measured = i >= options.warmup;
+        const unsigned int frame = measured ? i - options.warmup : 0;
+
+        if (i == options.warmup)
+            first_frame = profiler->getFrameIndex();
+
+        apply(frame);
+
+        const double start = Trace::now();
+        {
+            Trace::Zone zone("Update State");
+            updateState();
+        }
+        render();
+        const double end = Trace::now();
+
+        if (options.present)
+            options.present();
+
+        if (!measured) continue;
+
+        const RenderStats& stats = RenderStats::s_LastFrame;
+        samples.cpuMs.push_back((end - start) / 1e3);
+        samples.drawCalls.push_back(stats.drawCalls);
+        samples.triangles.push_back(stats.triangles);
+        samples.stateChanges.push_back(stats.stateChanges());
+
+        totals.drawCalls += stats.drawCalls;
+        totals.triangles += stats.triangles;
+        totals.programBinds += stats.programBinds;
+        totals.textureBinds += stats.textureBinds;
+        totals.framebufferBinds += stats.framebufferBinds;
+        totals.vertexArrayBinds += stats.vertexArrayBinds;
+    }
+
+    profiler->finish();
+    profiler->setFrameCallback(nullptr);
+    g_FixedTimestep = 0.f;
+
+    return true;
+}
+
+void Samples::append(const Samples& other) {
+    frames += other.frames;
+    replay = other.replay;
+
+    cpuMs.insert(cpuMs.end(), other.cpuMs.begin(), other.cpuMs.end());
+    gpuMs.insert(gpuMs.end(), other.gpuMs.begin(), other.gpuMs.end());
+    drawCalls.insert(drawCalls.end(), other.drawCalls.begin(), other.drawCalls.end());
+    triangles.insert(triangles.end(), other.triangles.begin(), other.triangles.end());
+    stateChanges.insert(stateChanges.end(), other.stateChanges.begin(), other.stateChanges.end());
+
+    totals.drawCalls += other.totals.drawCalls;
+    totals.triangles += other.totals.triangles;
+    totals.programBinds += other.totals.programBinds;
+    totals.textureBinds += other.totals.textureBinds;
+    totals.framebufferBinds += other.totals.framebufferBinds;
+    totals.vertexArrayBinds += other.totals.vertexArrayBinds;
+}
+
+int run(const Options& options) {
+    const results::Context context = results::context(glString(GL_RENDERER));
+    const std::string suite = "benchmark/" + (options.source.empty() ? std::string("default") : options.source)
+        + (options.scene.empty() ? "" : " [" + options.scene + "]");
+
+    Samples samples;
+    for (unsigned int r = 0; r < std::max(options.repeat, 1u); r++) {
+        Samples run;
+        if (!measure(options, run))
+            return -1;
+
+        if (!options.store.empty())
+            results::append(options.store, context, {
+                {suite, "cpu_ms", "ms", run.cpuMs},
+                {suite, "gpu_ms", "ms", run.gpuMs},
+            });
+
+        samples.append(run);
+    }
+
+    const unsigned int frames = samples.frames;
+    const bool replay = samples.replay;
+    const RenderStats& totals = samples.totals;
+
+    std::ofstream out(options.report);
+    if (!out) {
+        std::cerr << "ERROR::BENCHMARK::REPORT_NOT_WRITTEN::" << options.report << std::endl;
+        return -1;
+    }
+
+    const double count = std::max(frames, 1u);
+
+    out << std::fixed << std::setprecision(4);
+    out << "{\n";
+    out << "  \"source\": " << results::quote(options.source.empty() ? "default" : options.source) << ",\n";
+    out << "  \"mode\": \"" << (replay ? "replay" : "path") << "\",\n";
+    out << "  \"scene\": " << results::quote(options.scene.empty() ? "default" : options.scene) << ",\n";
+    out << "  \"frames\": " << frames << ",\n";
+    out << "  \"warmup\": " << options.warmup << ",\n";
+    out << "  \"timestep\": " << (replay ? 0.f : FIXED_TIMESTEP) << ",\n";
+    out << "  \"resolution\": [" << g_Engine.SCREEN_WIDTH << ", " << g_Engine.SCREEN_HEIGHT << "],\n";
+    out << "  \"gl_renderer\": \"" << glString(GL_RENDERER) << "\",\n";
+    out << "  \"gl_version\": \"" << glString(GL_VERSION) << "\",\n";
+    out << "  \"commit\": " << results::quote(results::buildId(context)) << ",\n";
+    out << "  \"machine\": " << results::quote(context.machine) << ",\n";
+    out << "  \"repeat\": " << std::max(options.repeat, 1u) << ",\n";
+    out << "  \"cpu_ms\": "; writeDistribution(out, samples.cpuMs); out << ",\n";
+    out << "  \"gpu_ms\": "; writeDistribution(out, samples.gpuMs); out << ",\n";
+    out << "  \"draw_calls\": "; writeDistribution(out, samples.drawCalls); out << ",\n";
+    out << "  \"triangles\": "; writeDistribution(out, samples.triangles); out << ",\n";
+    out << "  \"state_changes\": "; writeDistribution(out, samples.stateChanges); out << ",\n";
+    out << "  \"binds_per_frame\": {"
+        << "\"program\": " << totals.programBinds / count
+        << ", \"texture\": " << totals.textureBinds / count
+        << ", \"framebuffer\": " << totals.framebufferBinds / count
+        << ", \"vertex_array\": " << totals.vertexArrayBinds / count << "},\n";
+
+    // the profiler only keeps a rolling window, so passes are averaged over its last frames
+    out << "  \"passes_gpu_ms\": {";
+    bool first = true;
+    for (const Profiler::Section& section : profiler->getSections()) {
+        if (section.name == Profiler::FRAME) continue;
+
+        out << (first ? "" : ", ") << "\"" << section.name << "\": " << section.gpuStats.average;
+        first = false;
+    }
+    out << "}\n";
+    out << "}\n";
+
+    std::cout << "BENCHMARK::" << frames << " frames, GPU samples " << samples.gpuMs.size()
+        << ", report " << options.report << std::endl;
+
+    return out.good() ? 0 : -1;
+}
+
+}
@@ -0,0 +1,105 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "Core/RenderStats.hpp"
+#include "Renderer/Camera.hpp"
+#include "Renderer/Renderer.hpp"
+#include "Renderer/Results.hpp"
+
+#include <glm/glm.hpp>
+
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace renderer::benchmark {
+
+constexpr static float FIXED_TIMESTEP = 1.f / 60.f;
+
+// a key of a Catmull-Rom camera path, angles in degrees like the camera's
+struct CameraKey {
+    float time;
+    glm::vec3 position;
+    float yaw;
+    float pitch;
+};
+
+// what a recorded session keeps per frame, applied before updateState()
+struct SessionFrame {
+    float delta;
+    glm::vec3 position;
+    float yaw;
+    float pitch;
+    float zoom;
+    EngineState state;
+};
+
+// Appends the camera and ENGINE_STATE of every frame of a live session.
+// The file is only valid for builds with the same EngineState layout.
+class SessionRecorder {
+private:
+    std::ofstream m_File;
+public:
+    bool open(const std::string& path);
+    void record(float delta);
+};
+
+bool loadSession(const std::string& path, std::vector<SessionFrame>& frames);
+
+// one "time x y z yaw pitch" line per key, # starts a comment
+bool loadPath(const std::string& path, std::vector<CameraKey>& keys);
+// a loop through the Sponza nave
+std::vector<CameraKey> defaultPath();
+
+CameraKey samplePath(const std::vector<CameraKey>& keys, float time);
+
+// nearest rank percentiles, all 0 without samples
+struct Distribution {
+    double min, avg, p50, p95, p99, max;
+    size_t samples;
+};
+
+Distribution distribution(std::vector<double> samples);
+// the distribution as JSON, null without samples
+void writeDistribution(std::ostream& out, std::vector<double> samples);
+// glGetString() with the quotes JSON can't hold replaced
+std::string glString(GLenum name);
+
+struct Options {
+    // .session files are replayed, anything else is read as a camera path, empty is defaultPath()
+    std::string source;
+    unsigned int frames = 600;
+    unsigned int warmup = 60;
+    std::string report = "benchmark.json";
+    // what g_Scenes holds when it isn't the startup scene, stress::describe() of a generated one
+    std::string scene;
+    // runs of the whole path, the report pools them and the store keeps each
+    unsigned int repeat = 1;
+    // results file every run is appended to, empty keeps nothing
+    std::string store = results::DEFAULT_STORE;
+    // called after every frame, swaps the buffers when there is a window
+    std::function<void()> present;
+};
+
+// what the measured frames of a run recorded
+struct Samples {
+    unsigned int frames = 0;
+    bool replay = false;
+    std::vector<double> cpuMs, gpuMs;
+    std::vector<double> drawCalls, triangles, stateChanges;
+    RenderStats totals;
+
+    // adds another run's frames
+    void append(const Samples& other);
+};
+
+// renders the warmup and measured frames with a fixed timestep, false when the source can't be read
+bool measure(const Options& options, Samples& samples);
+
+// measures and writes the JSON report, 0 on success
+int run(const Options& options);
+
+}
+
+#endif
@@ -1,6 +1,7 @@
 #include "Callbacks.hpp"
 #include "GLFW/glfw3.h"
 #include "Camera.hpp"
+#include "Core/Trace.hpp"
 #include "Renderer.hpp"
 #include "Window.hpp"
 #include <iostream>
@@ -40,6 +41,18 @@ void callback::process_input(GLFWwindow *window, float delta_frame)
     } else {
         dt += delta_frame;
     }
+
+    // saves the trace once per press
+    static bool trace_held = false;
+    const bool trace_pressed = glfwGetKey(window, GLFW_KEY_F12) == GLFW_PRESS;
+    if (trace_pressed && !trace_held) {
+        const std::string path = Trace::defaultPath();
+        if (Trace::write(path))
+            std::cout << "TRACE::SAVED::" << path << std::endl;
+        else
+            std::cerr << "TRACE::WRITE_FAILED::" << path << std::endl;
+    }
+    trace_held = trace_pressed;
 }
 
 void callback::mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
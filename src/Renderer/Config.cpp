@@ -0,0 +1,252 @@
+#include "Config.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+namespace renderer::config {
+
+#define GLR_ENGINE_FIELDS(X) \
+    X(UI_ENBL) \
+    X(LIGHT_DIR) X(LIGHT_AMBIENT) X(LIGHT_DIFFUSE) X(LIGHT_SPECULAR) \
+    X(BLINN_ENBL) \
+    X(OBJECT_POS) X(OBJECT_ROTATION) X(OBJ_SCALE) \
+    X(SHARPNESS_ENBL) X(SHARPNESS_AMOUNT) \
+    X(BLUR_ENBL) X(GRAYSCALE_ENBL) \
+    X(CLEAR_DEPTH_BUF) X(CLEAR_COLOR_BUF) X(CLEAR_STENCIL_BUF) X(CLEAR_COLOR) \
+    X(NEAR_PLANE) X(FAR_PLANE) X(FOV) \
+    X(RENDER_WIDTH) X(RENDER_HEIGHT) X(SCREEN_WIDTH) X(SCREEN_HEIGHT) \
+    X(MSAA_ENBL) X(MSAA_MULTIPLIER) \
+    X(POST_AA) \
+    X(SHADOW_ENBL) X(SHADOW_WIDTH) X(SHADOW_HEIGHT) \
+    X(POINT_SHADOW_ENBL) X(POINT_SHADOW_BUDGET) X(POINT_SHADOW_RESOLUTION) \
+    X(SPOT_SHADOW_ENBL) X(SPOT_SHADOW_ATLAS_SIZE) \
+    X(HDR_ENBL) X(HDR_EXPOSURE) \
+    X(AUTO_EXPOSURE_ENBL) X(AUTO_EXPOSURE_KEY) X(AUTO_EXPOSURE_SPEED) \
+    X(BLOOM_ENBL) X(BLOOM_THRESHOLD) X(BLOOM_STRENGTH) X(BLOOM_MIP_LEVELS) \
+    X(DEFERRED_SHADING) X(LIGHT_VOLUMES_ENBL) X(PBR_ENBL) \
+    X(SSAO_ENBL) X(SSAO_SAMPLES) X(SSAO_RADIUS) X(SSAO_RESOLUTION_DIVISOR) \
+    X(DYNAMIC_RES_ENBL) X(DYNAMIC_RES_TARGET_MS) X(DYNAMIC_RES_MIN_SCALE) X(DYNAMIC_RES_SHARPNESS)
+
+static const char* POST_AA_NAMES[] = {"NONE", "FXAA", "SMAA", "TAA"};
+
+static std::string upper(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return std::toupper(c); });
+    return text;
+}
+
+static bool parse(const std::string& text, bool& value) {
+    const std::string word = upper(text);
+    if (word == "1" || word == "TRUE" || word == "ON") { value = true; return true; }
+    if (word == "0" || word == "FALSE" || word == "OFF") { value = false; return true; }
+    return false;
+}
+
+template<typename T>
+requires std::is_arithmetic_v<T>
+static bool parse(const std::string& text, T& value) {
+    // flags are ints in EngineState, so they take the bool spellings too
+    if constexpr (std::is_integral_v<T>) {
+        bool flag;
+        if (parse(text, flag)) {
+            value = flag;
+            return true;
+        }
+    }
+
+    std::istringstream in(text);
+    T parsed;
+    if (!(in >> parsed) || !(in >> std::ws).eof())
+        return false;
+
+    // >> wraps negative numbers into unsigned ones
+    if (std::is_unsigned_v<T> && text.find('-') != std::string::npos)
+        return false;
+
+    value = parsed;
+    return true;
+}
+
+template<glm::length_t L>
+static bool parse(const std::string& text, glm::vec<L, float>& value) {
+    std::istringstream in(text);
+    glm::vec<L, float> parsed;
+
+    for (glm::length_t i = 0; i < L; i++) {
+        if (i > 0 && in.get() != ',')
+            return false;
+        if (!(in >> parsed[i]))
+            return false;
+    }
+
+    if (!(in >> std::ws).eof())
+        return false;
+
+    value = parsed;
+    return true;
+}
+
+static bool parse(const std::string& text, PostAA& value) {
+    const std::string word = upper(text);
+    for (int i = 0; i < 4; i++) {
+        if (word == POST_AA_NAMES[i]) {
+            value = static_cast<PostAA>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+template<typename T>
+static std::string format(const T& value) {
+    std::ostringstream out;
+    out << value;
+    return out.str();
+}
+
+template<glm::length_t L>
+static std::string format(const glm::vec<L, float>& value) {
+    std::ostringstream out;
+    for (glm::length_t i = 0; i < L; i++)
+        out << (i > 0 ? "," : "") << value[i];
+    return out.str();
+}
+
+static std::string format(const PostAA& value) {
+    return POST_AA_NAMES[static_cast<int>(value)];
+}
+
+struct Field {
+    std::function<bool(EngineState&, const std::string&)> set;
+    std::function<std::string(const EngineState&)> get;
+};
+
+template<typename T>
+static Field field(T EngineState::* member) {
+    return {
+        [member](EngineState& state, const std::string& text) { return parse(text, state.*member); },
+        [member](const EngineState& state) { return format(state.*member); }
+    };
+}
+
+static const std::vector<std::pair<std::string, Field>>& fields() {
+    #define GLR_ENGINE_FIELD(name) {#name, field(&EngineState::name)},
+
+    static const std::vector<std::pair<std::string, Field>> table = {
+        GLR_ENGINE_FIELDS(GLR_ENGINE_FIELD)
+
+        {"RENDER_RESOLUTION", {
+            [](EngineState& state, const std::string& text) {
+                unsigned int width, height;
+                char separator;
+                std::istringstream in(text);
+                if (!(in >> width >> separator >> height) || (separator != 'x' && separator != 'X'))
+                    return false;
+                state.RENDER_WIDTH = width;
+                state.RENDER_HEIGHT = height;
+                return true;
+            },
+            [](const EngineState& state) {
+                return std::to_string(state.RENDER_WIDTH) + "x" + std::to_string(state.RENDER_HEIGHT);
+            }
+        }},
+        {"SHADOW_SIZE", {
+            [](EngineState& state, const std::string& text) {
+                unsigned int size;
+                if (!parse(text, size))
+                    return false;
+                state.SHADOW_WIDTH = state.SHADOW_HEIGHT = size;
+                return true;
+            },
+            [](const EngineState& state) { return std::to_string(state.SHADOW_WIDTH); }
+        }},
+    };
+
+    #undef GLR_ENGINE_FIELD
+
+    return table;
+}
+
+static const Field* find(const std::string& name) {
+    static std::unordered_map<std::string, const Field*> indices;
+
+    if (indices.empty()) {
+        for (const auto& [key, field] : fields())
+            indices[key] = &field;
+    }
+
+    auto it = indices.find(upper(name));
+    return it != indices.end() ? it->second : nullptr;
+}
+
+bool set(EngineState& state, const std::string& name, const std::string& value) {
+    const Field* field = find(name);
+    if (!field) {
+        std::cerr << "ERROR::CONFIG::UNKNOWN_FIELD::" << name << std::endl;
+        return false;
+    }
+
+    if (!field->set(state, value)) {
+        std::cerr << "ERROR::CONFIG::INVALID_VALUE::" << name << "::" << value << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool get(const EngineState& state, const std::string& name, std::string& value) {
+    const Field* field = find(name);
+    if (!field)
+        return false;
+
+    value = field->get(state);
+    return true;
+}
+
+std::vector<std::string> names() {
+    std::vector<std::string> result;
+    for (const auto& entry : fields())
+        result.push_back(entry.first);
+    return result;
+}
+
+static std::string trim(const std::string& text) {
+    const size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos)
+        return "";
+    return text.substr(begin, text.find_last_not_of(" \t\r") - begin + 1);
+}
+
+bool assign(EngineState& state, const std::string& assignment) {
+    const size_t equals = assignment.find('=');
+    if (equals == std::string::npos) {
+        std::cerr << "ERROR::CONFIG::EXPECTED_NAME=VALUE::" << assignment << std::endl;
+        return false;
+    }
+
+    return set(state, trim(assignment.substr(0, equals)), trim(assignment.substr(equals + 1)));
+}
+
+bool load(EngineState& state, const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "ERROR::CONFIG::FILE_NOT_FOUND::" << path << std::endl;
+        return false;
+    }
+
+    bool valid = true;
+    std::string line;
+    while (std::getline(file, line)) {
+        line = trim(line.substr(0, line.find('#')));
+        if (!line.empty())
+            valid = assign(state, line) && valid;
+    }
+
+    return valid;
+}
+
+}
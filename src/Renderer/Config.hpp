@@ -0,0 +1,29 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include "Renderer/Renderer.hpp"
+
+#include <string>
+#include <vector>
+
+namespace renderer::config {
+
+// Sets EngineState fields by their name. Values are written like C++ would
+// print them: 1/0, true/false or on/off for flags, x,y,z for vectors, NONE,
+// FXAA, SMAA or TAA for POST_AA. RENDER_RESOLUTION WxH and SHADOW_SIZE N set
+// both dimensions at once.
+bool set(EngineState& state, const std::string& name, const std::string& value);
+bool get(const EngineState& state, const std::string& name, std::string& value);
+
+// every name set() takes
+std::vector<std::string> names();
+
+// "NAME=value", as --set takes it
+bool assign(EngineState& state, const std::string& assignment);
+
+// one "NAME = value" per line, # starts a comment
+bool load(EngineState& state, const std::string& path);
+
+}
+
+#endif
@@ -0,0 +1,316 @@
+#include "Golden.hpp"
+#include "Benchmark.hpp"
+#include "Core/RenderStats.hpp"
+#include "Core/Trace.hpp"
+#include "Util/Png.hpp"
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace renderer::golden {
+
+std::vector<View> canonicalViews() {
+    return {
+        {"pbr-spheres", "pbr", glm::vec3(0.f, 0.f, 27.f), -90.f, 0.f,
+            {
+                {glm::vec3(-10.f,  10.f, 10.f), glm::vec3(1.f)},
+                {glm::vec3( 10.f,  10.f, 10.f), glm::vec3(1.f)},
+                {glm::vec3(-10.f, -10.f, 10.f), glm::vec3(1.f)},
+                {glm::vec3( 10.f, -10.f, 10.f), glm::vec3(1.f)},
+            },
+            [](EngineState& state) { state.PBR_ENBL = true; }},
+        {"sponza-nave", "sponza", glm::vec3(-11.f, 1.5f, -0.5f), 0.f, 5.f, {}, nullptr},
+        {"sponza-deferred-ssao", "sponza", glm::vec3(0.f, 6.f, -3.f), 200.f, -15.f, {},
+            [](EngineState& state) {
+                state.DEFERRED_SHADING = true;
+                state.SSAO_ENBL = true;
+            }},
+        {"normal-planes", "normal", glm::vec3(1.f, 0.f, 3.5f), -90.f, 0.f,
+            {{glm::vec3(0.5f, 0.5f, 1.5f), glm::vec3(1.f)}},
+            nullptr},
+        {"bloom-cubes", "bloom", glm::vec3(0.f, 1.f, 7.f), -90.f, -8.f,
+            {
+                {glm::vec3( 0.0f, 0.5f,  1.5f), glm::vec3(5.f, 5.f, 5.f)},
+                {glm::vec3(-4.0f, 0.5f, -3.0f), glm::vec3(10.f, 0.f, 0.f)},
+                {glm::vec3( 3.0f, 0.5f,  1.0f), glm::vec3(0.f, 0.f, 15.f)},
+                {glm::vec3(-.8f,  2.4f, -1.0f), glm::vec3(0.f, 5.f, 0.f)},
+            },
+            [](EngineState& state) { state.BLOOM_ENBL = true; }},
+    };
+}
+
+static glm::dvec3 toLab(const uint8_t* pixel) {
+    const auto linear = [](uint8_t value) {
+        const double c = value / 255.0;
+        return c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+    };
+
+    const double r = linear(pixel[0]), g = linear(pixel[1]), b = linear(pixel[2]);
+
+    // D65 white
+    const double x = (0.4124 * r + 0.3576 * g + 0.1805 * b) / 0.95047;
+    const double y = (0.2126 * r + 0.7152 * g + 0.0722 * b);
+    const double z = (0.0193 * r + 0.1192 * g + 0.9505 * b) / 1.08883;
+
+    const auto f = [](double t) {
+        return t > 0.008856 ? std::cbrt(t) : 7.787 * t + 16.0 / 116.0;
+    };
+
+    return glm::dvec3(116.0 * f(y) - 16.0, 500.0 * (f(x) - f(y)), 200.0 * (f(y) - f(z)));
+}
+
+static double luma(const uint8_t* pixel) {
+    return 0.299 * pixel[0] + 0.587 * pixel[1] + 0.114 * pixel[2];
+}
+
+static double ssim(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b, unsigned int width, unsigned int height) {
+    constexpr unsigned int WINDOW = 8, STRIDE = 4;
+    constexpr double C1 = (0.01 * 255) * (0.01 * 255);
+    constexpr double C2 = (0.03 * 255) * (0.03 * 255);
+
+    double sum = 0.0;
+    unsigned int windows = 0;
+
+    for (unsigned int y = 0; y + WINDOW <= height; y += STRIDE) {
+        for (unsigned int x = 0; x + WINDOW <= width; x += STRIDE) {
+            double meanA = 0.0, meanB = 0.0, varA = 0.0, varB = 0.0, cov = 0.0;
+
+            for (unsigned int wy = 0; wy < WINDOW; wy++) {
+                for (unsigned int wx = 0; wx < WINDOW; wx++) {
+                    const size_t i = ((y + wy) * width + x + wx) * 4;
+                    const double la = luma(&a[i]), lb = luma(&b[i]);
+                    meanA += la; meanB += lb;
+                    varA += la * la; varB += lb * lb;
+                    cov += la * lb;
+                }
+            }
+
+            const double n = WINDOW * WINDOW;
+            meanA /= n; meanB /= n;
+            varA = varA / n - meanA * meanA;
+            varB = varB / n - meanB * meanB;
+            cov = cov / n - meanA * meanB;
+
+            sum += ((2 * meanA * meanB + C1) * (2 * cov + C2))
+                / ((meanA * meanA + meanB * meanB + C1) * (varA + varB + C2));
+            windows++;
+        }
+    }
+
+    return windows > 0 ? sum / windows : 1.0;
+}
+
+Comparison compare(const std::vector<uint8_t>& reference, const std::vector<uint8_t>& image,
+                   unsigned int width, unsigned int height, const Tolerance& tolerance) {
+    Comparison result {};
+    result.diff.resize(image.size());
+
+    size_t changed = 0;
+    for (size_t i = 0; i < image.size(); i += 4) {
+        const double deltaE = glm::length(toLab(&reference[i]) - toLab(&image[i]));
+        result.maxDeltaE = std::max(result.maxDeltaE, deltaE);
+
+        const bool over = deltaE > tolerance.maxDeltaE;
+        changed += over;
+
+        const uint8_t dimmed = static_cast<uint8_t>(luma(&reference[i]) * .3);
+        result.diff[i + 0] = over ? 255 : dimmed;
+        result.diff[i + 1] = over ? 0 : dimmed;
+        result.diff[i + 2] = over ? 0 : dimmed;
+        result.diff[i + 3] = 255;
+    }
+
+    result.changed = image.empty() ? 0.0 : static_cast<double>(changed) / (image.size() / 4);
+    result.ssim = ssim(reference, image, width, height);
+    result.passed = result.ssim >= tolerance.minSsim && result.changed <= tolerance.maxChanged;
+    return result;
+}
+
+static bool loadReference(const std::string& path, unsigned int width, unsigned int height, std::vector<uint8_t>& pixels) {
+    int w = 0, h = 0, components = 0;
+
+    stbi_set_flip_vertically_on_load_thread(false);
+    uint8_t* data = stbi_load(path.c_str(), &w, &h, &components, 4);
+    if (!data)
+        return false;
+
+    const bool matches = static_cast<unsigned int>(w) == width && static_cast<unsigned int>(h) == height;
+    if (matches)
+        pixels.assign(data, data + static_cast<size_t>(w) * h * 4);
+    else
+        std::cerr << "ERROR::GOLDEN::REFERENCE_SIZE::" << path << "::" << w << "x" << h << std::endl;
+
+    stbi_image_free(data);
+    return matches;
+}
+
+int run(const Options& options) {
+    namespace fs = std::filesystem;
+
+    const unsigned int width = g_Engine.SCREEN_WIDTH, height = g_Engine.SCREEN_HEIGHT;
+
+    if (options.update)
+        fs::create_directories(options.directory);
+
+    // every view starts from the same state, restored afterwards
+    const EngineState baseState = ENGINE_STATE;
+    const std::vector<Scene::Ptr> baseScenes = g_Scenes;
+    const std::vector<Light::Ptr> baseLights = g_Lights;
+
+    std::ofstream out(options.report);
+    if (!out) {
+        std::cerr << "ERROR::GOLDEN::REPORT_NOT_WRITTEN::" << options.report << std::endl;
+        return EXIT_SETUP;
+    }
+
+    // references only hold for the renderer they were made with, see golden/README.md
+    const std::string glRenderer = benchmark::glString(GL_RENDERER);
+    const std::string rendererPath = (fs::path(options.directory) / "renderer.txt").string();
+
+    if (options.update) {
+        std::ofstream(rendererPath) << glRenderer << "\n";
+    } else {
+        std::string referenceRenderer;
+        std::getline(std::ifstream(rendererPath), referenceRenderer);
+
+        if (!referenceRenderer.empty() && referenceRenderer != glRenderer)
+            std::cerr << "WARNING::GOLDEN::RENDERER_MISMATCH::" << referenceRenderer << "::" << glRenderer << std::endl;
+    }
+
+    out << std::fixed << std::setprecision(4);
+    out << "{\n";
+    out << "  \"mode\": \"" << (options.update ? "update" : "compare") << "\",\n";
+    out << "  \"resolution\": [" << width << ", " << height << "],\n";
+    out << "  \"gl_renderer\": \"" << glRenderer << "\",\n";
+    out << "  \"tolerance\": {\"min_ssim\": " << options.tolerance.minSsim
+        << ", \"max_delta_e\": " << options.tolerance.maxDeltaE
+        << ", \"max_changed\": " << options.tolerance.maxChanged << "},\n";
+    out << "  \"views\": [";
+
+    unsigned int failures = 0;
+    unsigned int setupErrors = 0;
+    bool first = true;
+
+    for (const View& view : canonicalViews()) {
+        if (!options.filter.empty() && view.name.find(options.filter) == std::string::npos)
+            continue;
+
+        auto scene = g_SceneLibrary.find(view.scene);
+        if (scene == g_SceneLibrary.end()) {
+            std::cerr << "ERROR::GOLDEN::UNKNOWN_SCENE::" << view.scene << std::endl;
+            setupErrors++;
+            continue;
+        }
+
+        ENGINE_STATE = baseState;
+        if (view.configure)
+            view.configure(ENGINE_STATE);
+
+        g_Scenes = {scene->second};
+        g_Lights = baseLights;
+        for (const auto& [position, color] : view.lights)
+            addPointLight(position, color);
+
+        camera::CAMERA_STATE.Position = view.position;
+        camera::CAMERA_STATE.Yaw = view.yaw;
+        camera::CAMERA_STATE.Pitch = view.pitch;
+        camera::CAMERA_STATE.Zoom = camera::ZOOM;
+        g_FixedTimestep = benchmark::FIXED_TIMESTEP;
+
+        std::vector<double> cpu_ms, gpu_ms, draw_calls;
+
+        const uint64_t first_frame = profiler->getFrameIndex() + options.warmup;
+        profiler->setFrameCallback([&](uint64_t frame, float gpu, float) {
+            if (frame >= first_frame)
+                gpu_ms.push_back(gpu);
+        });
+
+        for (unsigned int i = 0; i < options.warmup + options.frames; i++) {
+            const double start = Trace::now();
+            updateState();
+            render();
+            const double end = Trace::now();
+
+            if (options.present)
+                options.present();
+
+            if (i < options.warmup) continue;
+
+            cpu_ms.push_back((end - start) / 1e3);
+            draw_calls.push_back(RenderStats::s_LastFrame.drawCalls);
+        }
+
+        profiler->finish();
+        profiler->setFrameCallback(nullptr);
+
+        const std::vector<uint8_t> image = readFrame();
+        const std::string reference_path = (fs::path(options.directory) / (view.name + ".png")).string();
+
+        std::string status;
+        Comparison comparison {1.0, 0.0, 0.0, true, {}};
+        std::vector<uint8_t> reference;
+
+        if (options.update) {
+            status = png::write(reference_path, width, height, 4, image) ? "updated" : "not_written";
+        } else if (!fs::exists(reference_path)) {
+            std::cerr << "ERROR::GOLDEN::MISSING_REFERENCE::" << reference_path << std::endl;
+            status = "missing";
+        } else if (!loadReference(reference_path, width, height, reference)) {
+            status = "unreadable";
+        } else {
+            comparison = compare(reference, image, width, height, options.tolerance);
+            status = comparison.passed ? "pass" : "fail";
+
+            if (!comparison.passed) {
+                const fs::path base = fs::path(options.directory) / view.name;
+                png::write(base.string() + ".actual.png", width, height, 4, image);
+                png::write(base.string() + ".diff.png", width, height, 4, comparison.diff);
+            }
+        }
+
+        if (status == "fail")
+            failures++;
+        else if (status != "pass" && status != "updated")
+            setupErrors++;
+
+        out << (first ? "\n" : ",\n");
+        out << "    {\"name\": \"" << view.name << "\", \"scene\": \"" << view.scene << "\", \"status\": \"" << status << "\""
+            << ", \"ssim\": " << comparison.ssim
+            << ", \"changed\": " << comparison.changed
+            << ", \"max_delta_e\": " << comparison.maxDeltaE << ",\n";
+        out << "     \"cpu_ms\": "; benchmark::writeDistribution(out, cpu_ms); out << ",\n";
+        out << "     \"gpu_ms\": "; benchmark::writeDistribution(out, gpu_ms); out << ",\n";
+        out << "     \"draw_calls\": "; benchmark::writeDistribution(out, draw_calls); out << "}";
+        first = false;
+
+        std::cout << "GOLDEN::" << view.name << "::" << status << std::fixed << std::setprecision(4)
+            << "::ssim " << comparison.ssim << ", changed " << comparison.changed * 100.0 << "%" << std::endl;
+    }
+
+    out << "\n  ],\n";
+    out << "  \"failures\": " << failures << ",\n";
+    out << "  \"setup_errors\": " << setupErrors << "\n";
+    out << "}\n";
+
+    ENGINE_STATE = baseState;
+    g_Scenes = baseScenes;
+    g_Lights = baseLights;
+    g_FixedTimestep = 0.f;
+
+    if (failures)
+        return EXIT_REGRESSION;
+    if (setupErrors) {
+        std::cerr << "ERROR::GOLDEN::SETUP::" << setupErrors << " views had nothing to compare against, "
+            << "see golden/README.md for making the references" << std::endl;
+        return EXIT_SETUP;
+    }
+    return out.good() ? 0 : EXIT_SETUP;
+}
+
+}
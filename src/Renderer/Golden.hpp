@@ -0,0 +1,76 @@
+#ifndef GOLDEN_H
+#define GOLDEN_H
+
+#include "Renderer/Renderer.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace renderer::golden {
+
+// a canonical view: one library scene, a camera and the engine settings it tests
+struct View {
+    std::string name;
+    std::string scene;
+    glm::vec3 position;
+    float yaw;
+    float pitch;
+    // point lights added for the view, position and color
+    std::vector<std::pair<glm::vec3, glm::vec3>> lights;
+    std::function<void(EngineState&)> configure;
+};
+
+std::vector<View> canonicalViews();
+
+struct Tolerance {
+    // mean SSIM of the luma over 8x8 windows
+    double minSsim = 0.98;
+    // CIE76 difference a pixel may have before it counts as changed
+    double maxDeltaE = 10.0;
+    // share of changed pixels
+    double maxChanged = 0.002;
+};
+
+struct Comparison {
+    double ssim;
+    double changed;
+    double maxDeltaE;
+    bool passed;
+    // changed pixels red over the dimmed reference
+    std::vector<uint8_t> diff;
+};
+
+// both RGBA, top row first
+Comparison compare(const std::vector<uint8_t>& reference, const std::vector<uint8_t>& image,
+                   unsigned int width, unsigned int height, const Tolerance& tolerance);
+
+struct Options {
+    // holds <view>.png and renderer.txt, failures add <view>.actual.png and <view>.diff.png
+    std::string directory = "golden";
+    // writes the references instead of comparing against them
+    bool update = false;
+    std::string filter;
+    // settles temporal effects before the timed frames, the last one is compared
+    unsigned int warmup = 30;
+    unsigned int frames = 60;
+    std::string report = "golden.json";
+    Tolerance tolerance;
+    std::function<void()> present;
+};
+
+// a view that no longer matches its reference
+constexpr int EXIT_REGRESSION = 1;
+// nothing to compare against: missing references or scenes, or an unwritable report
+constexpr int EXIT_SETUP = 2;
+
+// renders every view, 0 when all match their references
+int run(const Options& options);
+
+}
+
+#endif
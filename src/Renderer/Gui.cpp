@@ -5,6 +5,10 @@
 
 #include "imgui.h"
 #include "Renderer.hpp"
+#include "Core/RenderStats.hpp"
+#include "Core/Trace.hpp"
+#include <algorithm>
+#include <bit>
 #include <cmath>
 #include <iostream>
 #include <memory>
@@ -12,6 +16,98 @@
 #include <unordered_map>
 #include <utility>
 
+static bool show_profiler = false;
+
+// last GPU time of the named profiler sections together, 0 for those that never ran
+static float section_gpu_ms(std::initializer_list<const char*> names) {
+    float ms = 0.f;
+    for (const char* name : names)
+        if (const Profiler::Section* section = renderer::profiler->getSection(name))
+            ms += section->gpu.last();
+    return ms;
+}
+
+void profiler_panel() {
+
+    const Profiler::Ptr& profiler = renderer::profiler;
+    if (!profiler) return;
+
+    ImGuiViewport* window_full = ImGui::GetMainViewport();
+
+    ImGui::SetNextWindowPos(ImVec2(window_full->Pos.x, window_full->Pos.y), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(window_full->Size.x * 0.35, window_full->Size.y * 0.5), ImGuiCond_FirstUseEver);
+
+    if (!ImGui::Begin("Profiler", &show_profiler))
+    {
+        ImGui::End();
+        return;
+    }
+
+    if (const Profiler::Section* frame = profiler->getSection(Profiler::FRAME)) {
+        ImGui::Text("GPU frame: %.2f ms avg, %.2f p95, %.2f p99", frame->gpuStats.average,
+            frame->gpuStats.p95, frame->gpuStats.p99);
+        ImGui::Text("CPU frame: %.2f ms avg, %.2f p95, %.2f p99", frame->cpuStats.average,
+            frame->cpuStats.p95, frame->cpuStats.p99);
+
+        const float scale_max = std::max(frame->gpuStats.p99, frame->cpuStats.p99) * 1.25f;
+        const ImVec2 graph_size(ImGui::GetContentRegionAvail().x, 60.f);
+
+        ImGui::PlotLines("##gpu", frame->gpu.data(), frame->gpu.size(), frame->gpu.getOffset(),
+            "GPU", 0.f, scale_max, graph_size);
+        ImGui::PlotLines("##cpu", frame->cpu.data(), frame->cpu.size(), frame->cpu.getOffset(),
+            "CPU", 0.f, scale_max, graph_size);
+    }
+
+    const RenderStats& stats = RenderStats::s_LastFrame;
+    ImGui::Text("Draw calls: %llu, triangles: %llu", (unsigned long long)stats.drawCalls,
+        (unsigned long long)stats.triangles);
+    ImGui::Text("Binds: %llu programs, %llu textures, %llu framebuffers, %llu vertex arrays",
+        (unsigned long long)stats.programBinds, (unsigned long long)stats.textureBinds,
+        (unsigned long long)stats.framebufferBinds, (unsigned long long)stats.vertexArrayBinds);
+
+    ImGui::Text("Last %u frames, %u dropped while still in flight",
+        Profiler::HISTORY_SIZE, profiler->getDroppedFrames());
+
+    if (ImGui::Button("Save trace (F12)"))
+        Trace::write(Trace::defaultPath());
+    ImGui::SameLine();
+    ImGui::Text("%zu events%s", Trace::getEventCount(),
+        renderer::g_HasDebugGroups ? ", KHR_debug groups on" : "");
+
+    const ImGuiTableFlags table_flags = ImGuiTableFlags_RowBg
+        | ImGuiTableFlags_BordersInnerV
+        | ImGuiTableFlags_SizingStretchProp;
+
+    if (ImGui::BeginTable("Sections", 5, table_flags)) {
+        ImGui::TableSetupColumn("Scope", ImGuiTableColumnFlags_WidthStretch, 2.f);
+        ImGui::TableSetupColumn("GPU avg");
+        ImGui::TableSetupColumn("p95");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableSetupColumn("CPU avg");
+        ImGui::TableHeadersRow();
+
+        for (const Profiler::Section& section : profiler->getSections()) {
+            if (section.name == Profiler::FRAME) continue;
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%*s%s", section.depth * 2, "", section.name.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", section.gpuStats.average);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", section.gpuStats.p95);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", section.gpuStats.p99);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", section.cpuStats.average);
+        }
+
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
+
 void settings_panel() {
 
     using renderer::ENGINE_STATE;
@@ -82,28 +178,61 @@ void settings_panel() {
 
         ImGui::Checkbox("PBR", (bool*)&ENGINE_STATE.PBR_ENBL);
 
-        if (ENGINE_STATE.PBR_ENBL)
-        {
-            ImGui::PushStyleColor(ImGuiCol_Text, IM_COL32(255, 255, 0, 255));
-            ImGui::Text("Deferred Shading is currently not supported with PBR");
-            ImGui::PopStyleColor();
-            ImGui::BeginDisabled();
-        }
-
         ImGui::Checkbox("Deferred Shading", (bool*)&ENGINE_STATE.DEFERRED_SHADING);
 
-        if (ENGINE_STATE.PBR_ENBL)
-            ImGui::EndDisabled();
+        if (ENGINE_STATE.DEFERRED_SHADING) {
+            const unsigned int gbuffer_bpp = GBuffer::BYTES_PER_PIXEL;
+            const float gbuffer_mb = float(gbuffer_bpp) * ENGINE_STATE.RENDER_WIDTH
+                * ENGINE_STATE.RENDER_HEIGHT / (1024.f * 1024.f);
+
+            ImGui::Text("G-Buffer: %u B/px (%.1f MB)", gbuffer_bpp, gbuffer_mb);
+
+            ImGui::Checkbox("Light Volumes", (bool*)&ENGINE_STATE.LIGHT_VOLUMES_ENBL);
+        }
 
         ImGui::Checkbox("Blinn", (bool*)&ENGINE_STATE.BLINN_ENBL);
 
         ImGui::Checkbox("HDR", (bool*)&ENGINE_STATE.HDR_ENBL);
 
-        if (ENGINE_STATE.HDR_ENBL)
+        if (ENGINE_STATE.HDR_ENBL) {
             ImGui::SliderFloat("Exposure", &ENGINE_STATE.HDR_EXPOSURE, 0.f, 5.f);
 
+            ImGui::Checkbox("Auto Exposure", (bool*)&ENGINE_STATE.AUTO_EXPOSURE_ENBL);
+
+            if (ENGINE_STATE.AUTO_EXPOSURE_ENBL) {
+                ImGui::SliderFloat("Key Value", &ENGINE_STATE.AUTO_EXPOSURE_KEY, 0.01f, 1.f);
+                ImGui::SliderFloat("Adaptation Speed", &ENGINE_STATE.AUTO_EXPOSURE_SPEED, 0.1f, 10.f);
+                ImGui::Text("Metering: %s", renderer::g_HasComputeShaders
+                    ? "luminance histogram (compute)"
+                    : "mip reduction");
+            }
+        }
+
         ImGui::Checkbox("Bloom", (bool*)&ENGINE_STATE.BLOOM_ENBL);
 
+        if (ENGINE_STATE.BLOOM_ENBL) {
+            ImGui::SliderFloat("Bloom Threshold", &ENGINE_STATE.BLOOM_THRESHOLD, 0.f, 5.f);
+            ImGui::SliderFloat("Bloom Strength", &ENGINE_STATE.BLOOM_STRENGTH, 0.f, 1.f);
+            ImGui::SliderInt("Bloom Mips", (int*)&ENGINE_STATE.BLOOM_MIP_LEVELS, 1, renderer::BLOOM_MAX_MIP_LEVELS);
+        }
+
+        ImGui::Checkbox("SSAO", (bool*)&ENGINE_STATE.SSAO_ENBL);
+
+        if (ENGINE_STATE.SSAO_ENBL) {
+            ImGui::SliderInt("SSAO Samples", (int*)&ENGINE_STATE.SSAO_SAMPLES, 1, renderer::SSAO_MAX_KERNEL_SIZE);
+            ImGui::SliderFloat("SSAO Radius", &ENGINE_STATE.SSAO_RADIUS, 0.05f, 2.f);
+
+            const char* ssao_resolutions[] = { "Full", "Half", "Quarter" };
+            int ssao_resolution = std::countr_zero(ENGINE_STATE.SSAO_RESOLUTION_DIVISOR);
+
+            if (ImGui::Combo("SSAO Resolution", &ssao_resolution, ssao_resolutions, IM_ARRAYSIZE(ssao_resolutions)))
+                ENGINE_STATE.SSAO_RESOLUTION_DIVISOR = 1u << ssao_resolution;
+
+            ImGui::Text("SSAO: %.2f ms at %ux%u", section_gpu_ms({"SSAO", "SSAO Blur"}),
+                renderer::g_Engine.RENDER_WIDTH / renderer::g_Engine.SSAO_RESOLUTION_DIVISOR,
+                renderer::g_Engine.RENDER_HEIGHT / renderer::g_Engine.SSAO_RESOLUTION_DIVISOR);
+        }
+
 
         ImGui::SeparatorText("Shadows");
 
@@ -130,6 +259,42 @@ void settings_panel() {
             }
         }
 
+        ImGui::BeginDisabled(!renderer::pointShadowsSupported());
+        ImGui::Checkbox("Point light shadows", (bool*)&ENGINE_STATE.POINT_SHADOW_ENBL);
+        ImGui::EndDisabled();
+
+        if (!renderer::pointShadowsSupported())
+            ImGui::TextDisabled("Point light shadows need OpenGL 4.0 cube map arrays");
+
+        if (ENGINE_STATE.POINT_SHADOW_ENBL && renderer::pointShadowsSupported()) {
+            ImGui::SliderInt("Shadow Budget", (int*)&ENGINE_STATE.POINT_SHADOW_BUDGET, 1, renderer::NR_MAX_LIGHTS);
+
+            const char* point_shadow_resolutions[] = { "256", "512", "1024", "2048" };
+            int point_shadow_resolution = std::countr_zero(ENGINE_STATE.POINT_SHADOW_RESOLUTION / 256);
+
+            if (ImGui::Combo("Cube Resolution", &point_shadow_resolution, point_shadow_resolutions,
+                IM_ARRAYSIZE(point_shadow_resolutions)))
+                ENGINE_STATE.POINT_SHADOW_RESOLUTION = 256u << point_shadow_resolution;
+
+            const renderer::ShadowStats stats = renderer::pointShadowStats();
+            ImGui::Text("Point shadows: %.2f ms, %u cubes, %u redrawn",
+                section_gpu_ms({"Point Shadows"}), stats.count, stats.redraws);
+        }
+
+        ImGui::Checkbox("Spot light shadows", (bool*)&ENGINE_STATE.SPOT_SHADOW_ENBL);
+
+        if (ENGINE_STATE.SPOT_SHADOW_ENBL) {
+            const char* spot_atlas_sizes[] = { "1024", "2048", "4096" };
+            int spot_atlas_size = std::countr_zero(ENGINE_STATE.SPOT_SHADOW_ATLAS_SIZE / 1024);
+
+            if (ImGui::Combo("Atlas Size", &spot_atlas_size, spot_atlas_sizes, IM_ARRAYSIZE(spot_atlas_sizes)))
+                ENGINE_STATE.SPOT_SHADOW_ATLAS_SIZE = 1024u << spot_atlas_size;
+
+            const renderer::ShadowStats stats = renderer::spotShadowStats();
+            ImGui::Text("Spot shadows: %.2f ms, %u tiles, %u redrawn",
+                section_gpu_ms({"Spot Shadows"}), stats.count, stats.redraws);
+        }
+
 
         ImGui::SeparatorText("Directional Sun Light");
 
@@ -300,40 +465,125 @@ void settings_panel() {
             ENGINE_STATE.SCREEN_HEIGHT = r.height;
         }
 
+        ImGui::Checkbox("Dynamic Resolution", (bool*)&ENGINE_STATE.DYNAMIC_RES_ENBL);
+
+        if (ENGINE_STATE.DYNAMIC_RES_ENBL) {
+            ImGui::SliderFloat("Target Frame (ms)", &ENGINE_STATE.DYNAMIC_RES_TARGET_MS, 4.f, 50.f, "%.1f");
+            ImGui::SliderFloat("Min Scale", &ENGINE_STATE.DYNAMIC_RES_MIN_SCALE, 0.25f, 1.f);
+            ImGui::SliderFloat("Upscale Sharpness", &ENGINE_STATE.DYNAMIC_RES_SHARPNESS, 0.f, 1.f);
+
+            const glm::uvec2 viewport = renderer::scaledViewport(
+                renderer::g_Engine.RENDER_WIDTH,
+                renderer::g_Engine.RENDER_HEIGHT
+            );
+
+            ImGui::Text("Scale: %.2f (%ux%u), GPU frame: %.2f ms", renderer::g_ResolutionScale,
+                viewport.x, viewport.y, section_gpu_ms({Profiler::FRAME.c_str()}));
+        }
+
         const char* antialiasing_options[] = {
             "Disabled",
             "MSAA x2",
             "MSAA x4",
             "MSAA x8",
+            "FXAA",
+            "SMAA",
+            "TAA",
         };
 
+        // post-process modes follow the MSAA entries
+        constexpr int post_aa_offset = 3;
+
         // not elegant, yet so robust
-        int can_enable_aa = !(ENGINE_STATE.BLOOM_ENBL || ENGINE_STATE.DEFERRED_SHADING);
-        int aa_state = ENGINE_STATE.MSAA_ENBL ? std::log2(ENGINE_STATE.MSAA_MULTIPLIER): 0;
+        int can_enable_msaa = !ENGINE_STATE.DEFERRED_SHADING;
 
-        if (!can_enable_aa) {
-            aa_state = ENGINE_STATE.MSAA_ENBL = false;
+        if (!can_enable_msaa) {
+            ENGINE_STATE.MSAA_ENBL = false;
             ImGui::PushStyleColor(ImGuiCol_Text, IM_COL32(255, 255, 0, 255));
-            ImGui::Text("MSAA cant be enabled with bloom | deferred");
+            ImGui::Text("MSAA cant be enabled with deferred");
             ImGui::PopStyleColor();
-            ImGui::BeginDisabled();
         }
 
-        if (ImGui::Combo(
-            "Antialiasing",
-            &aa_state,
-            antialiasing_options,
-            IM_ARRAYSIZE(antialiasing_options)
-        )) {
-            ENGINE_STATE.MSAA_ENBL = aa_state == 0 ? false : true;
-            ENGINE_STATE.MSAA_MULTIPLIER = std::pow(2, aa_state);
+        int aa_state = ENGINE_STATE.POST_AA != renderer::PostAA::NONE
+            ? post_aa_offset + static_cast<int>(ENGINE_STATE.POST_AA)
+            : ENGINE_STATE.MSAA_ENBL ? std::log2(ENGINE_STATE.MSAA_MULTIPLIER) : 0;
+
+        if (ImGui::BeginCombo("Antialiasing", antialiasing_options[aa_state])) {
+            for (int i = 0; i < IM_ARRAYSIZE(antialiasing_options); i++) {
+                const bool is_msaa = i > 0 && i <= post_aa_offset;
+
+                ImGuiSelectableFlags selectable_flags = is_msaa && !can_enable_msaa
+                    ? ImGuiSelectableFlags_Disabled
+                    : ImGuiSelectableFlags_None;
+
+                if (ImGui::Selectable(antialiasing_options[i], aa_state == i, selectable_flags)) {
+                    ENGINE_STATE.MSAA_ENBL = is_msaa;
+                    if (is_msaa)
+                        ENGINE_STATE.MSAA_MULTIPLIER = std::pow(2, i);
+
+                    ENGINE_STATE.POST_AA = i > post_aa_offset
+                        ? static_cast<renderer::PostAA>(i - post_aa_offset)
+                        : renderer::PostAA::NONE;
+                }
+            }
+
+            ImGui::EndCombo();
         }
 
-        if (!can_enable_aa)
-            ImGui::EndDisabled();
+        // the passes of the running mode only, the others keep their last sample
+        switch (renderer::g_Engine.POST_AA) {
+            case renderer::PostAA::FXAA:
+                ImGui::Text("AA: %.2f ms", section_gpu_ms({"FXAA"}));
+                break;
+            case renderer::PostAA::SMAA:
+                ImGui::Text("AA: %.2f ms", section_gpu_ms({"SMAA Edges", "SMAA Weights", "SMAA Blend"}));
+                break;
+            case renderer::PostAA::TAA:
+                ImGui::Text("AA: %.2f ms", section_gpu_ms({"TAA"}));
+                break;
+            default:
+                break;
+        }
 
         ImGui::ColorEdit4("Clear color", &ENGINE_STATE.CLEAR_COLOR.x);
 
+        ImGui::Checkbox("Show profiler", &show_profiler);
+
+        const FrameGraph::Ptr& graph = renderer::frameGraph;
+        ImGui::Text("Frame graph: %u passes, %u culled", graph->getPassCount(), graph->getCulledCount());
+        ImGui::Text("Transient targets: %u (%.1f MB pooled, %.1f MB peak)", graph->getPoolTextureCount(),
+            graph->getPoolBytes() / (1024.f * 1024.f), graph->getPeakBytes() / (1024.f * 1024.f));
+
+        std::string live;
+        for (const LazyResource::Ptr& resource : renderer::lazyResources)
+            if (resource->isLive())
+                live += (live.empty() ? "" : ", ") + resource->getName();
+        ImGui::TextWrapped("Live features: %s", live.empty() ? "none" : live.c_str());
+
+        ImGui::Text("Shader reload: %s%s, %u swapped, %u failed",
+            renderer::shaderWatcher->isNative() ? "inotify" : "polling",
+            renderer::g_HasParallelShaderCompile ? " + parallel compile" : "",
+            renderer::shaderReloads, renderer::shaderReloadFailures);
+
+        if (renderer::g_HasProgramBinaryCache)
+            ImGui::Text("Program cache: %u loaded, %u compiled",
+                Shader::getBinaryCacheHits(), Shader::getBinaryCacheMisses());
+        else
+            ImGui::TextDisabled("Program cache: needs OpenGL 4.1");
+
+        if (!renderer::lastShaderReload.empty())
+            ImGui::Text("Last change: %s", renderer::lastShaderReload.c_str());
+
+        if (ImGui::TreeNode("Startup timeline")) {
+            for (const renderer::StartupPhase& phase : renderer::startupTimeline)
+                ImGui::Text("%7.1f .. %7.1f ms  %s%s", phase.start * 1000.0, phase.end * 1000.0,
+                    phase.name.c_str(), phase.worker ? " (worker)" : "");
+
+            ImGui::Text("%u of %u programs still compiling once the assets were uploaded",
+                renderer::startupProgramsCompiling, renderer::startupProgramCount);
+            ImGui::TreePop();
+        }
+
         ImGui::SeparatorText("Postprocessing");
 
         static int post_state = 0;
@@ -391,4 +641,7 @@ void GUI::setup(GLFWwindow* window) {
 void GUI::render() {
     if (!renderer::g_Engine.UI_ENBL) return;
     settings_panel();
+
+    if (show_profiler)
+        profiler_panel();
 }
@@ -1,18 +1,32 @@
 #include "Renderer.hpp"
 #include "Camera.hpp"
+#include "Stress.hpp"
 
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <limits>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 #include "Core/FrameBuffer.hpp"
+#include "Core/LazyResource.hpp"
 #include "Core/MeshGroup.hpp"
+#include "Core/Capture.hpp"
+#include "Core/NullGL.hpp"
+#include "Core/Profiler.hpp"
+#include "Core/RenderStats.hpp"
 #include "Core/RenderBuffer.hpp"
 #include "Core/Shader/Shader.hpp"
+#include "Core/Shader/ShaderWatcher.hpp"
+#include "Core/Trace.hpp"
 #include "Core/Shapes/Cube.hpp"
 #include "Core/Shapes/Plane.hpp"
 #include "Core/Shapes/Quad.hpp"
@@ -22,10 +36,13 @@
 #include "Model/Model.hpp"
 
 #include "Texture/ColorBufferTexture.hpp"
+#include "Texture/CubeMapArrayDepthTexture.hpp"
 #include "Texture/CubeMapBufferTexture.hpp"
 #include "Texture/DepthBufferTexture.hpp"
+#include "Texture/DepthStencilBufferTexture.hpp"
 #include "Texture/MonoBufferTexture.hpp"
 #include "Texture/Texture.hpp"
+#include "Util/Png.hpp"
 #include "Texture/MultisampleTexture.hpp"
 #include "Lighting/PointLight.hpp"
 #include "Lighting/SpotLight.hpp"
@@ -57,16 +74,50 @@ Shader::Ptr shaderPhong;
 Shader::Ptr shaderPostProcess;
 Shader::Ptr shaderSkybox;
 Shader::Ptr shaderShadow;
-Shader::Ptr shaderBlur;
+Shader::Ptr shaderPointShadow;
+Shader::Ptr shaderBloomDownsample;
+Shader::Ptr shaderBloomUpsample;
+Shader::Ptr shaderLuminanceHistogram;
+Shader::Ptr shaderLuminanceAverage;
+Shader::Ptr shaderLogLuminance;
+Shader::Ptr shaderLuminanceAdapt;
 Shader::Ptr shaderGBuffer;
 Shader::Ptr shaderGLightPass;
+Shader::Ptr shaderGLightPassPbr;
+Shader::Ptr shaderLightVolume;
+Shader::Ptr shaderLightVolumeStencil;
+Shader::Ptr shaderSSAO;
+Shader::Ptr shaderSSAOBlur;
+Shader::Ptr shaderFXAA;
+Shader::Ptr shaderSMAAEdges;
+Shader::Ptr shaderSMAAWeights;
+Shader::Ptr shaderSMAABlend;
+Shader::Ptr shaderTAA;
 Shader::Ptr shaderPbr;
 Shader::Ptr shaderEquirectangularToCubemap;
 Shader::Ptr shaderIrradiance;
 Shader::Ptr shaderPrefilter;
 Shader::Ptr shaderBrdf;
 
+bool g_HasComputeShaders = false;
+bool g_HasCubeMapArrays = false;
+bool g_HasParallelShaderCompile = false;
+bool g_HasProgramBinaryCache = false;
+bool g_HasDebugGroups = false;
+
+ShaderWatcher::Ptr shaderWatcher;
+unsigned int shaderReloads = 0;
+unsigned int shaderReloadFailures = 0;
+std::string lastShaderReload;
+
+std::vector<StartupPhase> startupTimeline;
+unsigned int startupProgramsCompiling = 0;
+unsigned int startupProgramCount = 0;
+
+float g_ResolutionScale = 1.f;
+
 std::vector<Scene::Ptr> g_Scenes;
+std::unordered_map<std::string, Scene::Ptr> g_SceneLibrary;
 DirectionalLight::Ptr g_SunLight;
 std::vector<Light::Ptr> g_Lights;
 
@@ -75,40 +126,151 @@ glm::mat4 g_Proj;
 glm::mat4 g_LightSpaceMatrix;
 
 FrameBuffer::Ptr fboShadow;
+FrameBuffer::Ptr fboPointShadow;
+FrameBuffer::Ptr fboSpotShadow;
 FrameBuffer::Ptr fboOffscrMSAA;
 FrameBuffer::Ptr fboOffscr;
-FrameBuffer::Ptr fboBlurHoriz;
-FrameBuffer::Ptr fboBlurVert;
-FrameBuffer::Ptr fboSSAO;
-FrameBuffer::Ptr fboSSAOBlur;
+FrameBuffer::Ptr fboLuminance;
 FrameBuffer::Ptr fboCapture;
 
+bool g_Headless = false;
+float g_FixedTimestep = 0.f;
+FrameBuffer::Ptr fboOutput;
+ColorBufferTexture::Ptr texOutput;
+
 GBuffer::Ptr fboGBuffer;
 
-RenderBuffer::Ptr rboOffscr;
+FrameGraph::Ptr frameGraph;
+
+std::vector<LazyResource::Ptr> lazyResources;
+
 RenderBuffer::Ptr rboOffscrMSAA;
 RenderBuffer::Ptr rboCapture;
 
 DepthBufferTexture::Ptr texShadowmap;
+CubeMapArrayDepthTexture::Ptr texPointShadowMaps;
+DepthBufferTexture::Ptr texSpotShadowAtlas;
 ColorBufferTexture::Ptr texOffscr;
-ColorBufferTexture::Ptr texOffscrBright;
+DepthStencilBufferTexture::Ptr texOffscrDepth;
 MultisampleTexture::Ptr texOffscrMSAA;
-ColorBufferTexture::Ptr texBlurHoriz;
-ColorBufferTexture::Ptr texBlurVert;
-MonoBufferTexture::Ptr texSSAO;
-MonoBufferTexture::Ptr texSSAOBlur;
+ColorBufferTexture::Ptr texLuminanceHistogram;
+ColorBufferTexture::Ptr texLogLuminance;
+std::array<ColorBufferTexture::Ptr, 2> texAdaptedLuminance;
 Texture::Ptr texSSAONoise;
+std::array<ColorBufferTexture::Ptr, 2> texTAAHistory;
 CubeMapBufferTexture::Ptr texEnvironmentMap;
 CubeMapBufferTexture::Ptr texIrradianceMap;
 CubeMapBufferTexture::Ptr texPrefilterMap;
 ColorBufferTexture::Ptr texBrdfLUT;
 
 Quad::Ptr screenQuad;
+Sphere::Ptr lightVolumeSphere;
 Cube::Ptr pointLightsCube;
 Cube::Ptr spotLightsCube;
 
 Skybox::Ptr skybox;
 
+Profiler::Ptr profiler;
+
+unsigned int pointShadowCount = 0;
+unsigned int pointShadowRedraws = 0;
+unsigned int spotShadowCount = 0;
+unsigned int spotShadowRedraws = 0;
+
+// coarse is enough, the light volume shader clips to the exact radius
+constexpr static unsigned int LIGHT_VOLUME_SEGMENTS = 16;
+
+// log2 luminance range metered for auto exposure
+constexpr static float EXPOSURE_MIN_LOG_LUM = -10.f;
+constexpr static float EXPOSURE_MAX_LOG_LUM = 6.f;
+constexpr static unsigned int HISTOGRAM_BINS = 256;
+constexpr static unsigned int LOG_LUMINANCE_SIZE = 256;
+
+// length of the Halton(2, 3) jitter sequence
+constexpr static unsigned int TAA_JITTER_SAMPLES = 8;
+
+// texTAAHistory[index] holds the latest resolve, the other one last frame's
+unsigned int taaHistoryIndex = 0;
+unsigned int taaFrameIndex = 0;
+bool resetTAAHistory = true;
+glm::vec2 taaJitter(0.f);
+glm::mat4 prevViewProj(1.f);
+// part of the history texture last frame's resolve covered
+glm::vec2 prevUvScale(1.f);
+
+// frame time error ignored by the resolution governor, and how much of the
+// correction it applies per frame so the scale does not oscillate
+constexpr static float DYNAMIC_RES_DEADBAND = 0.05f;
+constexpr static float DYNAMIC_RES_DAMPING = 0.1f;
+
+// transient frame graph targets are attached here by whichever pass draws into them
+FrameBuffer::Ptr fboTransient;
+
+// resolved SSAO of this frame, only set while the scene pass runs
+Texture::Ptr ssaoResult;
+
+// hemisphere samples, regenerated when the sample count changes
+std::vector<glm::vec3> ssaoKernel;
+
+// a disabled feature keeps its resources this long in case it comes right back
+constexpr static double LAZY_RELEASE_SECONDS = 5.0;
+
+LazyResource::Ptr lazyForwardPhong;
+LazyResource::Ptr lazyForwardPbr;
+LazyResource::Ptr lazyMSAA;
+LazyResource::Ptr lazyGBuffer;
+LazyResource::Ptr lazyDeferredPhong;
+LazyResource::Ptr lazyDeferredPbr;
+LazyResource::Ptr lazyLightVolumes;
+LazyResource::Ptr lazySSAO;
+LazyResource::Ptr lazyBloom;
+LazyResource::Ptr lazyExposure;
+LazyResource::Ptr lazyFXAA;
+LazyResource::Ptr lazySMAA;
+LazyResource::Ptr lazyTAA;
+LazyResource::Ptr lazyPointShadows;
+LazyResource::Ptr lazySpotShadows;
+
+// near plane of the point shadow cubes, the far plane is the light radius
+constexpr static float POINT_SHADOW_NEAR = 0.05f;
+
+// one cube of texPointShadowMaps
+struct PointShadowSlot {
+    // owner this frame, null if the cube is unassigned
+    const Light* light = nullptr;
+
+    // what the stored map was rendered for, it is reused while these hold
+    glm::vec3 position = glm::vec3(0.f);
+    float farPlane = 0.f;
+    size_t casterHash = 0;
+    bool valid = false;
+};
+
+std::vector<PointShadowSlot> pointShadowSlots;
+
+constexpr static float SPOT_SHADOW_NEAR = 0.05f;
+// tiles are powers of two between this and half the atlas
+constexpr static unsigned int SPOT_SHADOW_MIN_TILE = 128;
+
+// square of texSpotShadowAtlas a spot light rendered into
+struct SpotShadowTile {
+    const Light* light = nullptr;
+
+    glm::uvec2 offset = glm::uvec2(0);
+    unsigned int size = 0;
+    float farPlane = 0.f;
+
+    glm::mat4 lightSpace = glm::mat4(1.f);
+    size_t casterHash = 0;
+};
+
+// reallocated every frame, a tile is only redrawn if it differs from last frame's
+std::vector<SpotShadowTile> spotShadowTiles;
+
+// texAdaptedLuminance[index] holds the latest result, the other one last frame's
+unsigned int adaptedLuminanceIndex = 0;
+bool resetAdaptation = true;
+double lastExposureTime = 0.0;
 
 glm::mat4 captureProjection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 10.0f);
 glm::mat4 captureViews[] =
@@ -121,6 +283,105 @@ glm::mat4 captureViews[] =
         glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3( 0.0f,  0.0f, -1.0f), glm::vec3(0.0f, -1.0f,  0.0f))
     };
 
+const std::string SHADER_DIR = "./src/GLSL/";
+const std::string SHADER_CACHE_DIR = "./shader_cache/";
+
+const std::string SPath(const std::string& p) {
+    return SHADER_DIR + p;
+}
+
+// starts a reload for every program using a saved file and swaps in the
+// ones that finished linking, failures keep running the old program
+void reloadShaders() {
+    for (const std::string& file : shaderWatcher->poll()) {
+        for (Shader* shader : Shader::getInstances()) {
+            if (shader->usesFile(file) && shader->beginReload())
+                lastShaderReload = file;
+        }
+    }
+
+    for (Shader* shader : Shader::getInstances()) {
+        switch (shader->pollReload()) {
+            case Shader::ReloadStatus::Swapped:
+                shaderReloads++;
+                break;
+            case Shader::ReloadStatus::Failed:
+                shaderReloadFailures++;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+LazyResource::Ptr addLazyResource(
+    const std::string& name,
+    LazyResource::Callback create,
+    LazyResource::Callback release
+) {
+    lazyResources.push_back(LazyResource::New(name, std::move(create), std::move(release)));
+    return lazyResources.back();
+}
+
+// the sampler always needs a unit of its own, even when no light has a cube
+void sendPointShadowUniforms(const Shader::Ptr& shader) {
+    shader->setInt("pointShadowMaps", TEXTURE_SLOT_POINT_SHADOW);
+
+    if (texPointShadowMaps != nullptr) {
+        texPointShadowMaps->setSlot(TEXTURE_SLOT_POINT_SHADOW);
+        texPointShadowMaps->bind();
+    }
+}
+
+void sendPointLightShadow(const Shader::Ptr& shader, const std::string& base, const Light::Ptr& light) {
+    int layer = -1;
+    float farPlane = 1.f;
+
+    if (g_Engine.POINT_SHADOW_ENBL && lazyPointShadows->isLive()) {
+        for (unsigned int i = 0; i < pointShadowSlots.size(); i++) {
+            if (pointShadowSlots[i].light != light.get()) continue;
+
+            layer = i;
+            farPlane = pointShadowSlots[i].farPlane;
+            break;
+        }
+    }
+
+    shader->setInt(base + ".shadowLayer", layer);
+    shader->setFloat(base + ".shadowFar", farPlane);
+}
+
+void sendSpotShadowUniforms(const Shader::Ptr& shader) {
+    shader->setInt("spotShadowAtlas", TEXTURE_SLOT_SPOT_SHADOW);
+    shader->setFloat("spotShadowNear", SPOT_SHADOW_NEAR);
+
+    if (texSpotShadowAtlas != nullptr) {
+        texSpotShadowAtlas->setSlot(TEXTURE_SLOT_SPOT_SHADOW);
+        texSpotShadowAtlas->bind();
+    }
+}
+
+// rect is the tile in atlas uv, with the far plane in w. Zero size means no shadow
+void sendSpotLightShadow(const Shader::Ptr& shader, const std::string& base, const Light::Ptr& light) {
+    glm::mat4 lightSpace(1.f);
+    glm::vec4 rect(0.f);
+
+    if (g_Engine.SPOT_SHADOW_ENBL && lazySpotShadows->isLive()) {
+        const float atlas = texSpotShadowAtlas->getWidth();
+
+        for (const SpotShadowTile& tile : spotShadowTiles) {
+            if (tile.light != light.get()) continue;
+
+            lightSpace = tile.lightSpace;
+            rect = glm::vec4(glm::vec2(tile.offset) / atlas, tile.size / atlas, tile.farPlane);
+            break;
+        }
+    }
+
+    shader->setMat4(base + ".shadowMatrix", lightSpace);
+    shader->setVec4(base + ".shadowRect", rect);
+}
+
 void sendLightUniforms(const Shader::Ptr& shader) {
     shader->use();
 
@@ -150,6 +411,8 @@ void sendLightUniforms(const Shader::Ptr& shader) {
             shader->setFloat(base + ".linear", atten.linear);
             shader->setFloat(base + ".quadratic", atten.quadratic);
 
+            sendPointLightShadow(shader, base, light);
+
             pointLightIndex++;
         }
 
@@ -174,12 +437,17 @@ void sendLightUniforms(const Shader::Ptr& shader) {
             shader->setFloat(base + ".cutOff", sl->getCutOff());
             shader->setFloat(base + ".outerCutOff", sl->getOuterCutOff());
 
+            sendSpotLightShadow(shader, base, light);
+
             spotLightIndex++;
         }
     }
 
     shader->setInt("material.shininess", 32);
 
+    sendPointShadowUniforms(shader);
+    sendSpotShadowUniforms(shader);
+
     shader->setVec3("directionalLight.direction", g_SunLight->getDirection());
     shader->setVec3("directionalLight.ambient", g_SunLight->getAmbient());
     shader->setVec3("directionalLight.diffuse", g_SunLight->getDiffuse());
@@ -201,10 +469,13 @@ void sendLightPbrUniforms(const Shader::Ptr& shader) {
             std::string base = "pointLights[" + std::to_string(pointLightIndex) + "]";
             shader->setVec3(base + ".position", pl->getPosition());
             shader->setVec3(base + ".color", pl->getAveragedColor());
+            sendPointLightShadow(shader, base, light);
             pointLightIndex++;
         }
     }
 
+    sendPointShadowUniforms(shader);
+
     shader->setVec3("directionalLight.direction", g_SunLight->getDirection());
     shader->setVec3("directionalLight.color", g_SunLight->getAveragedColor());
 }
@@ -323,6 +594,9 @@ void renderScenes(const Shader::Ptr& shader) {
 
                 pbr |= mesh->getMaterial()->getType() == MaterialType::PBR;
 
+                // only read by the G-Buffer, which serves both lighting models
+                shader->setBool("pbr", pbr && g_Engine.PBR_ENBL);
+
                 if (pbr && g_Engine.PBR_ENBL) {
                     shader->setBool("hasAlbedo", hasAlbedo);
                     shader->setBool("hasMetallic", hasMetallic);
@@ -404,8 +678,8 @@ void renderScenes(const Shader::Ptr& shader) {
     }
 }
 
-void renderScenesDepth() {
-    shaderShadow->use();
+void renderScenesDepth(const Shader::Ptr& shader) {
+    shader->use();
 
     for (const Scene::Ptr& scene : g_Scenes) {
         for (const MeshGroup::Ptr& mesh_group : scene->getMeshGroups()) {
@@ -414,7 +688,7 @@ void renderScenesDepth() {
                 glm::mat4 scene_model = glm::translate(scene->getModelMatrix(), g_Engine.OBJECT_POS);
                 glm::mat4 model = scene_model * mesh->getModelMatrix();
 
-                shaderShadow->setMat4("model", model);
+                shader->setMat4("model", model);
 
                 mesh->draw();
             }
@@ -422,6 +696,28 @@ void renderScenesDepth() {
     }
 }
 
+glm::uvec2 scaledViewport(unsigned int width, unsigned int height) {
+    return glm::uvec2(
+        std::max(static_cast<unsigned int>(std::round(width * g_ResolutionScale)), 1u),
+        std::max(static_cast<unsigned int>(std::round(height * g_ResolutionScale)), 1u)
+    );
+}
+
+// screen space passes read the scaled viewport out of full size targets
+glm::vec2 viewportUvScale() {
+    return glm::vec2(scaledViewport(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT)) /
+        glm::vec2(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+}
+
+void sendSSAOUniforms(const Shader::Ptr& shader) {
+    shader->setBool("hasSSAO", ssaoResult != nullptr);
+    shader->setInt("ssaoMap", TEXTURE_SLOT_SSAO);
+
+    if (ssaoResult == nullptr) return;
+
+    ssaoResult->setSlot(TEXTURE_SLOT_SSAO);
+    ssaoResult->bind();
+}
 
 void sendOffscrUniforms(const Shader::Ptr& shader) {
     shader->setBool("deferred", false);
@@ -437,6 +733,8 @@ void sendOffscrUniforms(const Shader::Ptr& shader) {
     shader->setInt("materialMaps.specular", TEXTURE_SLOT_SPECULAR);
     shader->setInt("materialMaps.shadow", TEXTURE_SLOT_SHADOW);
     shader->setInt("materialMaps.normal", TEXTURE_SLOT_NORMAL);
+
+    sendSSAOUniforms(shader);
 }
 
 void sendOffscrPbrUniforms(const Shader::Ptr& shader) {
@@ -468,6 +766,8 @@ void sendOffscrPbrUniforms(const Shader::Ptr& shader) {
     shader->setBool("hasShadow", g_Engine.SHADOW_ENBL);
     shader->setInt("shadowMap", TEXTURE_SLOT_SHADOW_PBR);
 
+    sendSSAOUniforms(shader);
+
     if (hasIBLMaps) {
         texIrradianceMap->bind();
         texPrefilterMap->bind();
@@ -487,19 +787,212 @@ void sendLightPassUniforms(const Shader::Ptr& shader) {
 
     shader->setInt("materialMaps.shadow", TEXTURE_SLOT_SHADOW);
 
-    shader->setInt("deferredMaps.gPosition", TEXTURE_SLOT_DEFERRED_POSITION);
+    shader->setMat4("invViewProj", glm::inverse(g_Proj * g_View));
+    shader->setMat4("lightSpaceMatrix", g_LightSpaceMatrix);
+
+    shader->setInt("deferredMaps.gDepth", TEXTURE_SLOT_DEFERRED_DEPTH);
+    shader->setInt("deferredMaps.gNormal", TEXTURE_SLOT_DEFERRED_NORMAL);
+    shader->setInt("deferredMaps.gAlbedoSpec", TEXTURE_SLOT_DEFERRED_ALBEDOSPEC);
+
+    shader->setVec2("uvScale", viewportUvScale());
+
+    sendSSAOUniforms(shader);
+}
+
+void sendLightPassPbrUniforms(const Shader::Ptr& shader) {
+    shader->setBool("deferred", true);
+
+    shader->setVec3("camPos", camera::g_Camera.Position);
+
+    shader->setBool("hasShadow", g_Engine.SHADOW_ENBL);
+    shader->setInt("shadowMap", TEXTURE_SLOT_SHADOW_PBR);
+
+    shader->setMat4("invViewProj", glm::inverse(g_Proj * g_View));
+    shader->setMat4("lightSpaceMatrix", g_LightSpaceMatrix);
+
+    shader->setInt("deferredMaps.gDepth", TEXTURE_SLOT_DEFERRED_DEPTH);
     shader->setInt("deferredMaps.gNormal", TEXTURE_SLOT_DEFERRED_NORMAL);
     shader->setInt("deferredMaps.gAlbedoSpec", TEXTURE_SLOT_DEFERRED_ALBEDOSPEC);
-    shader->setInt("deferredMaps.gPositionLightSpace", TEXTURE_SLOT_DEFERRED_POSITION_LIGHT_SPACE);
+    shader->setInt("deferredMaps.gMaterial", TEXTURE_SLOT_DEFERRED_MATERIAL);
+
+    shader->setVec2("uvScale", viewportUvScale());
+
+    sendSSAOUniforms(shader);
+
+    bool hasIBLMaps =
+        texIrradianceMap != nullptr &&
+        texPrefilterMap != nullptr &&
+        texBrdfLUT != nullptr;
+
+    shader->setBool("hasIBLMaps", hasIBLMaps);
+
+    shader->setInt("irradianceMap", TEXTURE_SLOT_IRRADIANCE);
+    shader->setInt("prefilterMap", TEXTURE_SLOT_PREFILTER);
+    shader->setInt("brdfLUT", TEXTURE_SLOT_BRDF_LUT);
+
+    if (hasIBLMaps) {
+        texIrradianceMap->setSlot(TEXTURE_SLOT_IRRADIANCE);
+        texPrefilterMap->setSlot(TEXTURE_SLOT_PREFILTER);
+        texBrdfLUT->setSlot(TEXTURE_SLOT_BRDF_LUT);
+        texIrradianceMap->bind();
+        texPrefilterMap->bind();
+        texBrdfLUT->bind();
+    }
 }
 
-void backBufferPass() {
-    if (g_Engine.MSAA_ENBL)
+float lightVolumeRadius(const PointLight::Ptr& pl) {
+    if (!g_Engine.PBR_ENBL)
+        return pl->getRadius();
+
+    // PBR lights only fall off with the inverse square
+    glm::vec3 color = pl->getAveragedColor();
+    return std::sqrt(std::fmax(std::fmax(color.r, color.g), color.b) * (256.f / 5.f));
+}
+
+unsigned int sendLightVolumeUniforms(const Shader::Ptr& shader) {
+    shader->use();
+
+    shader->setMat4("viewProj", g_Proj * g_View);
+    shader->setMat4("invViewProj", glm::inverse(g_Proj * g_View));
+    shader->setVec3("viewPos", camera::g_Camera.Position);
+
+    // tessellated faces sit at most cos(pi / segments) in on both axes
+    const float inset = std::cos(PI / LIGHT_VOLUME_SEGMENTS);
+    shader->setFloat("volumeScale", 1.f / (inset * inset));
+
+    shader->setBool("pbr", g_Engine.PBR_ENBL);
+    shader->setBool("blinn", g_Engine.BLINN_ENBL);
+    shader->setFloat("shininess", 32.f);
+
+    shader->setInt("deferredMaps.gDepth", TEXTURE_SLOT_DEFERRED_DEPTH);
+    shader->setInt("deferredMaps.gNormal", TEXTURE_SLOT_DEFERRED_NORMAL);
+    shader->setInt("deferredMaps.gAlbedoSpec", TEXTURE_SLOT_DEFERRED_ALBEDOSPEC);
+    shader->setInt("deferredMaps.gMaterial", TEXTURE_SLOT_DEFERRED_MATERIAL);
+
+    shader->setVec2("uvScale", viewportUvScale());
+
+    sendSSAOUniforms(shader);
+    sendPointShadowUniforms(shader);
+    sendSpotShadowUniforms(shader);
+
+    unsigned int lightIndex = 0;
+
+    for (const Light::Ptr& light : g_Lights) {
+        LightType light_type = light->getType();
+
+        // the PBR light passes only know point lights
+        if (light_type == LightType::SpotLight && g_Engine.PBR_ENBL)
+            continue;
+
+        if (light_type != LightType::PointLight && light_type != LightType::SpotLight)
+            continue;
+
+        PointLight::Ptr pl = std::dynamic_pointer_cast<PointLight, Light>(light);
+
+        float radius = lightVolumeRadius(pl);
+        shader->setVec4("lightSpheres[" + std::to_string(lightIndex) + "]",
+            glm::vec4(pl->getPosition(), radius));
+
+        std::string base = "lights[" + std::to_string(lightIndex) + "]";
+        shader->setVec3(base + ".position", pl->getPosition());
+        shader->setFloat(base + ".radius", radius);
+
+        shader->setVec3(base + ".ambient", pl->getAmbient());
+        shader->setVec3(base + ".diffuse", pl->getDiffuse());
+        shader->setVec3(base + ".specular", pl->getSpecular());
+        shader->setVec3(base + ".color", pl->getAveragedColor());
+
+        Attenuation atten = pl->getAttenuation();
+
+        shader->setFloat(base + ".constant", atten.constant);
+        shader->setFloat(base + ".linear", atten.linear);
+        shader->setFloat(base + ".quadratic", atten.quadratic);
+
+        shader->setBool(base + ".spot", light_type == LightType::SpotLight);
+        sendPointLightShadow(shader, base, light);
+
+        if (light_type == LightType::SpotLight) {
+            SpotLight::Ptr sl = std::dynamic_pointer_cast<SpotLight, Light>(light);
+            shader->setVec3(base + ".direction", sl->getDirection());
+            shader->setFloat(base + ".cutOff", sl->getCutOff());
+            shader->setFloat(base + ".outerCutOff", sl->getOuterCutOff());
+        }
+
+        sendSpotLightShadow(shader, base, light);
+
+        lightIndex++;
+    }
+
+    return lightIndex;
+}
+
+// Expects the G-Buffer depth in the bound framebuffer and its textures bound
+void lightVolumePass() {
+    lazyLightVolumes->require();
+
+    unsigned int count = sendLightVolumeUniforms(shaderLightVolumeStencil);
+    sendLightVolumeUniforms(shaderLightVolume);
+
+    if (count == 0) return;
+
+    // 1st: count volume faces behind the scene, nonzero means inside a volume
+    shaderLightVolumeStencil->use();
+
+    glClear(GL_STENCIL_BUFFER_BIT);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+    glEnable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+
+    glStencilFunc(GL_ALWAYS, 0, 0xFF);
+    glStencilOpSeparate(GL_BACK, GL_KEEP, GL_INCR_WRAP, GL_KEEP);
+    glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_DECR_WRAP, GL_KEEP);
+
+    lightVolumeSphere->drawInstanced(count);
+
+    // 2nd: shade marked pixels, back faces keep working with the camera inside
+    shaderLightVolume->use();
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glStencilFunc(GL_NOTEQUAL, 0, 0xFF);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_FRONT);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+
+    lightVolumeSphere->drawInstanced(count);
+
+    glDisable(GL_BLEND);
+    glCullFace(GL_BACK);
+    glDisable(GL_CULL_FACE);
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_TRUE);
+    glStencilFunc(GL_ALWAYS, 0, 0xFF);
+}
+
+void sendGBufferUniforms(const Shader::Ptr& shader) {
+    sendOffscrUniforms(shader);
+
+    shader->setInt("materialMaps.roughness", TEXTURE_SLOT_ROUGHNESS);
+    shader->setInt("materialMaps.ao", TEXTURE_SLOT_AO);
+}
+
+void backBufferPass(const Texture::Ptr& ssao) {
+    ssaoResult = ssao;
+
+    if (g_Engine.MSAA_ENBL) {
+        lazyMSAA->require();
         fboOffscrMSAA->bind();
-    else
+    } else {
         fboOffscr->bind();
+    }
 
-    glViewport(0, 0, g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+    const glm::uvec2 viewport = scaledViewport(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+    glViewport(0, 0, viewport.x, viewport.y);
 
     glEnable(GL_DEPTH_TEST);
 
@@ -515,25 +1008,53 @@ void backBufferPass() {
     // Draw Scene
 
     if (g_Engine.DEFERRED_SHADING) {
-        shaderGLightPass->use();
         fboGBuffer->bindTextures();
+
+        texShadowmap->setSlot(TEXTURE_SLOT_SHADOW);
         texShadowmap->bind();
-        sendLightPassUniforms(shaderGLightPass);
-        sendLightUniforms(shaderGLightPass);
+
+        (g_Engine.PBR_ENBL ? lazyDeferredPbr : lazyDeferredPhong)->require();
+
+        const Shader::Ptr& lightPass = g_Engine.PBR_ENBL
+            ? shaderGLightPassPbr
+            : shaderGLightPass;
+
+        lightPass->use();
+
+        if (g_Engine.PBR_ENBL) {
+            sendLightPassPbrUniforms(lightPass);
+            sendLightPbrUniforms(lightPass);
+        } else {
+            sendLightPassUniforms(lightPass);
+            sendLightUniforms(lightPass);
+        }
+
+        // local lights are accumulated by their volumes instead
+        if (g_Engine.LIGHT_VOLUMES_ENBL) {
+            lightPass->setInt("pointLightsSize", 0);
+            lightPass->setInt("spotLightsSize", 0);
+        }
 
         glClearColor(1.0f, 1.0f, 1.0f, 1.0f); // set clear color to white (not really necessary actually, since we won't be able to see behind the quad anyways)
         glClear(GL_COLOR_BUFFER_BIT);
 
         screenQuad->draw();
 
-        fboGBuffer->blitDepthTo(fboOffscr, g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+        fboGBuffer->blitDepthTo(fboOffscr, viewport.x, viewport.y);
+
+        if (g_Engine.LIGHT_VOLUMES_ENBL) {
+            Profiler::Scope scope(profiler, "Light Volumes");
+            lightVolumePass();
+        }
     } else {
         if (g_Engine.PBR_ENBL) {
+            lazyForwardPbr->require();
             shaderPbr->use();
             sendOffscrPbrUniforms(shaderPbr);
             sendLightPbrUniforms(shaderPbr);
             renderScenes(shaderPbr);
         } else {
+            lazyForwardPhong->require();
             shaderPhong->use();
             sendOffscrUniforms(shaderPhong);
             sendLightUniforms(shaderPhong);
@@ -542,232 +1063,987 @@ void backBufferPass() {
     }
 
     // Draw skybox
-    // Disable skybox influence on bloom bright buffer
-    glColorMaski(1, GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
-
-    shaderSkybox->use();
-    shaderSkybox->setInt("envMap", TEXTURE_SLOT_SKYBOX);
-    shaderSkybox->setMat4("view", glm::mat4(glm::mat3(g_View)));
-    shaderSkybox->setMat4("projection", g_Proj);
+    {
+        Profiler::Scope scope(profiler, "Skybox");
 
-    skybox->draw();
+        shaderSkybox->use();
+        shaderSkybox->setInt("envMap", TEXTURE_SLOT_SKYBOX);
+        shaderSkybox->setMat4("view", glm::mat4(glm::mat3(g_View)));
+        shaderSkybox->setMat4("projection", g_Proj);
 
-    glColorMaski(1, GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        skybox->draw();
+    }
 
     // Draw lights cube debug
     if (g_Engine.UI_ENBL)
         renderLightCubes(shaderLightCube);
 
     if (g_Engine.MSAA_ENBL)
-        fboOffscrMSAA->blitColorTo(fboOffscr, g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+        fboOffscrMSAA->blitColorTo(fboOffscr, viewport.x, viewport.y);
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    ssaoResult = nullptr;
 }
 
 
 
+void createMSAATargets() {
+    fboOffscrMSAA = FrameBuffer::New();
+    texOffscrMSAA = MultisampleTexture::New(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+
+    TextureConfig texOffscrMSAA_TConf = texOffscrMSAA->getTextureConfig();
+    texOffscrMSAA_TConf.msaa_multiplier = g_Engine.MSAA_MULTIPLIER;
+    texOffscrMSAA->setTextureConfig(texOffscrMSAA_TConf);
+    // the sample count has to match the renderbuffer
+    texOffscrMSAA->resize(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+    rboOffscrMSAA = RenderBuffer::New(RBType::DEPTH_STENCIL_MULTISAMPLE, g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+
+    fboOffscrMSAA->attachTexture(GL_COLOR_ATTACHMENT0, texOffscrMSAA);
+    fboOffscrMSAA->attachRenderBuffer(GL_DEPTH_STENCIL_ATTACHMENT, rboOffscrMSAA);
+
+    fboOffscrMSAA->bind();
+
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::FRAMEBUFFER:: MSAA Framebuffer is not complete!" <<
+            std::endl;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
 void setupOffscrPass() {
 
     fboOffscr = FrameBuffer::New();
 
-    TextureConfig
-        texOffscr_TConf = ColorBufferTexture::defaultConfig(),
-        texOffscrBright_TConf = ColorBufferTexture::defaultConfig();
+    TextureConfig texOffscr_TConf = ColorBufferTexture::defaultConfig();
 
-    texOffscr_TConf.hdr = texOffscrBright_TConf.hdr
-        = g_Engine.HDR_ENBL;
+    texOffscr_TConf.hdr = g_Engine.HDR_ENBL;
 
     texOffscr = ColorBufferTexture::New(
         g_Engine.RENDER_WIDTH,
         g_Engine.RENDER_HEIGHT,
         texOffscr_TConf
     );
-    texOffscrBright = ColorBufferTexture::New(
-        g_Engine.RENDER_WIDTH,
-        g_Engine.RENDER_HEIGHT,
-        texOffscrBright_TConf
-    );
 
-    rboOffscr = RenderBuffer::New(RBType::DEPTH_STENCIL, g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+    // sampled by TAA to reproject into the last frame
+    texOffscrDepth = DepthStencilBufferTexture::New(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
 
     fboOffscr->attachTexture(GL_COLOR_ATTACHMENT0, texOffscr);
-    fboOffscr->attachTexture(GL_COLOR_ATTACHMENT1, texOffscrBright);
-    fboOffscr->attachRenderBuffer(GL_DEPTH_STENCIL_ATTACHMENT, rboOffscr);
+    fboOffscr->attachTexture(GL_DEPTH_STENCIL_ATTACHMENT, texOffscrDepth);
 
     fboOffscr->bind();
-    fboOffscr->setDrawBuffers({GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1});
+    fboOffscr->setDrawBuffers({GL_COLOR_ATTACHMENT0});
 
     if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         std::cout << "ERROR::FRAMEBUFFER:: Offscr Framebuffer is not complete!" <<
             std::endl;
 
-    fboOffscrMSAA = FrameBuffer::New();
-    texOffscrMSAA = MultisampleTexture::New(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-    TextureConfig texOffscrMSAA_TConf = texOffscrMSAA->getTextureConfig();
-    texOffscrMSAA_TConf.msaa_multiplier = g_Engine.MSAA_MULTIPLIER;
-    texOffscrMSAA->setTextureConfig(texOffscrMSAA_TConf);
-    rboOffscrMSAA = RenderBuffer::New(RBType::DEPTH_STENCIL_MULTISAMPLE, g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+    lazyForwardPhong = addLazyResource("Forward Phong",
+        [] { shaderPhong = Shader::New(SPath("Phong.vert.glsl"), SPath("Phong.frag.glsl")); },
+        [] { shaderPhong = nullptr; }
+    );
+    lazyForwardPbr = addLazyResource("Forward PBR",
+        [] { shaderPbr = Shader::New(SPath("PBR.vert.glsl"), SPath("PBR.frag.glsl")); },
+        [] { shaderPbr = nullptr; }
+    );
+    lazyMSAA = addLazyResource("MSAA", createMSAATargets, [] {
+        fboOffscrMSAA = nullptr;
+        texOffscrMSAA = nullptr;
+        rboOffscrMSAA = nullptr;
+    });
+}
+
+
+void shadowPass() {
+    glViewport(0, 0, g_Engine.SHADOW_WIDTH, g_Engine.SHADOW_HEIGHT);
+
+    glEnable(GL_DEPTH_TEST); // This single line took 3hrs of my life
+
+    fboShadow->bind();
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    if (!g_Engine.SHADOW_ENBL) return;
+
+    shaderShadow->use();
+
+    float near_plane = 1.0f, far_plane = 27.5f;
+    glm::mat4 lightProj = glm::ortho(-20.0f, 20.0f, -20.0f, 20.0f, near_plane, far_plane);
+    glm::mat4 lightView = glm::lookAt(
+        -g_SunLight->getDirection(),
+        glm::vec3(0.0f),
+        glm::vec3(0.0, 1.0, 0.0)
+    );
+
+    g_LightSpaceMatrix = lightProj * lightView;
+
+
+    shaderShadow->setMat4("lightSpaceMatrix", g_LightSpaceMatrix);
+
+    // TODO: A mechanism to improve peter panning without removing 2d things
+
+    //glCullFace(GL_FRONT);
+    renderScenesDepth(shaderShadow);
+    //glCullFace(GL_BACK);
+
+    fboShadow->unbind();
+}
+
+void setupShadowPass() {
+    shaderShadow->use();
+
+    fboShadow = FrameBuffer::New();
+    fboShadow->bind();
+
+    texShadowmap = DepthBufferTexture::New(g_Engine.SHADOW_WIDTH, g_Engine.SHADOW_HEIGHT);
+    texShadowmap->setSlot(TEXTURE_SLOT_SHADOW);
+
+    fboShadow->attachTexture(GL_DEPTH_ATTACHMENT, texShadowmap);
+
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::FRAMEBUFFER:: Shadow map Framebuffer is not complete!" <<
+            std::endl;
+
+    fboShadow->unbind();
+}
+
+// Changes whenever a shadow caster moves, cached cubes are stale then
+size_t shadowCasterHash() {
+    size_t hash = g_Scenes.size();
+
+    for (const Scene::Ptr& scene : g_Scenes) {
+        for (const MeshGroup::Ptr& mesh_group : scene->getMeshGroups()) {
+            for (const Mesh::Ptr& mesh : mesh_group->getMeshes()) {
+
+                glm::mat4 scene_model = glm::translate(scene->getModelMatrix(), g_Engine.OBJECT_POS);
+                glm::mat4 model = scene_model * mesh->getModelMatrix();
+
+                const float* values = glm::value_ptr(model);
+                for (unsigned int i = 0; i < 16; i++)
+                    hash ^= std::hash<float>{}(values[i]) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+            }
+        }
+    }
+
+    return hash;
+}
+
+// Roughly how much of the screen a light's volume covers, 0 when out of view
+float screenInfluence(const glm::vec3& position, float radius) {
+    const glm::vec3 toLight = position - camera::g_Camera.Position;
+    const float distance = glm::length(toLight);
+
+    if (distance <= radius)
+        return std::numeric_limits<float>::max();
+
+    if (glm::dot(toLight, camera::g_Camera.Front) < -radius)
+        return 0.f;
+
+    return radius / distance;
+}
+
+std::vector<PointShadowCandidate> pointShadowCandidates(size_t budget) {
+    std::vector<PointShadowCandidate> candidates;
+
+    for (const Light::Ptr& light : g_Lights) {
+        if (light->getType() != LightType::PointLight) continue;
+
+        PointLight::Ptr pl = std::dynamic_pointer_cast<PointLight, Light>(light);
+
+        const float farPlane = lightVolumeRadius(pl);
+        const float influence = screenInfluence(pl->getPosition(), farPlane);
+
+        if (influence > 0.f)
+            candidates.push_back({pl.get(), farPlane, influence});
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const PointShadowCandidate& a, const PointShadowCandidate& b) {
+        return a.influence > b.influence;
+    });
+
+    if (candidates.size() > budget)
+        candidates.resize(budget);
+
+    return candidates;
+}
+
+// Assigns the cubes to the most influential point lights and redraws the
+// ones whose light or casters changed, one geometry shader pass per light
+void pointShadowPass() {
+    lazyPointShadows->require();
+
+    std::vector<PointShadowCandidate> candidates = pointShadowCandidates(pointShadowSlots.size());
+
+    for (PointShadowSlot& slot : pointShadowSlots)
+        slot.light = nullptr;
+
+    const auto matches = [](const PointShadowSlot& slot, const PointShadowCandidate& candidate) {
+        return slot.valid
+            && slot.position == candidate.light->getPosition()
+            && slot.farPlane == candidate.farPlane;
+    };
+
+    // lights keep the cube they already own, so unchanged maps are reused
+    std::vector<const PointShadowCandidate*> unplaced;
+
+    for (const PointShadowCandidate& candidate : candidates) {
+        auto slot = std::find_if(pointShadowSlots.begin(), pointShadowSlots.end(),
+            [&](const PointShadowSlot& slot) { return slot.light == nullptr && matches(slot, candidate); });
+
+        if (slot == pointShadowSlots.end())
+            unplaced.push_back(&candidate);
+        else
+            slot->light = candidate.light;
+    }
+
+    // the rest take free cubes, empty ones first so cached maps survive longer
+    for (const PointShadowCandidate* candidate : unplaced) {
+        auto slot = std::find_if(pointShadowSlots.begin(), pointShadowSlots.end(),
+            [](const PointShadowSlot& slot) { return slot.light == nullptr && !slot.valid; });
+
+        if (slot == pointShadowSlots.end())
+            slot = std::find_if(pointShadowSlots.begin(), pointShadowSlots.end(),
+                [](const PointShadowSlot& slot) { return slot.light == nullptr; });
+
+        slot->light = candidate->light;
+        slot->position = candidate->light->getPosition();
+        slot->farPlane = candidate->farPlane;
+        slot->valid = false;
+    }
+
+    pointShadowCount = candidates.size();
+    pointShadowRedraws = 0;
+
+    const size_t casterHash = shadowCasterHash();
+
+    glViewport(0, 0, texPointShadowMaps->getWidth(), texPointShadowMaps->getHeight());
+    glEnable(GL_DEPTH_TEST);
+
+    shaderPointShadow->use();
+
+    for (unsigned int i = 0; i < pointShadowSlots.size(); i++) {
+        PointShadowSlot& slot = pointShadowSlots[i];
+
+        if (slot.light == nullptr || (slot.valid && slot.casterHash == casterHash))
+            continue;
+
+        // a layered attachment would clear every cube, so clear this one face by face
+        for (unsigned int face = 0; face < 6; face++) {
+            fboPointShadow->attachTextureLayer(GL_DEPTH_ATTACHMENT, texPointShadowMaps, i * 6 + face);
+            glClear(GL_DEPTH_BUFFER_BIT);
+        }
+
+        fboPointShadow->attachLayeredTexture(GL_DEPTH_ATTACHMENT, texPointShadowMaps);
+
+        const glm::mat4 proj = glm::perspective(glm::radians(90.f), 1.f, POINT_SHADOW_NEAR, slot.farPlane);
+        const glm::mat4 toLight = glm::translate(glm::mat4(1.f), -slot.position);
+
+        for (unsigned int face = 0; face < 6; face++)
+            shaderPointShadow->setMat4("faceMatrices[" + std::to_string(face) + "]",
+                proj * captureViews[face] * toLight);
+
+        shaderPointShadow->setInt("layerBase", i * 6);
+        shaderPointShadow->setVec3("lightPos", slot.position);
+        shaderPointShadow->setFloat("farPlane", slot.farPlane);
+
+        renderScenesDepth(shaderPointShadow);
+
+        slot.valid = true;
+        slot.casterHash = casterHash;
+        pointShadowRedraws++;
+    }
+
+    fboPointShadow->unbind();
+}
+
+bool pointShadowsSupported() {
+    return g_HasCubeMapArrays;
+}
+
+ShadowStats pointShadowStats() {
+    return {pointShadowCount, pointShadowRedraws};
+}
+
+void createPointShadowPass() {
+    shaderPointShadow = Shader::New(
+        SPath("PointShadow.vert.glsl"),
+        SPath("PointShadow.frag.glsl"),
+        SPath("PointShadow.geom.glsl")
+    );
+
+    const unsigned int budget = std::clamp(g_Engine.POINT_SHADOW_BUDGET, 1u, NR_MAX_LIGHTS);
+
+    texPointShadowMaps = CubeMapArrayDepthTexture::New(g_Engine.POINT_SHADOW_RESOLUTION, budget);
+    pointShadowSlots.assign(budget, PointShadowSlot());
+
+    fboPointShadow = FrameBuffer::New();
+    fboPointShadow->attachLayeredTexture(GL_DEPTH_ATTACHMENT, texPointShadowMaps);
+
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::FRAMEBUFFER:: Point shadow Framebuffer is not complete!" <<
+            std::endl;
+
+    fboPointShadow->unbind();
+}
+
+void releasePointShadowPass() {
+    shaderPointShadow = nullptr;
+    texPointShadowMaps = nullptr;
+    fboPointShadow = nullptr;
+    pointShadowSlots.clear();
+}
+
+void resizePointShadowPass() {
+    const unsigned int budget = std::clamp(g_Engine.POINT_SHADOW_BUDGET, 1u, NR_MAX_LIGHTS);
+
+    texPointShadowMaps->resize(g_Engine.POINT_SHADOW_RESOLUTION, budget);
+    pointShadowSlots.assign(budget, PointShadowSlot());
+}
+
+void setupPointShadowPass() {
+    lazyPointShadows = addLazyResource("Point Shadows", createPointShadowPass, releasePointShadowPass);
+}
+
+// position of the n-th smallest tile when tiles are laid out in Z order
+glm::uvec2 mortonDecode(unsigned int code) {
+    glm::uvec2 position(0);
+
+    for (unsigned int bit = 0; bit < 16; bit++) {
+        position.x |= ((code >> (2 * bit)) & 1u) << bit;
+        position.y |= ((code >> (2 * bit + 1)) & 1u) << bit;
+    }
+
+    return position;
+}
+
+glm::mat4 spotLightSpace(const SpotLight::Ptr& sl, float farPlane) {
+    const glm::vec3 direction = glm::normalize(sl->getDirection());
+    const glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3(1.f, 0.f, 0.f) : glm::vec3(0.f, 1.f, 0.f);
+
+    const float fov = std::min(2.f * glm::radians(sl->getOuterCutOffDeg()) + 0.05f, glm::radians(170.f));
+
+    return glm::perspective(fov, 1.f, SPOT_SHADOW_NEAR, farPlane) *
+        glm::lookAt(sl->getPosition(), sl->getPosition() + direction, up);
+}
+
+// Sub-allocates the atlas to the visible spot lights, tile size follows screen
+// coverage and brightness. Tiles identical to last frame's keep their depth.
+void spotShadowPass() {
+    lazySpotShadows->require();
+
+    const unsigned int atlas = texSpotShadowAtlas->getWidth();
+    const unsigned int largest = atlas / 2;
+
+    std::vector<SpotShadowTile> tiles;
+    std::vector<float> importance;
+
+    for (const Light::Ptr& light : g_Lights) {
+        if (light->getType() != LightType::SpotLight) continue;
+
+        SpotLight::Ptr sl = std::dynamic_pointer_cast<SpotLight, Light>(light);
+
+        const float farPlane = lightVolumeRadius(sl);
+        const glm::vec3 color = sl->getAveragedColorClamp();
+
+        const float weight = screenInfluence(sl->getPosition(), farPlane) *
+            std::max(std::max(color.r, color.g), color.b);
+
+        if (weight <= 0.f) continue;
+
+        SpotShadowTile tile;
+        tile.light = light.get();
+        tile.farPlane = farPlane;
+        tile.lightSpace = spotLightSpace(sl, farPlane);
+        tile.size = std::bit_floor(static_cast<unsigned int>(std::min(weight, 1.f) * largest));
+        tile.size = std::clamp(tile.size, SPOT_SHADOW_MIN_TILE, largest);
+
+        tiles.push_back(tile);
+        importance.push_back(weight);
+    }
+
+    std::vector<unsigned int> order(tiles.size());
+    for (unsigned int i = 0; i < order.size(); i++)
+        order[i] = i;
+
+    std::sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) {
+        return importance[a] > importance[b];
+    });
+
+    // largest first in Z order, every power of two tile then lands aligned
+    // right after the previous one and the atlas never fragments
+    const unsigned int cells = (atlas / SPOT_SHADOW_MIN_TILE) * (atlas / SPOT_SHADOW_MIN_TILE);
+    unsigned int cursor = 0;
+    unsigned int previousSize = largest;
+
+    std::vector<SpotShadowTile> placed;
+
+    for (unsigned int index : order) {
+        SpotShadowTile& tile = tiles[index];
+
+        tile.size = std::min(tile.size, previousSize);
+
+        while (tile.size > SPOT_SHADOW_MIN_TILE &&
+            cursor + (tile.size / SPOT_SHADOW_MIN_TILE) * (tile.size / SPOT_SHADOW_MIN_TILE) > cells)
+            tile.size /= 2;
+
+        const unsigned int span = (tile.size / SPOT_SHADOW_MIN_TILE) * (tile.size / SPOT_SHADOW_MIN_TILE);
+        if (cursor + span > cells) break;
+
+        tile.offset = mortonDecode(cursor) * SPOT_SHADOW_MIN_TILE;
+        cursor += span;
+        previousSize = tile.size;
+
+        placed.push_back(tile);
+    }
+
+    spotShadowCount = placed.size();
+    spotShadowRedraws = 0;
+
+    const size_t casterHash = shadowCasterHash();
+
+    fboSpotShadow->bind();
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_SCISSOR_TEST);
+
+    shaderShadow->use();
+
+    for (SpotShadowTile& tile : placed) {
+        const bool cached = std::any_of(spotShadowTiles.begin(), spotShadowTiles.end(),
+            [&](const SpotShadowTile& last) {
+                return last.light == tile.light
+                    && last.offset == tile.offset
+                    && last.size == tile.size
+                    && last.lightSpace == tile.lightSpace
+                    && last.casterHash == casterHash;
+            });
+
+        tile.casterHash = casterHash;
+
+        if (cached) continue;
+
+        glViewport(tile.offset.x, tile.offset.y, tile.size, tile.size);
+        glScissor(tile.offset.x, tile.offset.y, tile.size, tile.size);
+        glClear(GL_DEPTH_BUFFER_BIT);
+
+        shaderShadow->setMat4("lightSpaceMatrix", tile.lightSpace);
+        renderScenesDepth(shaderShadow);
+
+        spotShadowRedraws++;
+    }
+
+    glDisable(GL_SCISSOR_TEST);
+
+    fboSpotShadow->unbind();
+
+    spotShadowTiles = std::move(placed);
+}
+
+ShadowStats spotShadowStats() {
+    return {spotShadowCount, spotShadowRedraws};
+}
+
+void createSpotShadowPass() {
+    texSpotShadowAtlas = DepthBufferTexture::New(g_Engine.SPOT_SHADOW_ATLAS_SIZE, g_Engine.SPOT_SHADOW_ATLAS_SIZE);
+
+    fboSpotShadow = FrameBuffer::New();
+    fboSpotShadow->attachTexture(GL_DEPTH_ATTACHMENT, texSpotShadowAtlas);
+
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::FRAMEBUFFER:: Spot shadow atlas Framebuffer is not complete!" <<
+            std::endl;
+
+    fboSpotShadow->unbind();
+
+    spotShadowTiles.clear();
+}
+
+void releaseSpotShadowPass() {
+    texSpotShadowAtlas = nullptr;
+    fboSpotShadow = nullptr;
+    spotShadowTiles.clear();
+}
+
+void setupSpotShadowPass() {
+    lazySpotShadows = addLazyResource("Spot Shadows", createSpotShadowPass, releaseSpotShadowPass);
+}
+
+// mips[0] is the largest level and ends up holding the result
+void bloomPass(const std::vector<Texture::Ptr>& mips) {
+
+    lazyBloom->require();
+
+    const unsigned int levels = mips.size();
+
+    glDisable(GL_DEPTH_TEST);
+
+    fboTransient->bind();
+
+    // Downsample: the scene into mip 0, then each mip into the next, smaller one
+    shaderBloomDownsample->use();
+    shaderBloomDownsample->setInt("srcTexture", 0);
+    shaderBloomDownsample->setFloat("threshold", g_Engine.BLOOM_THRESHOLD);
+
+    for (unsigned int i = 0; i < levels; i++) {
+        const Texture::Ptr& src = i == 0 ? texOffscr : mips[i - 1];
+        const Texture::Ptr& dst = mips[i];
+
+        shaderBloomDownsample->setBool("firstPass", i == 0);
+        // mip 0 spans the whole chain, only the scene is drawn scaled
+        shaderBloomDownsample->setVec2("uvScale", i == 0 ? viewportUvScale() : glm::vec2(1.f));
+
+        fboTransient->attachTexture(GL_COLOR_ATTACHMENT0, dst);
+        glViewport(0, 0, dst->getWidth(), dst->getHeight());
+
+        src->setSlot(0);
+        src->bind();
+
+        screenQuad->draw();
+    }
+
+    // Upsample: blend each mip back into the next larger one
+    shaderBloomUpsample->use();
+    shaderBloomUpsample->setInt("srcTexture", 0);
+    shaderBloomUpsample->setFloat("filterRadius", 0.005f);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+
+    for (unsigned int i = levels - 1; i > 0; i--) {
+        const Texture::Ptr& src = mips[i];
+        const Texture::Ptr& dst = mips[i - 1];
+
+        fboTransient->attachTexture(GL_COLOR_ATTACHMENT0, dst);
+        glViewport(0, 0, dst->getWidth(), dst->getHeight());
+
+        src->setSlot(0);
+        src->bind();
+
+        screenQuad->draw();
+    }
+
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+
+    fboTransient->unbind();
+}
+
+void setupBloomPass() {
+    lazyBloom = addLazyResource("Bloom", [] {
+        shaderBloomDownsample = Shader::New(SPath("Bloom.vert.glsl"), SPath("BloomDownsample.frag.glsl"));
+        shaderBloomUpsample = Shader::New(SPath("Bloom.vert.glsl"), SPath("BloomUpsample.frag.glsl"));
+    }, [] {
+        shaderBloomDownsample = nullptr;
+        shaderBloomUpsample = nullptr;
+    });
+}
+
+void exposurePass() {
+    lazyExposure->require();
+
+    double now = glfwGetTime();
+    float dt = g_FixedTimestep > 0.f ? g_FixedTimestep : now - lastExposureTime;
+    lastExposureTime = now;
+
+    // frame rate independent smoothing, jump straight to the target when (re)enabled
+    float adaptRate = resetAdaptation
+        ? 1.f
+        : 1.f - std::exp(-dt * g_Engine.AUTO_EXPOSURE_SPEED);
+    resetAdaptation = false;
+
+    const ColorBufferTexture::Ptr& previous = texAdaptedLuminance[adaptedLuminanceIndex];
+    adaptedLuminanceIndex ^= 1;
+    const ColorBufferTexture::Ptr& current = texAdaptedLuminance[adaptedLuminanceIndex];
+
+    const float logLumRange = EXPOSURE_MAX_LOG_LUM - EXPOSURE_MIN_LOG_LUM;
+
+    texOffscr->setSlot(0);
+    previous->setSlot(1);
+
+    const glm::uvec2 viewport = scaledViewport(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+
+    if (g_HasComputeShaders) {
+        shaderLuminanceHistogram->use();
+        shaderLuminanceHistogram->setInt("hdrTexture", 0);
+        shaderLuminanceHistogram->setFloat("minLogLum", EXPOSURE_MIN_LOG_LUM);
+        shaderLuminanceHistogram->setFloat("invLogLumRange", 1.f / logLumRange);
+        shaderLuminanceHistogram->setIVec2("viewportSize", glm::ivec2(viewport));
+
+        texOffscr->bind();
+        glBindImageTexture(0, texLuminanceHistogram->getID(), 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+
+        shaderLuminanceHistogram->dispatch(
+            (viewport.x + 15) / 16,
+            (viewport.y + 15) / 16
+        );
+
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+        shaderLuminanceAverage->use();
+        shaderLuminanceAverage->setInt("previousLuminance", 1);
+        shaderLuminanceAverage->setFloat("minLogLum", EXPOSURE_MIN_LOG_LUM);
+        shaderLuminanceAverage->setFloat("logLumRange", logLumRange);
+        shaderLuminanceAverage->setFloat("adaptRate", adaptRate);
+        shaderLuminanceAverage->setFloat("pixelCount", float(viewport.x * viewport.y));
+
+        previous->bind();
+        glBindImageTexture(1, current->getID(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+        shaderLuminanceAverage->dispatch(1);
+
+        // postprocess samples the result as a regular texture
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        return;
+    }
+
+    // 3.3 fallback: geometric mean through the mip chain instead of a histogram
+    glDisable(GL_DEPTH_TEST);
+
+    fboLuminance->attachTexture(GL_COLOR_ATTACHMENT0, texLogLuminance);
+    glViewport(0, 0, LOG_LUMINANCE_SIZE, LOG_LUMINANCE_SIZE);
+
+    shaderLogLuminance->use();
+    shaderLogLuminance->setInt("hdrTexture", 0);
+    shaderLogLuminance->setFloat("minLogLum", EXPOSURE_MIN_LOG_LUM);
+    shaderLogLuminance->setFloat("maxLogLum", EXPOSURE_MAX_LOG_LUM);
+    shaderLogLuminance->setVec2("uvScale", viewportUvScale());
+
+    texOffscr->bind();
+    screenQuad->draw();
+
+    texLogLuminance->setSlot(0);
+    texLogLuminance->bind();
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    fboLuminance->attachTexture(GL_COLOR_ATTACHMENT0, current);
+    glViewport(0, 0, 1, 1);
+
+    shaderLuminanceAdapt->use();
+    shaderLuminanceAdapt->setInt("logLuminance", 0);
+    shaderLuminanceAdapt->setInt("previousLuminance", 1);
+    shaderLuminanceAdapt->setFloat("lastLevel", std::log2(float(LOG_LUMINANCE_SIZE)));
+    shaderLuminanceAdapt->setFloat("adaptRate", adaptRate);
+
+    previous->bind();
+    screenQuad->draw();
+
+    fboLuminance->unbind();
+    glEnable(GL_DEPTH_TEST);
+}
+
+void createExposurePass() {
+
+    if (g_HasComputeShaders) {
+        shaderLuminanceHistogram = Shader::New(SPath("LuminanceHistogram.comp.glsl"));
+        shaderLuminanceAverage = Shader::New(SPath("LuminanceAverage.comp.glsl"));
+    } else {
+        shaderLogLuminance = Shader::New(
+            SPath("ScreenPostprocess.vert.glsl"),
+            SPath("LogLuminance.frag.glsl")
+        );
+        shaderLuminanceAdapt = Shader::New(
+            SPath("ScreenPostprocess.vert.glsl"),
+            SPath("LuminanceAdapt.frag.glsl")
+        );
+    }
+
+    resetAdaptation = true;
+
+    TextureConfig texAdapted_TConf = ColorBufferTexture::defaultConfig();
+    texAdapted_TConf.internal_format = GL_R32F;
+    texAdapted_TConf.data_format = GL_RED;
+    texAdapted_TConf.data_type = GL_FLOAT;
+    texAdapted_TConf.min_filter = texAdapted_TConf.mag_filter = GL_NEAREST;
+
+    const float initialLuminance = 1.f;
+
+    for (ColorBufferTexture::Ptr& adapted : texAdaptedLuminance) {
+        adapted = ColorBufferTexture::New(1, 1, texAdapted_TConf);
+        adapted->bind();
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 1, 1, GL_RED, GL_FLOAT, &initialLuminance);
+    }
+
+    if (g_HasComputeShaders) {
+        TextureConfig texHistogram_TConf = texAdapted_TConf;
+        texHistogram_TConf.internal_format = GL_R32UI;
+        texHistogram_TConf.data_format = GL_RED_INTEGER;
+        texHistogram_TConf.data_type = GL_UNSIGNED_INT;
+
+        texLuminanceHistogram = ColorBufferTexture::New(HISTOGRAM_BINS, 1, texHistogram_TConf);
+
+        // the average pass clears it after that
+        const std::vector<GLuint> zeros(HISTOGRAM_BINS, 0);
+        texLuminanceHistogram->bind();
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, HISTOGRAM_BINS, 1, GL_RED_INTEGER, GL_UNSIGNED_INT, zeros.data());
+        return;
+    }
+
+    TextureConfig texLogLuminance_TConf = texAdapted_TConf;
+    texLogLuminance_TConf.internal_format = GL_R16F;
+    texLogLuminance_TConf.min_filter = GL_NEAREST_MIPMAP_NEAREST;
+
+    texLogLuminance = ColorBufferTexture::New(LOG_LUMINANCE_SIZE, LOG_LUMINANCE_SIZE, texLogLuminance_TConf);
+    texLogLuminance->bind();
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    fboLuminance = FrameBuffer::New();
+    fboLuminance->attachTexture(GL_COLOR_ATTACHMENT0, texLogLuminance);
+    fboLuminance->bind();
+
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::FRAMEBUFFER:: Luminance Framebuffer is not complete!" <<
+            std::endl;
+
+    fboLuminance->unbind();
+}
+
+void releaseExposurePass() {
+    shaderLuminanceHistogram = shaderLuminanceAverage = nullptr;
+    shaderLogLuminance = shaderLuminanceAdapt = nullptr;
+
+    texAdaptedLuminance = {};
+    texLuminanceHistogram = nullptr;
+    texLogLuminance = nullptr;
+    fboLuminance = nullptr;
+}
+
+void setupExposurePass() {
+    lazyExposure = addLazyResource("Auto Exposure", createExposurePass, releaseExposurePass);
+}
+
+float halton(unsigned int index, unsigned int base) {
+    float f = 1.f, result = 0.f;
+
+    while (index > 0) {
+        f /= base;
+        result += f * (index % base);
+        index /= base;
+    }
+
+    return result;
+}
 
-    fboOffscrMSAA->attachTexture(GL_COLOR_ATTACHMENT0, texOffscrMSAA);
-    fboOffscrMSAA->attachRenderBuffer(GL_DEPTH_STENCIL_ATTACHMENT, rboOffscrMSAA);
+// The AA passes only differ in how many targets they need, the frame graph
+// hands each of them its own
+void beginAAPass(const Texture::Ptr& target) {
+    const glm::uvec2 viewport = scaledViewport(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
 
-    fboOffscrMSAA->bind();
+    glDisable(GL_DEPTH_TEST);
+    glViewport(0, 0, viewport.x, viewport.y);
 
-    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cout << "ERROR::FRAMEBUFFER:: MSAA Framebuffer is not complete!" <<
-            std::endl;
+    fboTransient->attachTexture(GL_COLOR_ATTACHMENT0, target);
 
+    texOffscr->setSlot(0);
+    texOffscr->bind();
+}
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+void endAAPass() {
+    fboTransient->unbind();
+    glEnable(GL_DEPTH_TEST);
 }
 
+void fxaaPass(const Texture::Ptr& target) {
+    lazyFXAA->require();
 
-void shadowPass() {
-    glViewport(0, 0, g_Engine.SHADOW_WIDTH, g_Engine.SHADOW_HEIGHT);
+    beginAAPass(target);
 
-    glEnable(GL_DEPTH_TEST); // This single line took 3hrs of my life
+    shaderFXAA->use();
+    shaderFXAA->setInt("screenTexture", 0);
+    shaderFXAA->setVec2("uvScale", viewportUvScale());
 
-    fboShadow->bind();
-    glClear(GL_DEPTH_BUFFER_BIT);
+    screenQuad->draw();
 
-    bool shadowMapping = g_Engine.SHADOW_ENBL;
-    shaderPhong->setBool("hasShadow", shadowMapping);
-    shaderGLightPass->setBool("hasShadow", shadowMapping);
+    endAAPass();
+}
 
-    if (!shadowMapping) return;
+// 1st of three: luma edges, untouched pixels stay cleared
+void smaaEdgesPass(const Texture::Ptr& edges) {
+    lazySMAA->require();
 
-    shaderShadow->use();
+    beginAAPass(edges);
 
-    float near_plane = 1.0f, far_plane = 27.5f;
-    glm::mat4 lightProj = glm::ortho(-20.0f, 20.0f, -20.0f, 20.0f, near_plane, far_plane);
-    glm::mat4 lightView = glm::lookAt(
-        -g_SunLight->getDirection(),
-        glm::vec3(0.0f),
-        glm::vec3(0.0, 1.0, 0.0)
-    );
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
 
-    g_LightSpaceMatrix = lightProj * lightView;
+    shaderSMAAEdges->use();
+    shaderSMAAEdges->setInt("screenTexture", 0);
 
+    screenQuad->draw();
 
-    shaderShadow->setMat4("lightSpaceMatrix", g_LightSpaceMatrix);
+    endAAPass();
+}
 
-    // TODO: A mechanism to improve peter panning without removing 2d things
+// 2nd: coverage of each pixel along the edge runs
+void smaaWeightsPass(const Texture::Ptr& edges, const Texture::Ptr& weights) {
+    beginAAPass(weights);
 
-    //glCullFace(GL_FRONT);
-    renderScenesDepth();
-    //glCullFace(GL_BACK);
+    glClear(GL_COLOR_BUFFER_BIT);
 
-    fboShadow->unbind();
-}
+    shaderSMAAWeights->use();
+    shaderSMAAWeights->setInt("edgesTexture", 1);
 
-void setupShadowPass() {
-    shaderShadow->use();
+    edges->setSlot(1);
+    edges->bind();
 
-    fboShadow = FrameBuffer::New();
-    fboShadow->bind();
+    screenQuad->draw();
 
-    texShadowmap = DepthBufferTexture::New(g_Engine.SHADOW_WIDTH, g_Engine.SHADOW_HEIGHT);
-    texShadowmap->setSlot(TEXTURE_SLOT_SHADOW);
+    endAAPass();
+}
 
-    fboShadow->attachTexture(GL_DEPTH_ATTACHMENT, texShadowmap);
+// 3rd: blend every pixel with its neighbors by that coverage
+void smaaBlendPass(const Texture::Ptr& weights, const Texture::Ptr& target) {
+    beginAAPass(target);
 
-    glDrawBuffer(GL_NONE);
-    glReadBuffer(GL_NONE);
+    shaderSMAABlend->use();
+    shaderSMAABlend->setInt("screenTexture", 0);
+    shaderSMAABlend->setInt("weightsTexture", 2);
 
-    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cout << "ERROR::FRAMEBUFFER:: Shadow map Framebuffer is not complete!" <<
-            std::endl;
+    weights->setSlot(2);
+    weights->bind();
 
-    fboShadow->unbind();
-}
+    screenQuad->draw();
 
-void bloomPass() {
+    endAAPass();
+}
 
-    if (!g_Engine.BLOOM_ENBL) return;
+// Resolves into the history texture the next frame reads
+void taaPass(const Texture::Ptr& history, const Texture::Ptr& target) {
+    beginAAPass(target);
 
-    shaderBlur->use();
+    const glm::vec2 uvScale = viewportUvScale();
 
-    bool horizontal = true;
-    unsigned int amount = 10;
-    for (unsigned int i = 0; i < amount; i++)
-    {
-        if (horizontal)
-            fboBlurHoriz->bind();
-        else
-            fboBlurVert->bind();
+    shaderTAA->use();
+    shaderTAA->setInt("screenTexture", 0);
+    shaderTAA->setInt("historyTexture", 1);
+    shaderTAA->setInt("depthTexture", 2);
 
-        shaderBlur->setInt("horizontal", horizontal);
+    shaderTAA->setMat4("invViewProj", glm::inverse(g_Proj * g_View));
+    shaderTAA->setMat4("prevViewProj", prevViewProj);
+    shaderTAA->setVec2("jitter", taaJitter);
+    shaderTAA->setBool("resetHistory", resetTAAHistory);
+    shaderTAA->setVec2("uvScale", uvScale);
+    shaderTAA->setVec2("prevUvScale", prevUvScale);
 
-        if (i == 0) // first iteration
-            texOffscrBright->bind();
-        else if (horizontal)
-            texBlurHoriz->bind();
-        else
-            texBlurVert->bind();
+    history->setSlot(1);
+    history->bind();
 
-        screenQuad->draw();
+    texOffscrDepth->setSlot(2);
+    texOffscrDepth->bind();
 
-        horizontal = !horizontal;
-    }
-}
+    screenQuad->draw();
 
-void setupBloomPass() {
+    taaHistoryIndex ^= 1;
+    resetTAAHistory = false;
+    prevUvScale = uvScale;
 
-    fboBlurHoriz = FrameBuffer::New();
-    texBlurHoriz = ColorBufferTexture::New(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+    endAAPass();
+}
 
-    fboBlurHoriz->attachTexture(GL_COLOR_ATTACHMENT0, texBlurHoriz);
-    fboBlurHoriz->bind();
+void resizeAAPass() {
+    for (const ColorBufferTexture::Ptr& history : texTAAHistory)
+        history->resize(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
 
-    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cout << "ERROR::FRAMEBUFFER:: Shadow map Framebuffer is not complete!" <<
-            std::endl;
+    resetTAAHistory = true;
+}
 
-    fboBlurHoriz->unbind();
+void createTAAPass() {
+    shaderTAA = Shader::New(
+        SPath("ScreenPostprocess.vert.glsl"),
+        SPath("TAA.frag.glsl")
+    );
 
-    fboBlurVert = FrameBuffer::New();
-    texBlurVert = ColorBufferTexture::New(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+    TextureConfig texTAA_TConf = ColorBufferTexture::defaultConfig();
+    texTAA_TConf.internal_format = GL_RGBA16F;
+    texTAA_TConf.data_format = GL_RGBA;
+    texTAA_TConf.data_type = GL_FLOAT;
 
-    fboBlurVert->attachTexture(GL_COLOR_ATTACHMENT0, texBlurVert);
-    fboBlurVert->bind();
+    // persists across frames, so it lives outside the frame graph pool
+    for (ColorBufferTexture::Ptr& history : texTAAHistory)
+        history = ColorBufferTexture::New(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT, texTAA_TConf);
 
-    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cout << "ERROR::FRAMEBUFFER:: Shadow map Framebuffer is not complete!" <<
-            std::endl;
+    resetTAAHistory = true;
+}
 
-    fboBlurVert->unbind();
+void setupAAPass() {
+    lazyFXAA = addLazyResource("FXAA",
+        [] { shaderFXAA = Shader::New(SPath("ScreenPostprocess.vert.glsl"), SPath("FXAA.frag.glsl")); },
+        [] { shaderFXAA = nullptr; }
+    );
+    lazySMAA = addLazyResource("SMAA", [] {
+        shaderSMAAEdges = Shader::New(SPath("ScreenPostprocess.vert.glsl"), SPath("SMAAEdges.frag.glsl"));
+        shaderSMAAWeights = Shader::New(SPath("ScreenPostprocess.vert.glsl"), SPath("SMAAWeights.frag.glsl"));
+        shaderSMAABlend = Shader::New(SPath("ScreenPostprocess.vert.glsl"), SPath("SMAABlend.frag.glsl"));
+    }, [] {
+        shaderSMAAEdges = shaderSMAAWeights = shaderSMAABlend = nullptr;
+    });
+    lazyTAA = addLazyResource("TAA", createTAAPass, [] {
+        shaderTAA = nullptr;
+        texTAAHistory = {};
+    });
 }
 
-void sendPostprocessUniforms() {
+void sendPostprocessUniforms(const Texture::Ptr& screen, const Texture::Ptr& bloom) {
     shaderPostProcess->setInt("screenTexture", TEXTURE_SLOT_SCREEN);
     shaderPostProcess->setInt("bloomTexture", TEXTURE_SLOT_BLOOM);
 
     shaderPostProcess->setBool("gamma", true);
     shaderPostProcess->setBool("hdr", g_Engine.HDR_ENBL);
-    shaderPostProcess->setBool("bloom", g_Engine.BLOOM_ENBL);
+    shaderPostProcess->setBool("bloom", bloom != nullptr);
+    shaderPostProcess->setFloat("bloomStrength", g_Engine.BLOOM_STRENGTH);
     shaderPostProcess->setFloat("exposure", g_Engine.HDR_EXPOSURE);
+    // the exposure pass may not have run yet, or its resources are gone
+    const bool autoExposure = g_Engine.AUTO_EXPOSURE_ENBL && lazyExposure->isLive();
+    shaderPostProcess->setBool("autoExposure", autoExposure);
+    shaderPostProcess->setFloat("exposureKey", g_Engine.AUTO_EXPOSURE_KEY);
+    shaderPostProcess->setInt("adaptedLuminance", TEXTURE_SLOT_EXPOSURE);
 
     shaderPostProcess->setBool("sharpen", g_Engine.SHARPNESS_ENBL);
     shaderPostProcess->setFloat("sharpness", g_Engine.SHARPNESS_AMOUNT);
     shaderPostProcess->setBool("blur", g_Engine.BLUR_ENBL);
     shaderPostProcess->setBool("grayscale", g_Engine.GRAYSCALE_ENBL);
 
-    texOffscr->setSlot(TEXTURE_SLOT_SCREEN);
-    texOffscr->bind();
+    // bloom and exposure already cover the whole target, only the scene is upscaled
+    const glm::vec2 sourceScale = viewportUvScale();
+    shaderPostProcess->setVec2("sourceScale", sourceScale);
+    shaderPostProcess->setBool("upscale", sourceScale != glm::vec2(1.f));
+    shaderPostProcess->setFloat("upscaleSharpness", g_Engine.DYNAMIC_RES_SHARPNESS);
+
+    screen->setSlot(TEXTURE_SLOT_SCREEN);
+    screen->bind();
+
+    if (bloom != nullptr) {
+        bloom->setSlot(TEXTURE_SLOT_BLOOM);
+        bloom->bind();
+    }
 
-    texBlurVert->setSlot(TEXTURE_SLOT_BLOOM);
-    texBlurVert->bind();
+    if (autoExposure) {
+        const ColorBufferTexture::Ptr& adapted = texAdaptedLuminance[adaptedLuminanceIndex];
+        adapted->setSlot(TEXTURE_SLOT_EXPOSURE);
+        adapted->bind();
+    }
 }
 
-void postprocessPass() {
+void postprocessPass(const Texture::Ptr& screen, const Texture::Ptr& bloom) {
     glViewport(0, 0, g_Engine.SCREEN_WIDTH, g_Engine.SCREEN_HEIGHT);
 
     shaderPostProcess->use();
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (fboOutput)
+        fboOutput->bind();
+    else
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-    sendPostprocessUniforms();
+    sendPostprocessUniforms(screen, bloom);
 
     glDisable(GL_DEPTH_TEST);
     glClearColor(1.0f, 1.0f, 1.0f, 1.0f); // set clear color to white (not really necessary actually, since we won't be able to see behind the quad anyways)
@@ -781,22 +2057,81 @@ void setupPostprocessPass() {
 
     if (screenQuad == nullptr)
         screenQuad = Quad::New();
+
+    // surfaceless contexts have no default framebuffer to present to
+    if (g_Headless) {
+        TextureConfig tconf = ColorBufferTexture::defaultConfig();
+        tconf.internal_format = GL_RGBA8;
+        tconf.data_format = GL_RGBA;
+        tconf.data_type = GL_UNSIGNED_BYTE;
+        tconf.hdr = false;
+
+        texOutput = ColorBufferTexture::New(g_Engine.SCREEN_WIDTH, g_Engine.SCREEN_HEIGHT, tconf);
+
+        fboOutput = FrameBuffer::New();
+        fboOutput->bind();
+        fboOutput->attachTexture(GL_COLOR_ATTACHMENT0, texOutput);
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::FRAMEBUFFER:: Output Framebuffer is not complete!" << std::endl;
+
+        fboOutput->unbind();
+    }
+}
+
+std::vector<uint8_t> readFrame() {
+    const unsigned int width = g_Engine.SCREEN_WIDTH, height = g_Engine.SCREEN_HEIGHT;
+
+    if (fboOutput)
+        fboOutput->bind();
+    else
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // GL rows start at the bottom
+    std::vector<uint8_t> pixels(width * height * 4), flipped(pixels.size());
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    for (unsigned int y = 0; y < height; y++)
+        std::copy_n(pixels.begin() + (height - 1 - y) * width * 4, width * 4, flipped.begin() + y * width * 4);
+
+    return flipped;
+}
+
+bool saveFrame(const std::string& path) {
+    return png::write(path, g_Engine.SCREEN_WIDTH, g_Engine.SCREEN_HEIGHT, 4, readFrame());
 }
 
 void geometryPass() {
+    lazyGBuffer->require();
+
     fboGBuffer->bind();
     shaderGBuffer->use();
 
-    glViewport(0, 0, g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+    const glm::uvec2 viewport = scaledViewport(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+    glViewport(0, 0, viewport.x, viewport.y);
     glEnable(GL_DEPTH_TEST);
 
+    // forward shading only needs depth and normals for SSAO, albedo and material are never written
+    if (!g_Engine.DEFERRED_SHADING)
+        fboGBuffer->setDrawBuffers({GL_COLOR_ATTACHMENT0, GL_NONE, GL_NONE});
+
     glClearColor(0.0, 0.0, 0.0, 1.0);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    // the sRGB albedo attachment only encodes with this on, the others ignore it
+    glEnable(GL_FRAMEBUFFER_SRGB);
+
     // Draw Scene
-    sendOffscrUniforms(shaderGBuffer);
+    sendGBufferUniforms(shaderGBuffer);
     renderScenes(shaderGBuffer);
 
+    glDisable(GL_FRAMEBUFFER_SRGB);
+
+    if (!g_Engine.DEFERRED_SHADING)
+        fboGBuffer->setDrawBuffers({GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2});
+
     // Draw skybox
 
     shaderSkybox->use();
@@ -808,35 +2143,108 @@ void geometryPass() {
 }
 
 void setupGeometryPass() {
-    fboGBuffer = GBuffer::New(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+    lazyGBuffer = addLazyResource("G-Buffer", [] {
+        shaderGBuffer = Shader::New(SPath("GBuffer.vert.glsl"), SPath("GBuffer.frag.glsl"));
+        fboGBuffer = GBuffer::New(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+    }, [] {
+        shaderGBuffer = nullptr;
+        fboGBuffer = nullptr;
+    });
+    lazyDeferredPhong = addLazyResource("Deferred Phong",
+        [] { shaderGLightPass = Shader::New(SPath("GLightPass.vert.glsl"), SPath("Phong.frag.glsl")); },
+        [] { shaderGLightPass = nullptr; }
+    );
+    lazyDeferredPbr = addLazyResource("Deferred PBR",
+        [] { shaderGLightPassPbr = Shader::New(SPath("GLightPassPBR.vert.glsl"), SPath("PBR.frag.glsl")); },
+        [] { shaderGLightPassPbr = nullptr; }
+    );
+    lazyLightVolumes = addLazyResource("Light Volumes", [] {
+        shaderLightVolume = Shader::New(SPath("LightVolume.vert.glsl"), SPath("LightVolume.frag.glsl"));
+        shaderLightVolumeStencil = Shader::New(SPath("LightVolume.vert.glsl"), SPath("ShadowMap.frag.glsl"));
+        lightVolumeSphere = Sphere::New(LIGHT_VOLUME_SEGMENTS, LIGHT_VOLUME_SEGMENTS);
+    }, [] {
+        shaderLightVolume = shaderLightVolumeStencil = nullptr;
+        lightVolumeSphere = nullptr;
+    });
 }
 
-void setupSSAOPass() {
-    fboSSAO = FrameBuffer::New();
-    texSSAO = MonoBufferTexture::New(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+// Occlusion at reduced resolution, expects the G-Buffer of this frame
+void ssaoPass(const Texture::Ptr& target) {
+
+    lazySSAO->require();
+
+    glDisable(GL_DEPTH_TEST);
+
+    fboGBuffer->bindTextures();
+
+    fboTransient->attachTexture(GL_COLOR_ATTACHMENT0, target);
+
+    const glm::uvec2 viewport = scaledViewport(target->getWidth(), target->getHeight());
+    glViewport(0, 0, viewport.x, viewport.y);
+
+    shaderSSAO->use();
+    shaderSSAO->setInt("gDepth", TEXTURE_SLOT_DEFERRED_DEPTH);
+    shaderSSAO->setInt("gNormal", TEXTURE_SLOT_DEFERRED_NORMAL);
+    shaderSSAO->setInt("noiseTexture", 0);
+
+    shaderSSAO->setMat4("view", g_View);
+    shaderSSAO->setMat4("projection", g_Proj);
+    shaderSSAO->setMat4("invProjection", glm::inverse(g_Proj));
+    shaderSSAO->setVec2("uvScale", viewportUvScale());
+
+    shaderSSAO->setInt("kernelSize", ssaoKernel.size());
+    shaderSSAO->setFloat("radius", g_Engine.SSAO_RADIUS);
+    shaderSSAO->setVec2("noiseScale", target->getWidth() / 4.f, target->getHeight() / 4.f);
+
+    texSSAONoise->setSlot(0);
+    texSSAONoise->bind();
+
+    screenQuad->draw();
+
+    fboTransient->unbind();
+    glEnable(GL_DEPTH_TEST);
+}
+
+// Depth aware blur and upsample back to the render resolution
+void ssaoBlurPass(const Texture::Ptr& source, const Texture::Ptr& target) {
+
+    glDisable(GL_DEPTH_TEST);
+
+    fboGBuffer->bindTextures();
+
+    fboTransient->attachTexture(GL_COLOR_ATTACHMENT0, target);
+
+    const glm::uvec2 viewport = scaledViewport(target->getWidth(), target->getHeight());
+    glViewport(0, 0, viewport.x, viewport.y);
 
-    fboSSAO->attachTexture(GL_COLOR_ATTACHMENT0, texSSAO);
-    fboSSAO->bind();
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cout << "SSAO Framebuffer not complete!" << std::endl;
+    shaderSSAOBlur->use();
+    shaderSSAOBlur->setInt("ssaoInput", 0);
+    shaderSSAOBlur->setInt("gDepth", TEXTURE_SLOT_DEFERRED_DEPTH);
+    shaderSSAOBlur->setMat4("invProjection", glm::inverse(g_Proj));
+    shaderSSAOBlur->setVec2("uvScale", viewportUvScale());
 
-    fboSSAOBlur = FrameBuffer::New();
-    texSSAOBlur = MonoBufferTexture::New(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+    source->setSlot(0);
+    source->bind();
 
-    fboSSAOBlur->attachTexture(GL_COLOR_ATTACHMENT0, texSSAOBlur);
-    fboSSAOBlur->bind();
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cout << "SSAO Blur Framebuffer not complete!" << std::endl;
+    screenQuad->draw();
+
+    fboTransient->unbind();
+    glEnable(GL_DEPTH_TEST);
+}
+
+void generateSSAOKernel(unsigned int size) {
+    size = std::clamp(size, 1u, SSAO_MAX_KERNEL_SIZE);
 
     std::uniform_real_distribution<GLfloat> randomFloats(0.0, 1.0); // generates random floats between 0.0 and 1.0
     std::default_random_engine generator;
-    std::vector<glm::vec3> ssaoKernel;
-    for (unsigned int i = 0; i < 64; ++i)
+
+    ssaoKernel.clear();
+    for (unsigned int i = 0; i < size; ++i)
     {
         glm::vec3 sample(randomFloats(generator) * 2.0 - 1.0, randomFloats(generator) * 2.0 - 1.0, randomFloats(generator));
         sample = glm::normalize(sample);
         sample *= randomFloats(generator);
-        float scale = float(i) / 64.0f;
+        float scale = float(i) / float(size);
 
         // scale samples s.t. they're more aligned to center of kernel
         scale = .1f + (scale * scale) * .9f;
@@ -844,6 +2252,27 @@ void setupSSAOPass() {
         ssaoKernel.push_back(sample);
     }
 
+    // the kernel only changes with the sample count, no need to send it every frame
+    shaderSSAO->use();
+    for (unsigned int i = 0; i < size; ++i)
+        shaderSSAO->setVec3("samples[" + std::to_string(i) + "]", ssaoKernel[i]);
+}
+
+void createSSAOPass() {
+    shaderSSAO = Shader::New(
+        SPath("ScreenPostprocess.vert.glsl"),
+        SPath("SSAO.frag.glsl")
+    );
+    shaderSSAOBlur = Shader::New(
+        SPath("ScreenPostprocess.vert.glsl"),
+        SPath("SSAOBlur.frag.glsl")
+    );
+
+    generateSSAOKernel(g_Engine.SSAO_SAMPLES);
+
+    std::uniform_real_distribution<GLfloat> randomFloats(0.0, 1.0);
+    std::default_random_engine generator;
+
     std::vector<glm::vec3> ssaoNoise;
     for (unsigned int i = 0; i < 16; i++)
     {
@@ -866,6 +2295,13 @@ void setupSSAOPass() {
     );
 }
 
+void setupSSAOPass() {
+    lazySSAO = addLazyResource("SSAO", createSSAOPass, [] {
+        shaderSSAO = shaderSSAOBlur = nullptr;
+        texSSAONoise = nullptr;
+    });
+}
+
 CubeMapBufferTexture::Ptr convertEquirectangularToCubemap(const Texture::Ptr& hdrTexture)
 {
     constexpr unsigned int ENV_MAP_WIDTH = 1024, ENV_MAP_HEIGHT = 1024;
@@ -1055,10 +2491,240 @@ ColorBufferTexture::Ptr generateBrdf()
     return texBrdf;
 }
 
+// Scales the viewport toward the target GPU frame time, cost follows the pixel count
+void updateResolutionScale() {
+
+    if (!g_Engine.DYNAMIC_RES_ENBL) {
+        g_ResolutionScale = 1.f;
+        return;
+    }
+
+    const Profiler::Section* frame = profiler->getSection(Profiler::FRAME);
+    if (!frame) return;
+
+    const float frameMs = frame->gpu.last();
+    if (frameMs <= 0.f) return;
+
+    const float ratio = g_Engine.DYNAMIC_RES_TARGET_MS / frameMs;
+    if (std::abs(ratio - 1.f) < DYNAMIC_RES_DEADBAND) return;
+
+    const float desired = g_ResolutionScale * std::sqrt(ratio);
+
+    g_ResolutionScale = std::clamp(
+        glm::mix(g_ResolutionScale, desired, DYNAMIC_RES_DAMPING),
+        std::min(g_Engine.DYNAMIC_RES_MIN_SCALE, 1.f),
+        1.f
+    );
+}
+
+FrameGraph::TextureDesc transientDesc(
+    unsigned int width,
+    unsigned int height,
+    GLint internalFormat,
+    GLint dataFormat,
+    GLenum dataType,
+    GLint filter = GL_LINEAR
+) {
+    FrameGraph::TextureDesc desc;
+    desc.width = std::max(width, 1u);
+    desc.height = std::max(height, 1u);
+    desc.config.internal_format = internalFormat;
+    desc.config.data_format = dataFormat;
+    desc.config.data_type = dataType;
+    desc.config.min_filter = desc.config.mag_filter = filter;
+    return desc;
+}
+
+// Declares this frame's passes. Settings only decide who reads what,
+// compile() drops the passes whose results end up unused.
+void buildFrameGraph() {
+    using Resource = FrameGraph::Resource;
+
+    const unsigned int width = g_Engine.RENDER_WIDTH, height = g_Engine.RENDER_HEIGHT;
+
+    frameGraph->reset();
+
+    const Resource shadowMap = frameGraph->importTexture("Shadow Map", texShadowmap);
+    const Resource gBuffer = frameGraph->importTexture("G-Buffer");
+    // color and depth, TAA reprojects with the latter
+    const Resource offscr = frameGraph->importTexture("Offscreen", texOffscr);
+    const Resource adaptedLuminance = frameGraph->importTexture("Adapted Luminance");
+
+    FrameGraph::Builder shadow = frameGraph->addPass("Shadow");
+    shadow.write(shadowMap);
+    shadow.execute([](const FrameGraph&) { shadowPass(); });
+
+    const Resource pointShadowMaps = frameGraph->importTexture("Point Shadow Maps", texPointShadowMaps);
+
+    FrameGraph::Builder pointShadow = frameGraph->addPass("Point Shadows");
+    pointShadow.write(pointShadowMaps);
+    pointShadow.execute([](const FrameGraph&) { pointShadowPass(); });
+
+    const Resource spotShadowAtlas = frameGraph->importTexture("Spot Shadow Atlas", texSpotShadowAtlas);
+
+    FrameGraph::Builder spotShadow = frameGraph->addPass("Spot Shadows");
+    spotShadow.write(spotShadowAtlas);
+    spotShadow.execute([](const FrameGraph&) { spotShadowPass(); });
+
+    // without deferred shading this is only the depth + normal prepass SSAO reads
+    FrameGraph::Builder geometry = frameGraph->addPass(g_Engine.DEFERRED_SHADING ? "Geometry" : "Depth Normal Prepass");
+    geometry.write(gBuffer);
+    geometry.execute([](const FrameGraph&) { geometryPass(); });
+
+    // occlusion plus the linear depth the upsample compares against
+    const unsigned int divisor = std::max(g_Engine.SSAO_RESOLUTION_DIVISOR, 1u);
+
+    FrameGraph::Builder ssao = frameGraph->addPass("SSAO");
+    ssao.read(gBuffer);
+    const Resource ssaoRaw = ssao.create("SSAO Raw",
+        transientDesc(width / divisor, height / divisor, GL_RG16F, GL_RG, GL_FLOAT, GL_NEAREST));
+    ssao.execute([=](const FrameGraph& fg) { ssaoPass(fg.getTexture(ssaoRaw)); });
+
+    FrameGraph::Builder ssaoBlur = frameGraph->addPass("SSAO Blur");
+    ssaoBlur.read(gBuffer);
+    ssaoBlur.read(ssaoRaw);
+    const Resource ssaoResolved = ssaoBlur.create("SSAO",
+        transientDesc(width, height, GL_R8, GL_RED, GL_UNSIGNED_BYTE, GL_NEAREST));
+    ssaoBlur.execute([=](const FrameGraph& fg) {
+        ssaoBlurPass(fg.getTexture(ssaoRaw), fg.getTexture(ssaoResolved));
+    });
+
+    FrameGraph::Builder scene = frameGraph->addPass("Scene");
+    scene.read(shadowMap);
+    if (g_Engine.POINT_SHADOW_ENBL && g_HasCubeMapArrays) scene.read(pointShadowMaps);
+    if (g_Engine.SPOT_SHADOW_ENBL) scene.read(spotShadowAtlas);
+    // only deferred shading reads the G-Buffer here, forward SSAO gets it through ssaoResolved
+    if (g_Engine.DEFERRED_SHADING) scene.read(gBuffer);
+    if (g_Engine.SSAO_ENBL) scene.read(ssaoResolved);
+    scene.write(offscr);
+    // culled resources are never backed, so this is null without SSAO
+    scene.execute([=](const FrameGraph& fg) { backBufferPass(fg.getTexture(ssaoResolved)); });
+
+    FrameGraph::Builder bloom = frameGraph->addPass("Bloom");
+    bloom.read(offscr);
+
+    std::vector<Resource> bloomMips;
+    unsigned int mipWidth = width, mipHeight = height;
+
+    // every level is a quarter of the area of the one above it
+    for (unsigned int i = 0; i < std::clamp(g_Engine.BLOOM_MIP_LEVELS, 1u, BLOOM_MAX_MIP_LEVELS); i++) {
+        mipWidth = std::max(mipWidth / 2, 1u);
+        mipHeight = std::max(mipHeight / 2, 1u);
+
+        // no alpha needed and half the bandwidth of RGBA16F
+        bloomMips.push_back(bloom.create("Bloom Mip " + std::to_string(i),
+            transientDesc(mipWidth, mipHeight, GL_R11F_G11F_B10F, GL_RGB, GL_FLOAT)));
+    }
+
+    bloom.execute([=](const FrameGraph& fg) {
+        std::vector<Texture::Ptr> mips;
+        for (Resource mip : bloomMips)
+            mips.push_back(fg.getTexture(mip));
+        bloomPass(mips);
+    });
+
+    const bool autoExposure = g_Engine.HDR_ENBL && g_Engine.AUTO_EXPOSURE_ENBL;
+    if (!autoExposure)
+        resetAdaptation = true;
+
+    FrameGraph::Builder exposure = frameGraph->addPass("Exposure");
+    exposure.read(offscr);
+    exposure.write(adaptedLuminance);
+    exposure.execute([](const FrameGraph&) { exposurePass(); });
+
+    if (g_Engine.POST_AA != PostAA::TAA)
+        resetTAAHistory = true;
+
+    const FrameGraph::TextureDesc aaDesc = transientDesc(width, height, GL_RGBA16F, GL_RGBA, GL_FLOAT);
+
+    Resource screen = offscr;
+
+    switch (g_Engine.POST_AA) {
+        case PostAA::FXAA: {
+            FrameGraph::Builder fxaa = frameGraph->addPass("FXAA");
+            fxaa.read(offscr);
+            screen = fxaa.create("FXAA", aaDesc);
+            fxaa.execute([=](const FrameGraph& fg) { fxaaPass(fg.getTexture(screen)); });
+            break;
+        }
+
+        case PostAA::SMAA: {
+            FrameGraph::Builder edges = frameGraph->addPass("SMAA Edges");
+            edges.read(offscr);
+            const Resource smaaEdges = edges.create("SMAA Edges",
+                transientDesc(width, height, GL_RG8, GL_RG, GL_UNSIGNED_BYTE, GL_NEAREST));
+            edges.execute([=](const FrameGraph& fg) { smaaEdgesPass(fg.getTexture(smaaEdges)); });
+
+            FrameGraph::Builder weights = frameGraph->addPass("SMAA Weights");
+            weights.read(smaaEdges);
+            const Resource smaaWeights = weights.create("SMAA Weights",
+                transientDesc(width, height, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, GL_NEAREST));
+            weights.execute([=](const FrameGraph& fg) {
+                smaaWeightsPass(fg.getTexture(smaaEdges), fg.getTexture(smaaWeights));
+            });
+
+            FrameGraph::Builder blend = frameGraph->addPass("SMAA Blend");
+            blend.read(offscr);
+            blend.read(smaaWeights);
+            screen = blend.create("SMAA", aaDesc);
+            blend.execute([=](const FrameGraph& fg) {
+                smaaBlendPass(fg.getTexture(smaaWeights), fg.getTexture(screen));
+            });
+            break;
+        }
+
+        case PostAA::TAA: {
+            // the history has to exist before it can be imported
+            lazyTAA->require();
+
+            const Resource history = frameGraph->importTexture("TAA History", texTAAHistory[taaHistoryIndex]);
+            const Resource resolve = frameGraph->importTexture("TAA Resolve", texTAAHistory[taaHistoryIndex ^ 1]);
+
+            FrameGraph::Builder taa = frameGraph->addPass("TAA");
+            taa.read(offscr);
+            taa.read(history);
+            screen = taa.write(resolve);
+            taa.execute([=](const FrameGraph& fg) {
+                taaPass(fg.getTexture(history), fg.getTexture(resolve));
+            });
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    FrameGraph::Builder postprocess = frameGraph->addPass("Postprocess");
+    postprocess.read(screen);
+    if (g_Engine.BLOOM_ENBL) postprocess.read(bloomMips[0]);
+    if (autoExposure) postprocess.read(adaptedLuminance);
+    // draws to the window
+    postprocess.sideEffect();
+    postprocess.execute([=](const FrameGraph& fg) {
+        postprocessPass(fg.getTexture(screen), fg.getTexture(bloomMips[0]));
+    });
+
+    frameGraph->compile();
+}
+
+void setupFrameGraph() {
+    frameGraph = FrameGraph::New();
+    fboTransient = FrameBuffer::New();
+}
+
 void render() {
 
     using namespace window;
 
+    reloadShaders();
+
+    updateResolutionScale();
+
+    NullGL::beginFrame();
+    Capture::beginFrame();
+    profiler->beginFrame();
+    RenderStats::beginFrame();
+
     // TODO: WHy dont yOu JusT not do tHis at all
     GLbitfield clr_enbl;
 
@@ -1068,18 +2734,44 @@ void render() {
     if (g_Engine.CLEAR_DEPTH_BUF) clr_enbl |= GL_DEPTH_BUFFER_BIT;
     if (g_Engine.CLEAR_STENCIL_BUF) clr_enbl |= GL_STENCIL_BUFFER_BIT;
 
+    // a surfaceless context has no default framebuffer to clear
+    if (fboOutput)
+        fboOutput->bind();
+
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     g_View = camera::g_Camera.GetViewMatrix();
     g_Proj = glm::perspective(camera::g_Camera.Fov(),
                               ASPECT_RATIO, g_Engine.NEAR_PLANE, g_Engine.FAR_PLANE);
 
-    // TODO: SSAO Pass
-    shadowPass();
-    if (g_Engine.DEFERRED_SHADING) geometryPass();
-    backBufferPass();
-    bloomPass();
-    postprocessPass();
+    // TAA reprojects against the unjittered matrices
+    const glm::mat4 viewProj = g_Proj * g_View;
+
+    if (g_Engine.POST_AA == PostAA::TAA) {
+        taaFrameIndex = (taaFrameIndex + 1) % TAA_JITTER_SAMPLES;
+
+        // sub-pixel offset in uv, shifted in NDC after projection
+        taaJitter = glm::vec2(
+            halton(taaFrameIndex + 1, 2) - .5f,
+            halton(taaFrameIndex + 1, 3) - .5f
+        ) / glm::vec2(scaledViewport(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT));
+
+        g_Proj = glm::translate(glm::mat4(1.f), glm::vec3(taaJitter * 2.f, 0.f)) * g_Proj;
+    }
+
+    buildFrameGraph();
+    frameGraph->execute(profiler);
+
+    RenderStats::endFrame();
+    profiler->endFrame();
+    Capture::endFrame();
+    NullGL::endFrame();
+
+    prevViewProj = viewProj;
+
+    const double now = glfwGetTime();
+    for (const LazyResource::Ptr& resource : lazyResources)
+        resource->collect(now, LAZY_RELEASE_SECONDS);
 }
 
 int init() {
@@ -1091,19 +2783,50 @@ int init() {
     //glEnable(GL_CULL_FACE);
     glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 
-    const auto SPath = [](const std::string p) -> const std::string {
-        constexpr static std::string SHADER_DIR = "./src/GLSL/";
-        return SHADER_DIR + p;
+    g_HasComputeShaders = GLAD_GL_VERSION_4_3;
+    g_HasCubeMapArrays = GLAD_GL_VERSION_4_0;
+    g_HasParallelShaderCompile = Shader::enableParallelCompile();
+    // a capture has to hold the sources, cached binaries only replay on this driver
+    g_HasProgramBinaryCache = !Capture::isRecording() && Shader::enableBinaryCache(SHADER_CACHE_DIR);
+    g_HasDebugGroups = Trace::enableDebugGroups();
+
+    shaderWatcher = ShaderWatcher::New(SHADER_DIR);
+
+    const double init_start = glfwGetTime();
+    // both run on the monotonic clock, so one offset maps GLFW time onto the trace
+    const double trace_offset = Trace::now() - init_start * 1e6;
+
+    const auto add_phase = [=](const std::string& name, double start, double end, bool worker = false) {
+        startupTimeline.push_back({name, start - init_start, end - init_start, worker});
+
+        // workers trace their imports themselves
+        if (!worker)
+            Trace::record(name, start * 1e6 + trace_offset, end * 1e6 + trace_offset);
+    };
+
+    // imports and texture decodes run on workers while the driver compiles
+    std::future<Model::Import> sponza_import = Model::importAsync("./assets/Sponza/glTF/Sponza.gltf", true);
+    std::future<Model::Import> nier_2b_import = Model::importAsync("./assets/2be/scene.gltf", true);
+    std::future<Model::Import> cerb_import = Model::importAsync("./assets/cerb/Cerberus_LP.FBX", true);
+
+    std::future<void> hdr_prefetch = std::async(std::launch::async, [] {
+        Texture::prefetch("./assets/newport_loft.hdr");
+    });
+
+    const auto finish_import = [&](std::future<Model::Import>& future) {
+        Model::Import imported = future.get();
+        add_phase("Import " + std::filesystem::path(imported.path).filename().string(),
+            imported.started, imported.finished, true);
+        return imported;
     };
 
+    double phase_start = glfwGetTime();
+
+    // every pass drawing each frame, the optional ones compile theirs on first use
     shaderLightCube = Shader::New(
         SPath("LightCube.vert.glsl"),
         SPath("LightCube.frag.glsl")
     );
-    shaderPhong = Shader::New(
-        SPath("Phong.vert.glsl"),
-        SPath("Phong.frag.glsl")
-    );
     shaderPostProcess = Shader::New(
         SPath("ScreenPostprocess.vert.glsl"),
         SPath("ScreenPostprocess.frag.glsl")
@@ -1116,22 +2839,7 @@ int init() {
         SPath("ShadowMap.vert.glsl"),
         SPath("ShadowMap.frag.glsl")
     );
-    shaderBlur = Shader::New(
-        SPath("GaussianBlur.vert.glsl"),
-        SPath("GaussianBlur.frag.glsl")
-    );
-    shaderGBuffer = Shader::New(
-        SPath("GBuffer.vert.glsl"),
-        SPath("GBuffer.frag.glsl")
-    );
-    shaderGLightPass = Shader::New(
-        SPath("GLightPass.vert.glsl"),
-        SPath("Phong.frag.glsl")
-    );
-    shaderPbr = Shader::New(
-        SPath("PBR.vert.glsl"),
-        SPath("PBR.frag.glsl")
-    );
+    // only needed by the image based lighting precompute below
     shaderEquirectangularToCubemap = Shader::New(
         SPath("Skybox.vert.glsl"),
         SPath("EquirectangularToCubemap.frag.glsl")
@@ -1149,21 +2857,24 @@ int init() {
         SPath("BRDF.frag.glsl")
     );
 
+    add_phase("Issue shader compiles", phase_start, glfwGetTime());
+    phase_start = glfwGetTime();
+
     Scene::Ptr scene = Scene::New();
 
-    Model::Ptr sponza_model = Model::New("./assets/Sponza/glTF/Sponza.gltf", true);
+    Model::Ptr sponza_model = Model::New(finish_import(sponza_import), true);
     //Model::Ptr model1 = Model::New("./assets/SponzaR/sponza.glb", true);
     sponza_model->scale(glm::vec3(0.01));
     //Model::Ptr model2 = Model::New("./assets/backpack.obj");
 
     std::cout << "NIER 2B LOAD NOW" << std::endl;
-    Model::Ptr nier_2b_model = Model::New("./assets/2be/scene.gltf", true, TextureConfig::ColorChannel::BLUE, TextureConfig::ColorChannel::GREEN);
+    Model::Ptr nier_2b_model = Model::New(finish_import(nier_2b_import), true, TextureConfig::ColorChannel::BLUE, TextureConfig::ColorChannel::GREEN);
     nier_2b_model->scale(glm::vec3(0.1f));
     nier_2b_model->rotate(90.f, glm::vec3(0.0, 1.0, 0.0));
     nier_2b_model->translate(glm::vec3(-12.0, 19.5, 64.0));
     nier_2b_model->rotate(25.f, glm::vec3(0.0, 1.0, 0.0));
 
-    Model::Ptr cerb_model = Model::New("./assets/cerb/Cerberus_LP.FBX", true);
+    Model::Ptr cerb_model = Model::New(finish_import(cerb_import), true);
     cerb_model->scale(glm::vec3(0.1));
     cerb_model->rotate(-90.f, glm::vec3(1.0, 0.0, 0.0));
 
@@ -1378,6 +3089,14 @@ int init() {
 
     g_Scenes.push_back(scene);
 
+    // the test groups stay loaded for golden image views
+    g_SceneLibrary["sponza"] = scene;
+    g_SceneLibrary["pbr"] = Scene::New(std::vector<MeshGroup::Ptr>{test_pbr});
+    g_SceneLibrary["normal"] = Scene::New(std::vector<MeshGroup::Ptr>{test_normal});
+    g_SceneLibrary["bloom"] = Scene::New(std::vector<MeshGroup::Ptr>{test_bloom});
+    g_SceneLibrary["shadow"] = Scene::New(std::vector<MeshGroup::Ptr>{test_shadow});
+    g_SceneLibrary["cerberus"] = Scene::New(std::vector<MeshGroup::Ptr>{cerb_model});
+
 
     g_SunLight = DirectionalLight::New(
         g_Engine.LIGHT_DIR,
@@ -1404,31 +3123,82 @@ int init() {
     for (int j = 0; j < 6; j++)
         std::cout << "FACE::" << j << "::" << faces[j] << std::endl;
 
+    hdr_prefetch.wait();
     const Texture::Ptr hdrTexture = Texture::New("./assets/newport_loft.hdr");
 
+    add_phase("Build meshes, upload textures", phase_start, glfwGetTime());
+
+    // whatever is still compiling now is on the critical path
+    startupProgramsCompiling = Shader::countCompiling();
+    startupProgramCount = Shader::getInstances().size();
+
+    phase_start = glfwGetTime();
+    Shader::finishAll();
+    add_phase("Wait for shader compiles", phase_start, glfwGetTime());
+
+    Texture::clearPrefetched();
+
+    phase_start = glfwGetTime();
+
     screenQuad = Quad::New();
 
-    texEnvironmentMap = convertEquirectangularToCubemap(hdrTexture);
-    texEnvironmentMap->setSlot(0);
-    texIrradianceMap = convoluteCubemap(texEnvironmentMap);
-    texIrradianceMap->setSlot(TEXTURE_SLOT_IRRADIANCE);
-    texPrefilterMap = generatePrefilterMap(texEnvironmentMap);
-    texBrdfLUT = generateBrdf();
+    profiler = Profiler::New();
+
+    {
+        Profiler::Scope ibl(profiler, "IBL Precompute");
+        {
+            Profiler::Scope scope(profiler, "Equirect To Cubemap");
+            texEnvironmentMap = convertEquirectangularToCubemap(hdrTexture);
+            texEnvironmentMap->setSlot(0);
+        }
+        {
+            Profiler::Scope scope(profiler, "Irradiance");
+            texIrradianceMap = convoluteCubemap(texEnvironmentMap);
+            texIrradianceMap->setSlot(TEXTURE_SLOT_IRRADIANCE);
+        }
+        {
+            Profiler::Scope scope(profiler, "Prefilter");
+            texPrefilterMap = generatePrefilterMap(texEnvironmentMap);
+        }
+        {
+            Profiler::Scope scope(profiler, "BRDF LUT");
+            texBrdfLUT = generateBrdf();
+        }
+    }
+    // runs once, so its results are read back right away
+    profiler->flush();
     //skybox = Skybox::New(faces);
     skybox = Skybox::New(texEnvironmentMap);
 
+    shaderEquirectangularToCubemap = shaderIrradiance = shaderPrefilter = shaderBrdf = nullptr;
+
+    add_phase("Image based lighting", phase_start, glfwGetTime());
+    phase_start = glfwGetTime();
+
+    setupFrameGraph();
     setupShadowPass();
+    setupPointShadowPass();
+    setupSpotShadowPass();
     setupOffscrPass();
     setupGeometryPass();
-    setupBloomPass();
     setupSSAOPass();
+    setupBloomPass();
+    setupExposurePass();
+    setupAAPass();
     setupPostprocessPass();
 
+    add_phase("Render setup", phase_start, glfwGetTime());
+
+    for (const StartupPhase& phase : startupTimeline)
+        std::cout << "STARTUP::" << phase.name << "::" << phase.start * 1000.0 << "ms.."
+            << phase.end * 1000.0 << "ms" << (phase.worker ? " (worker)" : "") << std::endl;
+
     return 0;
 }
 
 void updateState() {
     camera::g_Camera.updateCamera(camera::CAMERA_STATE);
+    stress::update();
 
     g_Engine.CLEAR_COLOR = ENGINE_STATE.CLEAR_COLOR;
 
@@ -1483,10 +3253,38 @@ void updateState() {
         texShadowmap->resize(g_Engine.SHADOW_WIDTH, g_Engine.SHADOW_HEIGHT);
     }
 
+    if (g_Engine.POINT_SHADOW_ENBL != ENGINE_STATE.POINT_SHADOW_ENBL)
+        g_Engine.POINT_SHADOW_ENBL = ENGINE_STATE.POINT_SHADOW_ENBL;
+
+    if (g_Engine.POINT_SHADOW_BUDGET != ENGINE_STATE.POINT_SHADOW_BUDGET ||
+        g_Engine.POINT_SHADOW_RESOLUTION != ENGINE_STATE.POINT_SHADOW_RESOLUTION) {
+
+        g_Engine.POINT_SHADOW_BUDGET = ENGINE_STATE.POINT_SHADOW_BUDGET;
+        g_Engine.POINT_SHADOW_RESOLUTION = ENGINE_STATE.POINT_SHADOW_RESOLUTION;
+
+        if (lazyPointShadows->isLive())
+            resizePointShadowPass();
+    }
+
+    if (g_Engine.SPOT_SHADOW_ENBL != ENGINE_STATE.SPOT_SHADOW_ENBL)
+        g_Engine.SPOT_SHADOW_ENBL = ENGINE_STATE.SPOT_SHADOW_ENBL;
+
+    if (g_Engine.SPOT_SHADOW_ATLAS_SIZE != ENGINE_STATE.SPOT_SHADOW_ATLAS_SIZE) {
+        g_Engine.SPOT_SHADOW_ATLAS_SIZE = ENGINE_STATE.SPOT_SHADOW_ATLAS_SIZE;
+
+        if (lazySpotShadows->isLive()) {
+            texSpotShadowAtlas->resize(g_Engine.SPOT_SHADOW_ATLAS_SIZE, g_Engine.SPOT_SHADOW_ATLAS_SIZE);
+            spotShadowTiles.clear();
+        }
+    }
+
     // must update msaa before resizing
     if (g_Engine.MSAA_ENBL != ENGINE_STATE.MSAA_ENBL)
         g_Engine.MSAA_ENBL = ENGINE_STATE.MSAA_ENBL;
 
+    if (g_Engine.POST_AA != ENGINE_STATE.POST_AA)
+        g_Engine.POST_AA = ENGINE_STATE.POST_AA;
+
 
     bool regen_buffers = false;
 
@@ -1515,46 +3313,84 @@ void updateState() {
         regen_buffers = true;
     }
 
-    if (g_Engine.BLOOM_ENBL != ENGINE_STATE.BLOOM_ENBL) {
+    if (g_Engine.BLOOM_ENBL != ENGINE_STATE.BLOOM_ENBL)
         g_Engine.BLOOM_ENBL = ENGINE_STATE.BLOOM_ENBL;
-        regen_buffers = true;
-    }
+
+    if (g_Engine.BLOOM_THRESHOLD != ENGINE_STATE.BLOOM_THRESHOLD)
+        g_Engine.BLOOM_THRESHOLD = ENGINE_STATE.BLOOM_THRESHOLD;
+    if (g_Engine.BLOOM_STRENGTH != ENGINE_STATE.BLOOM_STRENGTH)
+        g_Engine.BLOOM_STRENGTH = ENGINE_STATE.BLOOM_STRENGTH;
+    if (g_Engine.BLOOM_MIP_LEVELS != ENGINE_STATE.BLOOM_MIP_LEVELS)
+        g_Engine.BLOOM_MIP_LEVELS = ENGINE_STATE.BLOOM_MIP_LEVELS;
 
     if (g_Engine.HDR_ENBL && (g_Engine.HDR_EXPOSURE != ENGINE_STATE.HDR_EXPOSURE))
         g_Engine.HDR_EXPOSURE = ENGINE_STATE.HDR_EXPOSURE;
 
+    if (g_Engine.AUTO_EXPOSURE_ENBL != ENGINE_STATE.AUTO_EXPOSURE_ENBL)
+        g_Engine.AUTO_EXPOSURE_ENBL = ENGINE_STATE.AUTO_EXPOSURE_ENBL;
+    if (g_Engine.AUTO_EXPOSURE_KEY != ENGINE_STATE.AUTO_EXPOSURE_KEY)
+        g_Engine.AUTO_EXPOSURE_KEY = ENGINE_STATE.AUTO_EXPOSURE_KEY;
+    if (g_Engine.AUTO_EXPOSURE_SPEED != ENGINE_STATE.AUTO_EXPOSURE_SPEED)
+        g_Engine.AUTO_EXPOSURE_SPEED = ENGINE_STATE.AUTO_EXPOSURE_SPEED;
+
     if (g_Engine.DEFERRED_SHADING != ENGINE_STATE.DEFERRED_SHADING) {
         g_Engine.DEFERRED_SHADING = ENGINE_STATE.DEFERRED_SHADING;
         regen_buffers = true;
     }
 
-    if (regen_buffers) {
+    if (g_Engine.LIGHT_VOLUMES_ENBL != ENGINE_STATE.LIGHT_VOLUMES_ENBL)
+        g_Engine.LIGHT_VOLUMES_ENBL = ENGINE_STATE.LIGHT_VOLUMES_ENBL;
+
+    if (g_Engine.SSAO_ENBL != ENGINE_STATE.SSAO_ENBL)
+        g_Engine.SSAO_ENBL = ENGINE_STATE.SSAO_ENBL;
+    if (g_Engine.SSAO_RADIUS != ENGINE_STATE.SSAO_RADIUS)
+        g_Engine.SSAO_RADIUS = ENGINE_STATE.SSAO_RADIUS;
 
-        TextureConfig
-        texOffscr_TConf = texOffscr->getTextureConfig(),
-        texOffscrBright_TConf = texOffscrBright->getTextureConfig(),
-        texOffscrMSAA_TConf = texOffscrMSAA->getTextureConfig();
+    if (g_Engine.SSAO_SAMPLES != ENGINE_STATE.SSAO_SAMPLES) {
+        g_Engine.SSAO_SAMPLES = ENGINE_STATE.SSAO_SAMPLES;
 
-        texOffscr_TConf.hdr = texOffscrBright_TConf.hdr = texOffscrMSAA_TConf.hdr
-            = g_Engine.HDR_ENBL;
+        // otherwise created with the new count
+        if (lazySSAO->isLive())
+            generateSSAOKernel(g_Engine.SSAO_SAMPLES);
+    }
 
-        texOffscrMSAA_TConf.msaa_multiplier = g_Engine.MSAA_MULTIPLIER;
+    if (g_Engine.SSAO_RESOLUTION_DIVISOR != ENGINE_STATE.SSAO_RESOLUTION_DIVISOR)
+        g_Engine.SSAO_RESOLUTION_DIVISOR = ENGINE_STATE.SSAO_RESOLUTION_DIVISOR;
 
-        texOffscr->setTextureConfig(texOffscr_TConf);
-        texOffscrBright->setTextureConfig(texOffscrBright_TConf);
-        texOffscrMSAA->setTextureConfig(texOffscrMSAA_TConf);
+    if (g_Engine.DYNAMIC_RES_ENBL != ENGINE_STATE.DYNAMIC_RES_ENBL)
+        g_Engine.DYNAMIC_RES_ENBL = ENGINE_STATE.DYNAMIC_RES_ENBL;
+    if (g_Engine.DYNAMIC_RES_TARGET_MS != ENGINE_STATE.DYNAMIC_RES_TARGET_MS)
+        g_Engine.DYNAMIC_RES_TARGET_MS = ENGINE_STATE.DYNAMIC_RES_TARGET_MS;
+    if (g_Engine.DYNAMIC_RES_MIN_SCALE != ENGINE_STATE.DYNAMIC_RES_MIN_SCALE)
+        g_Engine.DYNAMIC_RES_MIN_SCALE = ENGINE_STATE.DYNAMIC_RES_MIN_SCALE;
+    if (g_Engine.DYNAMIC_RES_SHARPNESS != ENGINE_STATE.DYNAMIC_RES_SHARPNESS)
+        g_Engine.DYNAMIC_RES_SHARPNESS = ENGINE_STATE.DYNAMIC_RES_SHARPNESS;
 
-        texOffscrMSAA->resize(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
-        texOffscrBright->resize(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
-        rboOffscrMSAA->resize(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+    // targets that are not live get created at the new size when needed
+    if (regen_buffers) {
+
+        TextureConfig texOffscr_TConf = texOffscr->getTextureConfig();
+        texOffscr_TConf.hdr = g_Engine.HDR_ENBL;
+        texOffscr->setTextureConfig(texOffscr_TConf);
 
         texOffscr->resize(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
-        rboOffscr->resize(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+        texOffscrDepth->resize(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+
+        if (lazyMSAA->isLive()) {
+            TextureConfig texOffscrMSAA_TConf = texOffscrMSAA->getTextureConfig();
+            texOffscrMSAA_TConf.hdr = g_Engine.HDR_ENBL;
+            texOffscrMSAA_TConf.msaa_multiplier = g_Engine.MSAA_MULTIPLIER;
+            texOffscrMSAA->setTextureConfig(texOffscrMSAA_TConf);
 
-        texBlurHoriz->resize(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
-        texBlurVert->resize(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+            texOffscrMSAA->resize(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+            rboOffscrMSAA->resize(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+        }
+
+        if (lazyGBuffer->isLive())
+            fboGBuffer->resize(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
 
-        fboGBuffer->resize(g_Engine.RENDER_WIDTH, g_Engine.RENDER_HEIGHT);
+        if (lazyTAA->isLive())
+            resizeAAPass();
     }
 
     if (g_Engine.SCREEN_WIDTH != ENGINE_STATE.SCREEN_WIDTH) {
@@ -1563,6 +3399,9 @@ void updateState() {
         g_Engine.SCREEN_HEIGHT = ENGINE_STATE.SCREEN_HEIGHT;
 
         window::resize_window(g_Engine.SCREEN_WIDTH, g_Engine.SCREEN_HEIGHT);
+
+        if (texOutput)
+            texOutput->resize(g_Engine.SCREEN_WIDTH, g_Engine.SCREEN_HEIGHT);
     }
 
     ENGINE_STATE = g_Engine;
@@ -1614,5 +3453,62 @@ const Light::Ptr getLight(int index) {
 }
 
 
-void terminate() {}
+// everything owning a GL name goes while the context is still current,
+// static destruction runs after window::terminate() has destroyed it
+void terminate() {
+    for (const LazyResource::Ptr& resource : lazyResources)
+        resource->release();
+    lazyResources.clear();
+
+    for (LazyResource::Ptr* resource : {
+        &lazyForwardPhong, &lazyForwardPbr, &lazyMSAA, &lazyGBuffer, &lazyDeferredPhong, &lazyDeferredPbr,
+        &lazyLightVolumes, &lazySSAO, &lazyBloom, &lazyExposure, &lazyFXAA, &lazySMAA, &lazyTAA,
+        &lazyPointShadows, &lazySpotShadows
+    })
+        *resource = nullptr;
+
+    // drops the transient texture pool with it
+    frameGraph = nullptr;
+    profiler = nullptr;
+
+    g_Scenes.clear();
+    g_SceneLibrary.clear();
+    g_Lights.clear();
+    g_SunLight = nullptr;
+
+    for (Shader::Ptr* shader : {
+        &shaderLightCube, &shaderPhong, &shaderPostProcess, &shaderSkybox, &shaderShadow, &shaderPointShadow,
+        &shaderBloomDownsample, &shaderBloomUpsample, &shaderLuminanceHistogram, &shaderLuminanceAverage,
+        &shaderLogLuminance, &shaderLuminanceAdapt, &shaderGBuffer, &shaderGLightPass, &shaderGLightPassPbr,
+        &shaderLightVolume, &shaderLightVolumeStencil, &shaderSSAO, &shaderSSAOBlur, &shaderFXAA,
+        &shaderSMAAEdges, &shaderSMAAWeights, &shaderSMAABlend, &shaderTAA, &shaderPbr,
+        &shaderEquirectangularToCubemap, &shaderIrradiance, &shaderPrefilter, &shaderBrdf
+    })
+        *shader = nullptr;
+    shaderWatcher = nullptr;
+
+    for (FrameBuffer::Ptr* fbo : {
+        &fboShadow, &fboPointShadow, &fboSpotShadow, &fboOffscrMSAA, &fboOffscr, &fboLuminance, &fboCapture,
+        &fboOutput, &fboTransient
+    })
+        *fbo = nullptr;
+    fboGBuffer = nullptr;
+
+    rboOffscrMSAA = rboCapture = nullptr;
+
+    texShadowmap = texSpotShadowAtlas = nullptr;
+    texPointShadowMaps = nullptr;
+    texOutput = texOffscr = texLuminanceHistogram = texLogLuminance = texBrdfLUT = nullptr;
+    texOffscrDepth = nullptr;
+    texOffscrMSAA = nullptr;
+    texAdaptedLuminance = {};
+    texTAAHistory = {};
+    texSSAONoise = ssaoResult = nullptr;
+    texEnvironmentMap = texIrradianceMap = texPrefilterMap = nullptr;
+
+    screenQuad = nullptr;
+    lightVolumeSphere = nullptr;
+    pointLightsCube = spotLightsCube = nullptr;
+    skybox = nullptr;
+}
 }
@@ -2,26 +2,46 @@
 #define RENDERER_H
 
 #include "Core/FrameBuffer.hpp"
+#include "Core/FrameGraph.hpp"
 #include "Core/GBuffer.hpp"
+#include "Core/LazyResource.hpp"
+#include "Core/Profiler.hpp"
 #include "Core/RenderBuffer.hpp"
 #include "Core/Scene.hpp"
+#include "Core/Shader/ShaderWatcher.hpp"
 #include "Core/Shapes/Cube.hpp"
 #include "Core/Shapes/Quad.hpp"
+#include "Core/Shapes/Sphere.hpp"
 #include "Renderer/Skybox.hpp"
 #include "Lighting/Light.hpp"
 #include "Lighting/DirectionalLight.hpp"
+#include "Lighting/PointLight.hpp"
 #include "Camera.hpp"
+#include "Texture/CubeMapArrayDepthTexture.hpp"
 #include "Texture/CubeMapBufferTexture.hpp"
 #include "Texture/MonoBufferTexture.hpp"
 #include "Texture/MultisampleTexture.hpp"
 #include "Texture/ColorBufferTexture.hpp"
 #include "Texture/DepthBufferTexture.hpp"
+#include "Texture/DepthStencilBufferTexture.hpp"
 
+#include <array>
 #include <concepts>
 #include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace renderer
 {
+// Antialiasing done after the scene is resolved, MSAA is configured on its own
+enum class PostAA : int {
+    NONE,
+    FXAA,
+    SMAA,
+    TAA
+};
+
 struct EngineState {
 
     int UI_ENBL;
@@ -55,17 +75,48 @@ struct EngineState {
     unsigned int MSAA_ENBL;
     unsigned int MSAA_MULTIPLIER;
 
+    PostAA POST_AA;
+
     int SHADOW_ENBL;
     unsigned int SHADOW_WIDTH;
     unsigned int SHADOW_HEIGHT;
 
+    // cube shadow maps for the point lights with the most screen influence
+    int POINT_SHADOW_ENBL;
+    unsigned int POINT_SHADOW_BUDGET;
+    unsigned int POINT_SHADOW_RESOLUTION;
+
+    // one depth atlas shared by every shadowed spot light
+    int SPOT_SHADOW_ENBL;
+    unsigned int SPOT_SHADOW_ATLAS_SIZE;
+
     int HDR_ENBL;
     float HDR_EXPOSURE;
 
+    int AUTO_EXPOSURE_ENBL;
+    float AUTO_EXPOSURE_KEY;
+    float AUTO_EXPOSURE_SPEED;
+
     int BLOOM_ENBL;
+    float BLOOM_THRESHOLD;
+    float BLOOM_STRENGTH;
+    unsigned int BLOOM_MIP_LEVELS;
     int DEFERRED_SHADING;
+    int LIGHT_VOLUMES_ENBL;
     int PBR_ENBL;
 
+    int SSAO_ENBL;
+    unsigned int SSAO_SAMPLES;
+    float SSAO_RADIUS;
+    // 2 is half, 4 quarter resolution
+    unsigned int SSAO_RESOLUTION_DIVISOR;
+
+    // scales the render viewport to hold a GPU frame time, upscaled in postprocess
+    int DYNAMIC_RES_ENBL;
+    float DYNAMIC_RES_TARGET_MS;
+    float DYNAMIC_RES_MIN_SCALE;
+    float DYNAMIC_RES_SHARPNESS;
+
     EngineState() {
         UI_ENBL = true;
 
@@ -106,17 +157,44 @@ struct EngineState {
 
         MSAA_MULTIPLIER = 4;
 
+        POST_AA = PostAA::NONE;
+
         SHADOW_ENBL = true;
         SHADOW_WIDTH = SHADOW_HEIGHT = 1024;
 
+        POINT_SHADOW_ENBL = false;
+        POINT_SHADOW_BUDGET = 4;
+        POINT_SHADOW_RESOLUTION = 512;
+
+        SPOT_SHADOW_ENBL = false;
+        SPOT_SHADOW_ATLAS_SIZE = 4096;
+
         HDR_ENBL = true;
         HDR_EXPOSURE = 1.f;
 
+        AUTO_EXPOSURE_ENBL = false;
+        AUTO_EXPOSURE_KEY = 0.18f;
+        AUTO_EXPOSURE_SPEED = 1.5f;
+
         BLOOM_ENBL = false;
+        BLOOM_THRESHOLD = 1.0f;
+        BLOOM_STRENGTH = 0.15f;
+        BLOOM_MIP_LEVELS = 6;
 
         DEFERRED_SHADING = false;
+        LIGHT_VOLUMES_ENBL = false;
 
         PBR_ENBL = true;
+
+        SSAO_ENBL = false;
+        SSAO_SAMPLES = 16;
+        SSAO_RADIUS = 0.5f;
+        SSAO_RESOLUTION_DIVISOR = 2;
+
+        DYNAMIC_RES_ENBL = false;
+        DYNAMIC_RES_TARGET_MS = 16.6f;
+        DYNAMIC_RES_MIN_SCALE = 0.5f;
+        DYNAMIC_RES_SHARPNESS = 0.25f;
     }
 };
 
@@ -125,11 +203,18 @@ constexpr static unsigned int TEXTURE_SLOT_DIFFUSE = 0;
 constexpr static unsigned int TEXTURE_SLOT_SPECULAR = 1;
 constexpr static unsigned int TEXTURE_SLOT_SHADOW = 2;
 constexpr static unsigned int TEXTURE_SLOT_NORMAL = 3;
+// the Phong shaders never sample the PBR roughness slot
+constexpr static unsigned int TEXTURE_SLOT_SPOT_SHADOW = 4;
+
+// Deferred slots sit above the PBR/IBL ones so both light passes can use them
+constexpr static unsigned int TEXTURE_SLOT_DEFERRED_DEPTH = 9;
+constexpr static unsigned int TEXTURE_SLOT_DEFERRED_NORMAL = 10;
+constexpr static unsigned int TEXTURE_SLOT_DEFERRED_ALBEDOSPEC = 11;
+constexpr static unsigned int TEXTURE_SLOT_DEFERRED_MATERIAL = 12;
 
-constexpr static unsigned int TEXTURE_SLOT_DEFERRED_POSITION = 5;
-constexpr static unsigned int TEXTURE_SLOT_DEFERRED_NORMAL = 6;
-constexpr static unsigned int TEXTURE_SLOT_DEFERRED_ALBEDOSPEC = 7;
-constexpr static unsigned int TEXTURE_SLOT_DEFERRED_POSITION_LIGHT_SPACE = 8;
+// Read by every lighting shader
+constexpr static unsigned int TEXTURE_SLOT_SSAO = 13;
+constexpr static unsigned int TEXTURE_SLOT_POINT_SHADOW = 14;
 
 constexpr static unsigned int TEXTURE_SLOT_UNBOUND = 15;
 
@@ -147,12 +232,15 @@ constexpr static unsigned int TEXTURE_SLOT_BRDF_LUT = 8;
 // Texture slots for shaderPostProcess
 constexpr static unsigned int TEXTURE_SLOT_SCREEN = 0;
 constexpr static unsigned int TEXTURE_SLOT_BLOOM = 1;
+constexpr static unsigned int TEXTURE_SLOT_EXPOSURE = 2;
 
 // Texture slots for shaderSkybox
 constexpr static unsigned int TEXTURE_SLOT_SKYBOX = 0;
 
 constexpr static float ASPECT_RATIO = 16.0 / 9.0;
 constexpr static unsigned int NR_MAX_LIGHTS = 10;
+constexpr static unsigned int BLOOM_MAX_MIP_LEVELS = 8;
+constexpr static unsigned int SSAO_MAX_KERNEL_SIZE = 64;
 
 namespace camera {
     extern Camera CAMERA_STATE;
@@ -167,16 +255,65 @@ extern Shader::Ptr shaderPhong;
 extern Shader::Ptr shaderPostProcess;
 extern Shader::Ptr shaderSkybox;
 extern Shader::Ptr shaderShadow;
-extern Shader::Ptr shaderBlur;
+extern Shader::Ptr shaderBloomDownsample;
+extern Shader::Ptr shaderBloomUpsample;
+extern Shader::Ptr shaderLuminanceHistogram;
+extern Shader::Ptr shaderLuminanceAverage;
+extern Shader::Ptr shaderLogLuminance;
+extern Shader::Ptr shaderLuminanceAdapt;
 extern Shader::Ptr shaderGBuffer;
 extern Shader::Ptr shaderGLightPass;
+extern Shader::Ptr shaderGLightPassPbr;
+extern Shader::Ptr shaderLightVolume;
+extern Shader::Ptr shaderLightVolumeStencil;
+extern Shader::Ptr shaderSSAO;
+extern Shader::Ptr shaderSSAOBlur;
+extern Shader::Ptr shaderFXAA;
+extern Shader::Ptr shaderSMAAEdges;
+extern Shader::Ptr shaderSMAAWeights;
+extern Shader::Ptr shaderSMAABlend;
+extern Shader::Ptr shaderTAA;
 extern Shader::Ptr shaderPbr;
 extern Shader::Ptr shaderEquirectangularToCubemap;
 extern Shader::Ptr shaderIrradiance;
 extern Shader::Ptr shaderPrefilter;
 extern Shader::Ptr shaderBrdf;
 
+// compute path needs GL 4.3, otherwise exposure falls back to a mip reduction
+extern bool g_HasComputeShaders;
+
+// GL_KHR_parallel_shader_compile, reloads are then compiled off the render thread
+extern bool g_HasParallelShaderCompile;
+
+// linked programs are reused across runs, GL 4.1
+extern bool g_HasProgramBinaryCache;
+
+// GL 4.3 or GL_KHR_debug, profiler scopes then appear as groups in GL capture tools
+extern bool g_HasDebugGroups;
+
+// recompiles the programs using a GLSL file once it is saved
+extern ShaderWatcher::Ptr shaderWatcher;
+extern unsigned int shaderReloads;
+extern unsigned int shaderReloadFailures;
+extern std::string lastShaderReload;
+
+// seconds since init() started, worker phases overlap the main thread ones
+struct StartupPhase {
+    std::string name;
+    double start, end;
+    bool worker;
+};
+
+extern std::vector<StartupPhase> startupTimeline;
+extern unsigned int startupProgramsCompiling;
+extern unsigned int startupProgramCount;
+
+// fraction of the render targets drawn this frame, 1 without dynamic resolution
+extern float g_ResolutionScale;
+
 extern std::vector<Scene::Ptr> g_Scenes;
+// every scene init() builds by name, g_Scenes holds the drawn ones
+extern std::unordered_map<std::string, Scene::Ptr> g_SceneLibrary;
 extern DirectionalLight::Ptr g_SunLight;
 extern std::vector<Light::Ptr> g_Lights;
 
@@ -187,33 +324,43 @@ extern glm::mat4 g_LightSpaceMatrix;
 extern FrameBuffer::Ptr fboShadow;
 extern FrameBuffer::Ptr fboOffscrMSAA;
 extern FrameBuffer::Ptr fboOffscr;
-extern FrameBuffer::Ptr fboBlurHoriz;
-extern FrameBuffer::Ptr fboBlurVert;
-extern FrameBuffer::Ptr fboSSAO;
-extern FrameBuffer::Ptr fboSSAOBlur;
+extern FrameBuffer::Ptr fboLuminance;
 extern FrameBuffer::Ptr fboCapture;
 
+// without a window the postprocess pass draws here instead of the default framebuffer
+extern bool g_Headless;
+// seconds per frame for time dependent effects, 0 follows the wall clock
+extern float g_FixedTimestep;
+extern FrameBuffer::Ptr fboOutput;
+extern ColorBufferTexture::Ptr texOutput;
+
 extern GBuffer::Ptr fboGBuffer;
 
-extern RenderBuffer::Ptr rboOffscr;
+// owns the transient targets of the screen space passes
+extern FrameGraph::Ptr frameGraph;
+
+// shaders and persistent targets of the optional features
+extern std::vector<LazyResource::Ptr> lazyResources;
+
 extern RenderBuffer::Ptr rboOffscrMSAA;
 extern RenderBuffer::Ptr rboCapture;
 
 extern DepthBufferTexture::Ptr texShadowmap;
 extern ColorBufferTexture::Ptr texOffscr;
-extern ColorBufferTexture::Ptr texOffscrBright;
+extern DepthStencilBufferTexture::Ptr texOffscrDepth;
 extern MultisampleTexture::Ptr texOffscrMSAA;
-extern ColorBufferTexture::Ptr texBlurHoriz;
-extern ColorBufferTexture::Ptr texBlurVert;
-extern MonoBufferTexture::Ptr texSSAO;
-extern MonoBufferTexture::Ptr texSSAOBlur;
+extern ColorBufferTexture::Ptr texLuminanceHistogram;
+extern ColorBufferTexture::Ptr texLogLuminance;
+extern std::array<ColorBufferTexture::Ptr, 2> texAdaptedLuminance;
 extern Texture::Ptr texSSAONoise;
+extern std::array<ColorBufferTexture::Ptr, 2> texTAAHistory;
 extern CubeMapBufferTexture::Ptr texEnvironmentMap;
 extern CubeMapBufferTexture::Ptr texIrradianceMap;
 extern CubeMapBufferTexture::Ptr texPrefilterMap;
 extern ColorBufferTexture::Ptr texBrdfLUT;
 
 extern Quad::Ptr screenQuad;
+extern Sphere::Ptr lightVolumeSphere;
 extern Cube::Ptr pointLightsCube;
 
 // TODO: make me a prism or something
@@ -221,6 +368,11 @@ extern Cube::Ptr spotLightsCube;
 
 
 extern Skybox::Ptr skybox;
+
+
+// per pass GPU and CPU timings, plus the one-off image based lighting precompute
+extern Profiler::Ptr profiler;
+
 // proj and view
 // camera
 // vector lights
@@ -233,6 +385,38 @@ void updateState();
 void render();
 void terminate();
 
+// RGBA rows of the last presented frame, top row first, from fboOutput when headless
+std::vector<uint8_t> readFrame();
+// writes the last presented frame as a PNG
+bool saveFrame(const std::string& path);
+
+// part of a width x height target covered at the current resolution scale
+glm::uvec2 scaledViewport(unsigned int width, unsigned int height);
+
+// Phong light arrays, sun and shadow samplers of g_Lights
+void sendLightUniforms(const Shader::Ptr& shader);
+
+// lights given a shadow last frame, and how many of their maps were redrawn
+struct ShadowStats {
+    unsigned int count = 0;
+    unsigned int redraws = 0;
+};
+
+// point light shadows live in a cube map array, GL 4.0
+bool pointShadowsSupported();
+ShadowStats pointShadowStats();
+// atlas tiles handed to spot lights
+ShadowStats spotShadowStats();
+
+struct PointShadowCandidate {
+    const PointLight* light;
+    float farPlane;
+    float influence;
+};
+
+// point lights in view, most screen influence first, at most budget of them
+std::vector<PointShadowCandidate> pointShadowCandidates(size_t budget);
+
 size_t getLightsCount(LightType lt);
 void addSpotLight();
 void addPointLight();
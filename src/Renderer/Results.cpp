@@ -0,0 +1,294 @@
+#include "Results.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#define GLR_NULL_DEVICE "NUL"
+#else
+#define GLR_NULL_DEVICE "/dev/null"
+#endif
+
+#ifndef GLR_BUILD_TYPE
+#define GLR_BUILD_TYPE ""
+#endif
+
+namespace renderer::results {
+
+// first line a command prints, empty when it fails
+static std::string shell(const char* command) {
+    FILE* pipe = popen(command, "r");
+    if (!pipe)
+        return "";
+
+    char line[256] = {};
+    const bool read = std::fgets(line, sizeof(line), pipe) != nullptr;
+    pclose(pipe);
+
+    std::string result = read ? line : "";
+    while (!result.empty() && (result.back() == '\n' || result.back() == '\r' || result.back() == ' '))
+        result.pop_back();
+    return result;
+}
+
+static std::string cpuModel() {
+#if defined(__linux__)
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.rfind("model name", 0) == 0)
+            return line.substr(line.find(':') + 2);
+    }
+    return "";
+#elif defined(__APPLE__)
+    return shell("sysctl -n machdep.cpu.brand_string");
+#else
+    const char* identifier = std::getenv("PROCESSOR_IDENTIFIER");
+    return identifier ? identifier : "";
+#endif
+}
+
+static const char* osName() {
+#if defined(__linux__)
+    return "linux";
+#elif defined(__APPLE__)
+    return "macos";
+#elif defined(_WIN32)
+    return "windows";
+#else
+    return "unknown";
+#endif
+}
+
+// FNV-1a, stable across runs unlike std::hash
+static std::string fingerprint(const std::string& text) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+
+    std::ostringstream out;
+    out << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return out.str().substr(0, 12);
+}
+
+Context context(const std::string& glRenderer) {
+    Context result;
+
+    const char* commit = std::getenv("GLR_COMMIT");
+    if (commit && *commit) {
+        result.commit = commit;
+    } else {
+        result.commit = shell("git rev-parse --short=12 HEAD 2>" GLR_NULL_DEVICE);
+        result.dirty = !shell("git status --porcelain --untracked-files=no 2>" GLR_NULL_DEVICE).empty();
+    }
+    if (result.commit.empty())
+        result.commit = "unknown";
+
+    result.buildType = GLR_BUILD_TYPE;
+    result.host = shell("hostname");
+    result.cpu = cpuModel();
+    result.glRenderer = glRenderer;
+    result.machine = fingerprint(result.cpu + "|" + std::to_string(std::thread::hardware_concurrency())
+        + "|" + osName() + "|" + glRenderer);
+
+    return result;
+}
+
+std::string quote(const std::string& text) {
+    std::string result = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') result += '\\';
+        if (c == '\n') { result += "\\n"; continue; }
+        if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            result += escaped;
+            continue;
+        }
+        result += c;
+    }
+    return result + "\"";
+}
+
+std::string buildId(const Context& context) {
+    return context.dirty ? context.commit + "+dirty" : context.commit;
+}
+
+static std::string timestamp() {
+    const std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    std::tm utc {};
+#ifdef _WIN32
+    gmtime_s(&utc, &now);
+#else
+    gmtime_r(&now, &utc);
+#endif
+
+    std::ostringstream out;
+    out << std::put_time(&utc, "%Y-%m-%dT%H:%M:%SZ");
+    return out.str();
+}
+
+bool append(const std::string& path, const Context& context, const std::vector<Record>& records) {
+    std::ofstream out(path, std::ios::app);
+    if (!out) {
+        std::cerr << "ERROR::RESULTS::STORE_NOT_OPENED::" << path << std::endl;
+        return false;
+    }
+
+    const std::string time = timestamp();
+
+    out << std::setprecision(6);
+    for (const Record& record : records) {
+        out << "{\"time\": " << quote(time)
+            << ", \"commit\": " << quote(context.commit)
+            << ", \"dirty\": " << (context.dirty ? "true" : "false")
+            << ", \"build_type\": " << quote(context.buildType)
+            << ", \"machine\": " << quote(context.machine)
+            << ", \"host\": " << quote(context.host)
+            << ", \"cpu\": " << quote(context.cpu)
+            << ", \"gl_renderer\": " << quote(context.glRenderer)
+            << ", \"suite\": " << quote(record.suite)
+            << ", \"name\": " << quote(record.name)
+            << ", \"unit\": " << quote(record.unit)
+            << ", \"samples\": [";
+
+        for (size_t i = 0; i < record.samples.size(); i++)
+            out << (i > 0 ? ", " : "") << record.samples[i];
+
+        out << "]}\n";
+    }
+
+    return out.good();
+}
+
+// the flat objects append() writes: strings, numbers, booleans and number arrays
+static bool parseLine(const std::string& line, std::unordered_map<std::string, std::string>& strings,
+                      std::vector<double>& samples, bool& dirty) {
+    size_t i = 0;
+
+    const auto skip = [&] {
+        while (i < line.size() && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) i++;
+    };
+    const auto expect = [&](char c) {
+        skip();
+        if (i >= line.size() || line[i] != c) return false;
+        i++;
+        return true;
+    };
+    const auto string = [&](std::string& value) {
+        if (!expect('"')) return false;
+        value.clear();
+        while (i < line.size() && line[i] != '"') {
+            if (line[i] == '\\' && i + 1 < line.size()) {
+                i++;
+                value += line[i] == 'n' ? '\n' : line[i];
+            } else
+                value += line[i];
+            i++;
+        }
+        return expect('"');
+    };
+    const auto number = [&](double& value) {
+        skip();
+        char* end = nullptr;
+        value = std::strtod(line.c_str() + i, &end);
+        if (end == line.c_str() + i) return false;
+        i = end - line.c_str();
+        return true;
+    };
+
+    if (!expect('{'))
+        return false;
+
+    for (bool first = true;; first = false) {
+        skip();
+        if (i < line.size() && line[i] == '}')
+            return true;
+        if (!first && !expect(','))
+            return false;
+
+        std::string key;
+        if (!string(key) || !expect(':'))
+            return false;
+
+        skip();
+        if (i >= line.size())
+            return false;
+
+        if (line[i] == '"') {
+            if (!string(strings[key])) return false;
+        } else if (line[i] == '[') {
+            i++;
+            skip();
+            while (i < line.size() && line[i] != ']') {
+                double value;
+                if (!number(value)) return false;
+                samples.push_back(value);
+                skip();
+                if (i < line.size() && line[i] == ',') i++;
+            }
+            if (!expect(']')) return false;
+        } else if (line.compare(i, 4, "true") == 0) {
+            dirty = key == "dirty" || dirty;
+            i += 4;
+        } else if (line.compare(i, 5, "false") == 0) {
+            i += 5;
+        } else {
+            double ignored;
+            if (!number(ignored)) return false;
+        }
+    }
+}
+
+bool load(const std::string& path, std::vector<Entry>& entries) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "ERROR::RESULTS::STORE_NOT_FOUND::" << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    unsigned int skipped = 0;
+    while (std::getline(file, line)) {
+        if (line.empty())
+            continue;
+
+        std::unordered_map<std::string, std::string> strings;
+        Entry entry;
+        if (!parseLine(line, strings, entry.record.samples, entry.context.dirty)) {
+            skipped++;
+            continue;
+        }
+
+        entry.time = strings["time"];
+        entry.context.commit = strings["commit"];
+        entry.context.buildType = strings["build_type"];
+        entry.context.machine = strings["machine"];
+        entry.context.host = strings["host"];
+        entry.context.cpu = strings["cpu"];
+        entry.context.glRenderer = strings["gl_renderer"];
+        entry.record.suite = strings["suite"];
+        entry.record.name = strings["name"];
+        entry.record.unit = strings["unit"];
+        entries.push_back(std::move(entry));
+    }
+
+    if (skipped > 0)
+        std::cerr << "WARNING::RESULTS::UNREADABLE_LINES::" << skipped << std::endl;
+
+    return true;
+}
+
+}
@@ -0,0 +1,53 @@
+#ifndef RESULTS_H
+#define RESULTS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace renderer::results {
+
+constexpr static const char* DEFAULT_STORE = "bench-results.jsonl";
+
+// what a result was measured on, the same for every record of a run
+struct Context {
+    std::string commit;
+    bool dirty = false;
+    std::string buildType;
+    // hash of the CPU, core count, OS and GL renderer, equal on identical machines
+    std::string machine;
+    std::string host;
+    std::string cpu;
+    std::string glRenderer;
+};
+
+// git from the working directory, GLR_COMMIT overrides it where there is no checkout
+Context context(const std::string& glRenderer);
+// <commit>, or <commit>+dirty when measured from a tree with local changes
+std::string buildId(const Context& context);
+
+// text as a JSON string, quotes included
+std::string quote(const std::string& text);
+
+// one run of one metric, lower is better
+struct Record {
+    std::string suite;
+    std::string name;
+    std::string unit;
+    std::vector<double> samples;
+};
+
+struct Entry {
+    Context context;
+    std::string time;
+    Record record;
+};
+
+// appends a JSON line per record
+bool append(const std::string& path, const Context& context, const std::vector<Record>& records);
+// reads what append() wrote, skipping lines it can't parse
+bool load(const std::string& path, std::vector<Entry>& entries);
+
+}
+
+#endif
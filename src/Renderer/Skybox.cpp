@@ -1,5 +1,6 @@
 #include "Skybox.hpp"
 #include "Renderer.hpp"
+#include "Core/RenderStats.hpp"
 #include "Renderer/Camera.hpp"
 #include "Texture/Texture.hpp"
 #include <stb_image.h>
@@ -90,6 +91,7 @@ void Skybox::draw()
     if (m_SkymapBuffer) m_SkymapBuffer->bind();
 
     glDepthFunc(GL_LEQUAL);
+    RenderStats::countDraw(GL_TRIANGLES, 36);
     glDrawArrays(GL_TRIANGLES, 0, 36);
     glDepthFunc(GL_LESS);
 
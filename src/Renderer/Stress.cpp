@@ -0,0 +1,418 @@
+#include "Stress.hpp"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Core/Shapes/Cube.hpp"
+#include "Core/Shapes/Plane.hpp"
+#include "Core/Shapes/Sphere.hpp"
+#include "Lighting/PBRMaterial.hpp"
+#include "Lighting/PhongMaterial.hpp"
+#include "Lighting/SpotLight.hpp"
+#include "Model/Model.hpp"
+
+namespace renderer::stress {
+
+namespace {
+
+// std distributions differ between standard libraries, the engine doesn't
+class Random {
+    std::mt19937 m_Engine;
+public:
+    Random(unsigned int seed) : m_Engine(seed) {}
+
+    float uniform(float low = 0.f, float high = 1.f) {
+        return low + (high - low) * static_cast<float>(m_Engine() / 4294967296.0);
+    }
+
+    unsigned int below(unsigned int count) {
+        return count > 0 ? m_Engine() % count : 0;
+    }
+
+    float normal() {
+        const float u = std::max(uniform(), 1e-7f);
+        return std::sqrt(-2.f * std::log(u)) * std::cos(2.f * static_cast<float>(PI) * uniform());
+    }
+
+    glm::vec3 color() {
+        glm::vec3 rgb(uniform(), uniform(), uniform());
+        return rgb / std::max(std::max(rgb.r, rgb.g), std::max(rgb.b, 1e-3f));
+    }
+};
+
+struct LightPath {
+    PointLight::Ptr light;
+    glm::vec3 center;
+    float radius;
+    float speed;
+    float phase;
+};
+
+std::vector<LightPath> s_Paths;
+// checker texels, Texture keeps the pointer it was created from
+std::vector<std::vector<uint8_t>> s_Pixels;
+float s_Time = 0.f;
+double s_LastUpdate = 0.0;
+
+const char* layoutName(Layout layout) {
+    switch (layout) {
+        case Layout::Grid: return "grid";
+        case Layout::Clusters: return "clusters";
+        default: return "uniform";
+    }
+}
+
+std::string join(const std::vector<std::string>& values) {
+    std::string result;
+    for (const std::string& value : values)
+        result += (result.empty() ? "" : ",") + value;
+    return result;
+}
+
+// nearest table entry reaching at least range
+Attenuation attenuationFor(float range) {
+    for (const auto& [distance, attenuation] : attenuation_table) {
+        if (distance >= range)
+            return attenuation;
+    }
+    return attenuation_table.back().second;
+}
+
+glm::vec3 pathPosition(const LightPath& path, float time) {
+    const float angle = path.phase + path.speed * time;
+    return path.center + glm::vec3(
+        path.radius * std::cos(angle),
+        path.radius * .1f * std::sin(2.f * angle),
+        path.radius * std::sin(angle)
+    );
+}
+
+Texture::Ptr checkerTexture(Random& random, unsigned int size, bool pbr) {
+    const glm::vec3 a = random.color(), b = random.color() * random.uniform(.2f, .6f);
+    const unsigned int tile = std::max(size / 8, 1u);
+
+    std::vector<uint8_t>& pixels = s_Pixels.emplace_back(size * size * 4);
+    for (unsigned int y = 0; y < size; y++) {
+        for (unsigned int x = 0; x < size; x++) {
+            const glm::vec3& rgb = ((x / tile + y / tile) % 2 == 0) ? a : b;
+            uint8_t* texel = &pixels[(y * size + x) * 4];
+            texel[0] = static_cast<uint8_t>(rgb.r * 255.f);
+            texel[1] = static_cast<uint8_t>(rgb.g * 255.f);
+            texel[2] = static_cast<uint8_t>(rgb.b * 255.f);
+            texel[3] = 255;
+        }
+    }
+
+    TextureConfig tconf;
+    tconf.internal_format = GL_SRGB8_ALPHA8;
+    tconf.data_format = GL_RGBA;
+    tconf.srgb = true;
+
+    Texture::Ptr texture = Texture::New(pixels.data(), size, size,
+        pbr ? TextureType::Albedo : TextureType::Diffuse, tconf);
+
+    texture->bind();
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    return texture;
+}
+
+// model meshes are scaled to a unit radius around their origin
+bool loadModel(const std::string& path, bool pbr, Model::Ptr& model, float& radius) {
+    Model::Import imported = Model::importScene(path, pbr, true);
+    if (!imported.scene || !imported.scene->mRootNode) {
+        std::cerr << "ERROR::STRESS::MODEL_NOT_LOADED::" << path << std::endl;
+        return false;
+    }
+
+    radius = 0.f;
+    for (unsigned int m = 0; m < imported.scene->mNumMeshes; m++) {
+        const aiMesh* mesh = imported.scene->mMeshes[m];
+        for (unsigned int v = 0; v < mesh->mNumVertices; v++) {
+            const aiVector3D& p = mesh->mVertices[v];
+            radius = std::max(radius, glm::length(glm::vec3(p.x, p.y, p.z)));
+        }
+    }
+    radius = std::max(radius, 1e-3f);
+
+    model = Model::New(imported, pbr);
+    return true;
+}
+
+// every shading path stops at NR_MAX_LIGHTS, more would be measured as fewer lights
+bool checkLightCount(const Options& options) {
+    const unsigned int requested = options.pointLights + options.spotLights;
+    if (requested <= NR_MAX_LIGHTS)
+        return true;
+
+    std::cerr << "ERROR::STRESS::TOO_MANY_LIGHTS::" << requested << "::at most " << NR_MAX_LIGHTS << std::endl;
+    return false;
+}
+
+}
+
+bool parse(const std::string& spec, Options& options) {
+    std::istringstream words(spec);
+    std::string word;
+
+    while (words >> word) {
+        const size_t equals = word.find('=');
+        const std::string key = word.substr(0, equals);
+        const std::string value = equals == std::string::npos ? "" : word.substr(equals + 1);
+
+        try {
+            if (key == "seed") options.seed = std::stoul(value);
+            else if (key == "instances") options.instances = std::stoul(value);
+            else if (key == "shapes") {
+                options.shapes.clear();
+                std::istringstream names(value);
+                std::string name;
+                while (std::getline(names, name, ',')) {
+                    if (name != "cube" && name != "sphere" && name != "plane") {
+                        std::cerr << "ERROR::STRESS::UNKNOWN_SHAPE::" << name << std::endl;
+                        return false;
+                    }
+                    options.shapes.push_back(name);
+                }
+            }
+            else if (key == "model") options.models.push_back(value);
+            else if (key == "segments") options.sphereSegments = std::max(3ul, std::stoul(value));
+            else if (key == "materials") options.materials = std::max(1ul, std::stoul(value));
+            else if (key == "textures") options.textures = std::stoul(value);
+            else if (key == "texture_size") options.textureSize = std::max(1ul, std::stoul(value));
+            else if (key == "pbr") options.pbr = std::stoi(value) != 0;
+            else if (key == "layout") {
+                if (value == "grid") options.layout = Layout::Grid;
+                else if (value == "uniform") options.layout = Layout::Uniform;
+                else if (value == "clusters") options.layout = Layout::Clusters;
+                else {
+                    std::cerr << "ERROR::STRESS::UNKNOWN_LAYOUT::" << value << std::endl;
+                    return false;
+                }
+            }
+            else if (key == "clusters") options.clusters = std::max(1ul, std::stoul(value));
+            else if (key == "extent") options.extent = std::stof(value);
+            else if (key == "fill") options.fill = std::stof(value);
+            else if (key == "lights") options.pointLights = std::stoul(value);
+            else if (key == "spot_lights") options.spotLights = std::stoul(value);
+            else if (key == "light_range") options.lightRange = std::stof(value);
+            else if (key == "animate") options.animate = std::stoi(value) != 0;
+            else {
+                std::cerr << "ERROR::STRESS::UNKNOWN_KEY::" << key << std::endl;
+                return false;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "ERROR::STRESS::BAD_VALUE::" << word << std::endl;
+            return false;
+        }
+    }
+
+    if (options.shapes.empty() && options.models.empty()) {
+        std::cerr << "ERROR::STRESS::NOTHING_TO_DRAW" << std::endl;
+        return false;
+    }
+
+    return checkLightCount(options);
+}
+
+std::string describe(const Options& options) {
+    std::ostringstream out;
+    out << "seed=" << options.seed
+        << " instances=" << options.instances
+        << " shapes=" << join(options.shapes);
+    for (const std::string& model : options.models)
+        out << " model=" << model;
+    out << " segments=" << options.sphereSegments
+        << " materials=" << options.materials
+        << " textures=" << options.textures
+        << " texture_size=" << options.textureSize
+        << " pbr=" << options.pbr
+        << " layout=" << layoutName(options.layout);
+    if (options.layout == Layout::Clusters)
+        out << " clusters=" << options.clusters;
+    out << " extent=" << options.extent
+        << " fill=" << options.fill
+        << " lights=" << options.pointLights
+        << " spot_lights=" << options.spotLights
+        << " light_range=" << options.lightRange
+        << " animate=" << options.animate;
+    return out.str();
+}
+
+bool generate(const Options& options) {
+    if (!checkLightCount(options))
+        return false;
+
+    Random random(options.seed);
+
+    s_Paths.clear();
+    s_Time = 0.f;
+    s_LastUpdate = glfwGetTime();
+
+    // what the instances pick from, shapes first
+    std::vector<Mesh::Ptr> shapes;
+    for (const std::string& name : options.shapes) {
+        if (name == "cube") shapes.push_back(Cube::New());
+        else if (name == "sphere") shapes.push_back(Sphere::New(options.sphereSegments, options.sphereSegments));
+        else if (name == "plane") shapes.push_back(Plane::New());
+    }
+
+    std::vector<std::pair<Model::Ptr, float>> models;
+    for (const std::string& path : options.models) {
+        Model::Ptr model;
+        float radius;
+        if (!loadModel(path, options.pbr, model, radius))
+            return false;
+        models.push_back({model, radius});
+    }
+
+    std::vector<Material::Ptr> materials;
+    for (unsigned int i = 0; i < options.materials; i++) {
+        const glm::vec3 color = random.color();
+        if (options.pbr)
+            materials.push_back(PBRMaterial::New(color, random.uniform(.1f, 1.f), random.uniform() < .3f ? 1.f : 0.f, 1.f));
+        else
+            materials.push_back(PhongMaterial::New(color * .1f, color, glm::vec3(.5f), random.uniform(8.f, 128.f)));
+    }
+
+    std::vector<Texture::Ptr> textures;
+    for (unsigned int i = 0; i < options.textures; i++)
+        textures.push_back(checkerTexture(random, options.textureSize, options.pbr));
+
+    // a box 2 extents wide and deep, half an extent high
+    const glm::vec3 box(2.f * options.extent, .5f * options.extent, 2.f * options.extent);
+    const glm::vec3 corner(-options.extent, 0.f, -options.extent);
+    const unsigned int instances = std::max(options.instances, 1u);
+    const float spacing = std::cbrt(box.x * box.y * box.z / instances);
+
+    const unsigned int layers = std::max(1u, static_cast<unsigned int>(std::round(box.y / spacing)));
+    const unsigned int columns = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<float>(instances) / layers)));
+
+    std::vector<glm::vec3> clusterCenters;
+    if (options.layout == Layout::Clusters) {
+        for (unsigned int i = 0; i < options.clusters; i++)
+            clusterCenters.push_back(corner + box * glm::vec3(random.uniform(), random.uniform(), random.uniform()));
+    }
+    const float clusterSpread = options.extent / (2.f * std::cbrt(static_cast<float>(options.clusters)));
+
+    MeshGroup::Ptr shapeGroup = MeshGroup::New();
+    std::vector<MeshGroup::Ptr> groups = {shapeGroup};
+    unsigned int meshes = 0;
+
+    const unsigned int choices = shapes.size() + models.size();
+
+    for (unsigned int i = 0; i < options.instances; i++) {
+        glm::vec3 position;
+        switch (options.layout) {
+            case Layout::Grid: {
+                const unsigned int column = i % columns, row = (i / columns) % columns, layer = i / (columns * columns);
+                position = corner + glm::vec3(
+                    (column + .5f) * box.x / columns,
+                    (layer + .5f) * box.y / layers,
+                    (row + .5f) * box.z / columns);
+                break;
+            }
+            case Layout::Clusters:
+                position = clusterCenters[random.below(clusterCenters.size())]
+                    + clusterSpread * glm::vec3(random.normal(), random.normal() * .25f, random.normal());
+                break;
+            default:
+                position = corner + box * glm::vec3(random.uniform(), random.uniform(), random.uniform());
+                break;
+        }
+
+        const float size = .5f * spacing * options.fill * random.uniform(.75f, 1.25f);
+        const glm::vec3 axis = glm::normalize(glm::vec3(random.uniform(-1.f, 1.f), random.uniform(.1f, 1.f), random.uniform(-1.f, 1.f)));
+
+        glm::mat4 placement = glm::translate(glm::mat4(1.f), position);
+        placement = glm::rotate(placement, random.uniform(0.f, 2.f * static_cast<float>(PI)), axis);
+
+        const unsigned int choice = random.below(choices);
+
+        if (choice < shapes.size()) {
+            Mesh::Ptr mesh = Mesh::New(shapes[choice]);
+            mesh->setModelMatrix(glm::scale(placement, glm::vec3(size)));
+            mesh->setMaterial(materials[random.below(materials.size())]);
+            if (!textures.empty())
+                mesh->addTexture(textures[random.below(textures.size())]);
+
+            shapeGroup->addMesh(mesh);
+            meshes++;
+        } else {
+            const auto& [model, radius] = models[choice - shapes.size()];
+            const glm::mat4 scaled = glm::scale(placement, glm::vec3(size / radius));
+
+            MeshGroup::Ptr group = MeshGroup::New();
+            for (const Mesh::Ptr& source : model->getMeshes()) {
+                Mesh::Ptr mesh = Mesh::New(source);
+                mesh->setModelMatrix(scaled * source->getModelMatrix());
+                group->addMesh(mesh);
+                meshes++;
+            }
+            groups.push_back(group);
+        }
+    }
+
+    Scene::Ptr scene = Scene::New(groups);
+    g_SceneLibrary["stress"] = scene;
+    g_Scenes = {scene};
+
+    const unsigned int lights = options.pointLights + options.spotLights;
+    const Attenuation attenuation = attenuationFor(options.lightRange);
+
+    g_Lights.clear();
+    for (unsigned int i = 0; i < lights; i++) {
+        LightPath path;
+        path.center = corner + box * glm::vec3(random.uniform(), random.uniform(.2f, 1.f), random.uniform());
+        path.radius = options.extent * random.uniform(.1f, .3f);
+        path.speed = random.uniform(.2f, .6f) * (random.uniform() < .5f ? -1.f : 1.f);
+        path.phase = random.uniform(0.f, 2.f * static_cast<float>(PI));
+
+        const glm::vec3 rgb = random.color() * 2.f;
+        const glm::vec3 at = pathPosition(path, 0.f);
+
+        if (i < options.pointLights)
+            path.light = PointLight::New(at, attenuation, rgb * .05f, rgb, rgb);
+        else
+            path.light = SpotLight::New(at, glm::vec3(0.f, -1.f, 0.f), attenuation, rgb, 20.f, 30.f);
+
+        g_Lights.push_back(path.light);
+        if (options.animate)
+            s_Paths.push_back(path);
+    }
+
+    std::cout << "STRESS::" << describe(options) << std::endl;
+    std::cout << "STRESS::" << meshes << " meshes, " << materials.size() << " materials, "
+        << textures.size() << " textures, " << lights << " lights" << std::endl;
+
+    return true;
+}
+
+void update() {
+    if (s_Paths.empty())
+        return;
+
+    const double now = glfwGetTime();
+    s_Time += g_FixedTimestep > 0.f ? g_FixedTimestep : static_cast<float>(now - s_LastUpdate);
+    s_LastUpdate = now;
+
+    for (const LightPath& path : s_Paths)
+        path.light->setPosition(pathPosition(path, s_Time));
+}
+
+void reset() {
+    s_Time = 0.f;
+    s_LastUpdate = glfwGetTime();
+
+    for (const LightPath& path : s_Paths)
+        path.light->setPosition(pathPosition(path, 0.f));
+}
+
+}
@@ -0,0 +1,62 @@
+#ifndef STRESS_H
+#define STRESS_H
+
+#include "Renderer/Renderer.hpp"
+
+#include <string>
+#include <vector>
+
+namespace renderer::stress {
+
+enum class Layout {
+    Grid, Uniform, Clusters
+};
+
+// a synthetic scene, the same seed always builds the same one
+struct Options {
+    unsigned int seed = 1;
+    unsigned int instances = 1000;
+    // built-in shapes the instances pick from, cube, sphere or plane
+    std::vector<std::string> shapes = {"cube", "sphere"};
+    // models the instances also pick from, drawn with their own materials and textures
+    std::vector<std::string> models;
+    unsigned int sphereSegments = 16;
+
+    // materials and checker textures spread over the shape instances, 0 textures leaves them untextured
+    unsigned int materials = 16;
+    unsigned int textures = 8;
+    unsigned int textureSize = 128;
+    bool pbr = true;
+
+    Layout layout = Layout::Uniform;
+    unsigned int clusters = 8;
+    // half width of the box the instances fill, its height is a quarter of the width
+    float extent = 20.f;
+    // instance size over the spacing between instances, above 1 neighbours overlap
+    float fill = 0.5f;
+
+    // at most NR_MAX_LIGHTS together, every shading path stops there
+    unsigned int pointLights = 8;
+    unsigned int spotLights = 0;
+    float lightRange = 32.f;
+    // lights circle their own centers, deterministic under a fixed timestep
+    bool animate = true;
+};
+
+// "instances=10000 shapes=cube,plane model=a.gltf lights=8 layout=clusters ...", false on an unknown key
+// or more lights than NR_MAX_LIGHTS
+bool parse(const std::string& spec, Options& options);
+// the options as parse() reads them, labels benchmark results of the scene
+std::string describe(const Options& options);
+
+// builds the scene into g_SceneLibrary["stress"], draws it instead of g_Scenes and replaces g_Lights
+bool generate(const Options& options);
+
+// moves the generated lights, called once per frame by updateState()
+void update();
+// puts the generated lights back at their start, every measured run sees the same paths
+void reset();
+
+}
+
+#endif
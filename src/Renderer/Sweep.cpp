@@ -0,0 +1,198 @@
+#include "Sweep.hpp"
+#include "Config.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace renderer::sweep {
+
+bool loadAxes(const std::string& path, std::vector<Axis>& axes) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "ERROR::SWEEP::FILE_NOT_FOUND::" << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream words(line.substr(0, line.find('#')));
+
+        Axis axis;
+        if (!(words >> axis.name))
+            continue;
+
+        std::string value;
+        while (words >> value)
+            axis.values.push_back(value);
+
+        if (axis.values.empty()) {
+            std::cerr << "ERROR::SWEEP::AXIS_WITHOUT_VALUES::" << axis.name << std::endl;
+            return false;
+        }
+
+        axes.push_back(axis);
+    }
+
+    return true;
+}
+
+struct Row {
+    std::vector<std::string> values;
+    benchmark::Samples samples;
+    // false when updateState() dropped one of the values
+    bool applied;
+};
+
+static std::string csvField(const std::string& value) {
+    return value.find(',') != std::string::npos ? "\"" + value + "\"" : value;
+}
+
+static void writeCsv(std::ostream& out, const Options& options, const std::vector<Row>& rows) {
+    for (const Axis& axis : options.axes)
+        out << axis.name << ",";
+    out << "frames,cpu_avg_ms,cpu_p50_ms,cpu_p95_ms,cpu_p99_ms,gpu_avg_ms,gpu_p50_ms,gpu_p95_ms,gpu_p99_ms,"
+        << "draw_calls,triangles,applied\n";
+
+    for (const Row& row : rows) {
+        const benchmark::Distribution cpu = benchmark::distribution(row.samples.cpuMs);
+        const benchmark::Distribution gpu = benchmark::distribution(row.samples.gpuMs);
+        const double frames = std::max(row.samples.frames, 1u);
+
+        for (const std::string& value : row.values)
+            out << csvField(value) << ",";
+        out << row.samples.frames << ","
+            << cpu.avg << "," << cpu.p50 << "," << cpu.p95 << "," << cpu.p99 << ","
+            << gpu.avg << "," << gpu.p50 << "," << gpu.p95 << "," << gpu.p99 << ","
+            << row.samples.totals.drawCalls / frames << ","
+            << row.samples.totals.triangles / frames << ","
+            << (row.applied ? 1 : 0) << "\n";
+    }
+}
+
+static void writeJson(std::ostream& out, const Options& options, const std::vector<Row>& rows) {
+    out << "{\n";
+    out << "  \"source\": " << results::quote(options.benchmark.source.empty() ? "default" : options.benchmark.source) << ",\n";
+    out << "  \"scene\": " << results::quote(options.benchmark.scene.empty() ? "default" : options.benchmark.scene) << ",\n";
+    out << "  \"frames\": " << options.benchmark.frames << ",\n";
+    out << "  \"warmup\": " << options.benchmark.warmup << ",\n";
+    out << "  \"resolution\": [" << g_Engine.SCREEN_WIDTH << ", " << g_Engine.SCREEN_HEIGHT << "],\n";
+    out << "  \"gl_renderer\": \"" << benchmark::glString(GL_RENDERER) << "\",\n";
+    out << "  \"results\": [";
+
+    for (size_t r = 0; r < rows.size(); r++) {
+        const Row& row = rows[r];
+        const double frames = std::max(row.samples.frames, 1u);
+
+        out << (r > 0 ? ",\n" : "\n") << "    {\"state\": {";
+        for (size_t a = 0; a < options.axes.size(); a++)
+            out << (a > 0 ? ", " : "") << results::quote(options.axes[a].name) << ": " << results::quote(row.values[a]);
+        out << "},\n";
+
+        out << "     \"cpu_ms\": "; benchmark::writeDistribution(out, row.samples.cpuMs); out << ",\n";
+        out << "     \"gpu_ms\": "; benchmark::writeDistribution(out, row.samples.gpuMs); out << ",\n";
+        out << "     \"draw_calls\": " << row.samples.totals.drawCalls / frames
+            << ", \"triangles\": " << row.samples.totals.triangles / frames
+            << ", \"applied\": " << (row.applied ? "true" : "false") << "}";
+    }
+
+    out << "\n  ]\n";
+    out << "}\n";
+}
+
+int run(const Options& options) {
+    if (options.benchmark.source.ends_with(".session")) {
+        std::cerr << "ERROR::SWEEP::SESSIONS_SET_THEIR_OWN_STATE::" << options.benchmark.source << std::endl;
+        return -1;
+    }
+
+    // a typo should fail before the first combination, not hours into the sweep
+    size_t combinations = 1;
+    for (const Axis& axis : options.axes) {
+        EngineState scratch = ENGINE_STATE;
+        for (const std::string& value : axis.values) {
+            if (!config::set(scratch, axis.name, value))
+                return -1;
+        }
+        combinations *= axis.values.size();
+    }
+
+    const EngineState base = ENGINE_STATE;
+    const results::Context context = results::context(benchmark::glString(GL_RENDERER));
+    const std::string suite = options.benchmark.scene.empty() ? "sweep" : "sweep [" + options.benchmark.scene + "]";
+    std::vector<Row> rows;
+
+    for (size_t combination = 0; combination < combinations; combination++) {
+        Row row;
+        ENGINE_STATE = base;
+
+        // the last axis changes fastest
+        size_t rest = combination;
+        row.values.resize(options.axes.size());
+        for (size_t a = options.axes.size(); a-- > 0;) {
+            const Axis& axis = options.axes[a];
+            row.values[a] = axis.values[rest % axis.values.size()];
+            rest /= axis.values.size();
+        }
+
+        std::cout << "SWEEP::" << combination + 1 << "/" << combinations << "::";
+        for (size_t a = 0; a < options.axes.size(); a++) {
+            config::set(ENGINE_STATE, options.axes[a].name, row.values[a]);
+            std::cout << (a > 0 ? " " : "") << options.axes[a].name << "=" << row.values[a];
+        }
+        std::cout << std::endl;
+
+        const EngineState requested = ENGINE_STATE;
+
+        if (!benchmark::measure(options.benchmark, row.samples)) {
+            ENGINE_STATE = base;
+            return -1;
+        }
+
+        // updateState() only applies what it knows to change at runtime
+        row.applied = true;
+        for (const Axis& axis : options.axes) {
+            std::string wanted, used;
+            config::get(requested, axis.name, wanted);
+            config::get(g_Engine, axis.name, used);
+
+            if (wanted != used) {
+                std::cerr << "WARNING::SWEEP::NOT_APPLIED::" << axis.name << "::" << wanted << "::" << used << std::endl;
+                row.applied = false;
+            }
+        }
+
+        if (!options.benchmark.store.empty()) {
+            std::string combination_name;
+            for (size_t a = 0; a < options.axes.size(); a++)
+                combination_name += " " + options.axes[a].name + "=" + row.values[a];
+
+            results::append(options.benchmark.store, context, {
+                {suite, "cpu_ms" + combination_name, "ms", row.samples.cpuMs},
+                {suite, "gpu_ms" + combination_name, "ms", row.samples.gpuMs},
+            });
+        }
+
+        rows.push_back(std::move(row));
+    }
+
+    ENGINE_STATE = base;
+
+    std::ofstream out(options.report);
+    if (!out) {
+        std::cerr << "ERROR::SWEEP::REPORT_NOT_WRITTEN::" << options.report << std::endl;
+        return -1;
+    }
+
+    out << std::fixed << std::setprecision(4);
+    if (options.report.ends_with(".csv"))
+        writeCsv(out, options, rows);
+    else
+        writeJson(out, options, rows);
+
+    std::cout << "SWEEP::" << rows.size() << " combinations, report " << options.report << std::endl;
+
+    return out.good() ? 0 : -1;
+}
+
+}
@@ -0,0 +1,33 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include "Renderer/Benchmark.hpp"
+
+#include <string>
+#include <vector>
+
+namespace renderer::sweep {
+
+// an EngineState field and the values it takes, in config::set() syntax
+struct Axis {
+    std::string name;
+    std::vector<std::string> values;
+};
+
+// one "NAME value value ..." per line, # starts a comment
+bool loadAxes(const std::string& path, std::vector<Axis>& axes);
+
+struct Options {
+    std::vector<Axis> axes;
+    // camera path, frames and warmup of every combination, sessions would override the state
+    benchmark::Options benchmark;
+    // a row per combination, CSV when the name ends in .csv, JSON otherwise
+    std::string report = "sweep.csv";
+};
+
+// benchmarks every combination of the axis values on top of ENGINE_STATE, 0 on success
+int run(const Options& options);
+
+}
+
+#endif
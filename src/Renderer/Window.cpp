@@ -1,14 +1,27 @@
 #include "Window.hpp"
 #include "Callbacks.hpp"
+#include "Core/NullGL.hpp"
 
 #include <iostream>
 
+static bool _Headless = false;
 
-int window::init()
+int window::init(bool headless, unsigned int width, unsigned int height, bool null_gl)
 {
+    headless = headless || null_gl;
+    _Headless = headless;
+
     // glfw: initialize and configure
     // ------------------------------
-    glfwInit();
+    if (headless)
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+
+    if (!glfwInit())
+    {
+        std::cout << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
@@ -20,7 +33,28 @@ int window::init()
 
     // glfw window creation
     // --------------------
-    _Window = glfwCreateWindow(window::WINDOW_WIDTH, window::WINDOW_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (null_gl)
+    {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+        _Window = glfwCreateWindow(width, height, "LearnOpenGL", NULL, NULL);
+    }
+    else if (headless)
+    {
+        // Mesa's surfaceless EGL first, llvmpipe through OSMesa otherwise
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+        _Window = glfwCreateWindow(width, height, "LearnOpenGL", NULL, NULL);
+
+        if (_Window == NULL)
+        {
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+            _Window = glfwCreateWindow(width, height, "LearnOpenGL", NULL, NULL);
+        }
+    }
+    else
+        _Window = glfwCreateWindow(width, height, "LearnOpenGL", NULL, NULL);
+
     if (_Window == NULL)
     {
         std::cout << "Failed to create GLFW window" << std::endl;
@@ -30,11 +64,17 @@ int window::init()
 
     using namespace window;
 
-    glfwMakeContextCurrent(_Window);
-    glfwSetFramebufferSizeCallback(_Window, callback::framebuffer_size_callback);
+    if (null_gl)
+    {
+        if (!gladLoadGLLoader((GLADloadproc)NullGL::getProcAddress))
+        {
+            std::cout << "Failed to load the null GL backend" << std::endl;
+            return -1;
+        }
+        return 0;
+    }
 
-    glfwSetCursorPosCallback(_Window, callback::mouse_callback);
-    glfwSetScrollCallback(_Window, callback::scroll_callback);
+    glfwMakeContextCurrent(_Window);
 
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
     {
@@ -42,6 +82,14 @@ int window::init()
         return -1;
     }
 
+    if (headless)
+        return 0;
+
+    glfwSetFramebufferSizeCallback(_Window, callback::framebuffer_size_callback);
+
+    glfwSetCursorPosCallback(_Window, callback::mouse_callback);
+    glfwSetScrollCallback(_Window, callback::scroll_callback);
+
     GUI::setup(_Window);
 
     return 0;
@@ -64,6 +112,10 @@ void window::handle_input() {
 }
 
 
+double window::get_delta_frame() {
+    return delta_frame;
+}
+
 void window::render_gui() {
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
@@ -82,9 +134,11 @@ void window::swap_and_poll() {
 
 
 void window::terminate() {
-    ImGui_ImplOpenGL3_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
-    ImGui::DestroyContext();
+    if (!_Headless) {
+        ImGui_ImplOpenGL3_Shutdown();
+        ImGui_ImplGlfw_Shutdown();
+        ImGui::DestroyContext();
+    }
 
     glfwTerminate();
 }
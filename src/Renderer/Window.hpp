@@ -16,11 +16,21 @@ static GLFWwindow* _Window;
 static double delta_frame;
 static double last_frame = 0;
 
-int init();
+// headless creates an invisible surfaceless context on the null platform,
+// through EGL or OSMesa, and skips the input callbacks and the GUI.
+// null_gl implies headless and loads NullGL instead of any context
+int init(
+    bool headless = false,
+    unsigned int width = WINDOW_WIDTH,
+    unsigned int height = WINDOW_HEIGHT,
+    bool null_gl = false
+);
 void resize_window(int width, int height);
 bool should_terminate();
 void poll_glfw();
 void handle_input();
+// seconds the last handle_input() measured since the one before
+double get_delta_frame();
 void render_gui();
 void swap_and_poll();
 void terminate();
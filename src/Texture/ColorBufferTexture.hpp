@@ -6,7 +6,7 @@
 #include "Util/Ptr.hpp"
 
 class ColorBufferTexture : public Texture {
-    MAKE_MOVE_ONLY(ColorBufferTexture)
+    MAKE_NON_MOVABLE(ColorBufferTexture)
     GENERATE_PTR(ColorBufferTexture)
 public:
     static inline TextureConfig defaultConfig() {
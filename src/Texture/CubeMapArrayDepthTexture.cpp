@@ -0,0 +1,52 @@
+#include "CubeMapArrayDepthTexture.hpp"
+#include "Core/RenderStats.hpp"
+
+CubeMapArrayDepthTexture::CubeMapArrayDepthTexture(
+    unsigned int size,
+    unsigned int layers
+) :
+    Texture(TextureType::DepthAttach, TextureConfig()),
+    m_Layers{layers}
+{
+    m_Width = m_Height = size;
+
+    genTexture();
+}
+
+void CubeMapArrayDepthTexture::genTexture() {
+    bind();
+
+    glTexImage3D(GL_TEXTURE_CUBE_MAP_ARRAY, 0, GL_DEPTH_COMPONENT24, m_Width, m_Height, m_Layers * 6, 0,
+                 GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+
+    // linear filtering on a comparison sampler gives 2x2 PCF for free
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+    unbind();
+}
+
+void CubeMapArrayDepthTexture::resize(unsigned int size, unsigned int layers) {
+    m_Width = m_Height = size;
+    m_Layers = layers;
+
+    genTexture();
+}
+
+void CubeMapArrayDepthTexture::bind() const {
+    RenderStats::s_Current.textureBinds++;
+    glActiveTexture(GL_TEXTURE0 + m_Slot);
+    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, m_TextureID);
+}
+
+void CubeMapArrayDepthTexture::unbind() const {
+    glActiveTexture(GL_TEXTURE0 + m_Slot);
+    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, 0);
+}
@@ -0,0 +1,29 @@
+#ifndef CUBEMAP_ARRAY_DEPTH_TEXTURE_H
+#define CUBEMAP_ARRAY_DEPTH_TEXTURE_H
+
+#include "Texture.hpp"
+#include "Util/MoveOnly.hpp"
+#include "Util/Ptr.hpp"
+
+// Depth cube maps in one array, layer * 6 + face addresses a single face.
+// Compares against the reference value, so it samples as samplerCubeArrayShadow.
+class CubeMapArrayDepthTexture : public Texture {
+    MAKE_NON_MOVABLE(CubeMapArrayDepthTexture)
+    GENERATE_PTR(CubeMapArrayDepthTexture)
+private:
+    unsigned int m_Layers;
+public:
+
+    CubeMapArrayDepthTexture(unsigned int size, unsigned int layers);
+
+    void resize(unsigned int size, unsigned int layers);
+
+    inline unsigned int getLayers() const { return m_Layers; }
+
+    virtual void genTexture() override;
+
+    void bind() const override;
+    void unbind() const override;
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "CubeMapBufferTexture.hpp"
+#include "Core/RenderStats.hpp"
 
 CubeMapBufferTexture::CubeMapBufferTexture(
     unsigned int width,
@@ -41,6 +42,7 @@ void CubeMapBufferTexture::genTexture()
 }
 
 void CubeMapBufferTexture::bind() const {
+    RenderStats::s_Current.textureBinds++;
     glActiveTexture(GL_TEXTURE0 + m_Slot);
     glBindTexture(GL_TEXTURE_CUBE_MAP, m_TextureID);
 }
@@ -6,7 +6,7 @@
 #include "Util/MoveOnly.hpp"
 
 class CubeMapBufferTexture : public Texture {
-    MAKE_MOVE_ONLY(CubeMapBufferTexture)
+    MAKE_NON_MOVABLE(CubeMapBufferTexture)
     GENERATE_PTR(CubeMapBufferTexture)
 public:
     static inline TextureConfig defaultConfig() {
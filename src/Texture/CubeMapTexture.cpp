@@ -1,4 +1,5 @@
 #include "CubeMapTexture.hpp"
+#include "Core/RenderStats.hpp"
 
 #include <stb_image.h>
 #include "Texture/Texture.hpp"
@@ -11,7 +12,7 @@ CubeMapTexture::CubeMapTexture(const std::array<std::string, 6>& faces, TextureC
 
 void CubeMapTexture::genTexture() {
 
-    stbi_set_flip_vertically_on_load(m_Config.flip);
+    stbi_set_flip_vertically_on_load_thread(m_Config.flip);
 
     bind();
 
@@ -50,6 +51,7 @@ void CubeMapTexture::genTexture() {
 }
 
 void CubeMapTexture::bind() const {
+    RenderStats::s_Current.textureBinds++;
     glActiveTexture(GL_TEXTURE0 + m_Slot);
     glBindTexture(GL_TEXTURE_CUBE_MAP, m_TextureID);
 }
@@ -11,7 +11,7 @@
 
 
 class CubeMapTexture : public Texture {
-    MAKE_MOVE_ONLY(CubeMapTexture)
+    MAKE_NON_MOVABLE(CubeMapTexture)
     GENERATE_PTR(CubeMapTexture)
 
 private:
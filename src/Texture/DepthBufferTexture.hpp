@@ -6,7 +6,7 @@
 #include "Util/Ptr.hpp"
 
 class DepthBufferTexture : public Texture {
-    MAKE_MOVE_ONLY(DepthBufferTexture)
+    MAKE_NON_MOVABLE(DepthBufferTexture)
     GENERATE_PTR(DepthBufferTexture)
 public:
 
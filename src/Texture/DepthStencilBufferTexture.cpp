@@ -0,0 +1,35 @@
+#include "DepthStencilBufferTexture.hpp"
+
+DepthStencilBufferTexture::DepthStencilBufferTexture(
+    unsigned int width,
+    unsigned int height
+) :
+    Texture(TextureType::DepthAttach, TextureConfig())
+{
+    m_Width = width;
+    m_Height = height;
+
+    genTexture();
+}
+
+void DepthStencilBufferTexture::genTexture() {
+    bind();
+
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, m_Width, m_Height, 0,
+                 GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    unbind();
+}
+
+void DepthStencilBufferTexture::resize(unsigned int width, unsigned int height) {
+    m_Width = width;
+    m_Height = height;
+
+    genTexture();
+}
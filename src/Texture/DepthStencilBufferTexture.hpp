@@ -0,0 +1,22 @@
+#ifndef DEPTHSTENCILBUFFER_TEXTURE_H
+#define DEPTHSTENCILBUFFER_TEXTURE_H
+
+#include "Texture.hpp"
+#include "Util/MoveOnly.hpp"
+#include "Util/Ptr.hpp"
+
+// Sampleable depth/stencil attachment, used where later passes need to
+// read scene depth (e.g. reconstructing positions from the G-Buffer)
+class DepthStencilBufferTexture : public Texture {
+    MAKE_NON_MOVABLE(DepthStencilBufferTexture)
+    GENERATE_PTR(DepthStencilBufferTexture)
+public:
+
+    DepthStencilBufferTexture(unsigned int width, unsigned int height);
+
+    void resize(unsigned int width, unsigned int height);
+
+    virtual void genTexture() override;
+};
+
+#endif
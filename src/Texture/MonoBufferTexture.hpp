@@ -7,7 +7,7 @@
 #include "Util/MoveOnly.hpp"
 
 class MonoBufferTexture : public Texture {
-    MAKE_MOVE_ONLY(MonoBufferTexture)
+    MAKE_NON_MOVABLE(MonoBufferTexture)
     GENERATE_PTR(MonoBufferTexture)
 
 public:
@@ -1,12 +1,13 @@
 #ifndef MULTISAMPLE_TEXTURE
 #define MULTISAMPLE_TEXTURE
 
+#include "Core/RenderStats.hpp"
 #include "Texture/Texture.hpp"
 #include "Util/MoveOnly.hpp"
 #include "Util/Ptr.hpp"
 
 class MultisampleTexture : public Texture {
-    MAKE_MOVE_ONLY(MultisampleTexture)
+    MAKE_NON_MOVABLE(MultisampleTexture)
     GENERATE_PTR(MultisampleTexture)
 public:
     MultisampleTexture(unsigned int width, unsigned int height);
@@ -16,6 +17,7 @@ public:
 
     inline void bind() const override {
         // Multisample does not need slot access
+        RenderStats::s_Current.textureBinds++;
         glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, m_TextureID);
     }
 
@@ -1,11 +1,18 @@
 #include "Texture.hpp"
 #include <stb_image.h>
 
+#include "Core/RenderStats.hpp"
 #include "Core/Shader/Shader.hpp"
+#include "Core/Trace.hpp"
 #include "Model/Model.hpp"
 #include "Renderer/Camera.hpp"
 #include "Renderer/Renderer.hpp"
 
+#include <filesystem>
+
+
+std::mutex Texture::s_PrefetchMutex;
+std::unordered_map<std::string, std::shared_future<Texture::DecodedImage>> Texture::s_Prefetched;
 
 GLenum Texture::getInternalFormat(int nrComponents, bool srgb) {
     switch (nrComponents) {
@@ -62,6 +69,10 @@ Texture::Texture(const std::string& path, TextureType type, TextureConfig tconf)
     genTexture();
 }
 
+Texture::~Texture() {
+    glDeleteTextures(1, &m_TextureID);
+}
+
 void Texture::genTexture() {
     if (!m_Path.empty())
         genFromFile();
@@ -87,17 +98,71 @@ void Texture::genFromPixels() {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, m_Config.wrap_t);
 }
 
-void Texture::genFromFile() {
-    stbi_set_flip_vertically_on_load(m_Config.flip);
+std::string Texture::prefetchKey(const std::string& path, const TextureConfig& tconf) {
+    return path + (tconf.flip ? "|flip" : "") + (tconf.hdr ? "|hdr" : "");
+}
+
+Texture::DecodedImage Texture::decode(const std::string& path, const TextureConfig& tconf) {
+    Trace::Zone zone("Decode " + std::filesystem::path(path).filename().string());
+
+    // the thread variant, workers may decode with different flips at once
+    stbi_set_flip_vertically_on_load_thread(tconf.flip);
 
-    int nrComponents;
-    unsigned char* dataC = nullptr;
-    float* dataF = nullptr;
+    DecodedImage image;
 
-    if (m_Config.hdr)
-        dataF = stbi_loadf(m_Path.c_str(), (int*)&m_Width, (int*)&m_Height, &nrComponents, 0);
+    if (tconf.hdr)
+        image.dataF = stbi_loadf(path.c_str(), &image.width, &image.height, &image.components, 0);
     else
-        dataC = stbi_load(m_Path.c_str(), (int*)&m_Width, (int*)&m_Height, &nrComponents, 0);
+        image.dataC = stbi_load(path.c_str(), &image.width, &image.height, &image.components, 0);
+
+    return image;
+}
+
+void Texture::prefetch(const std::string& path, const TextureConfig& tconf) {
+    const std::string key = prefetchKey(path, tconf);
+
+    std::promise<DecodedImage> promise;
+    {
+        std::lock_guard<std::mutex> lock(s_PrefetchMutex);
+        if (s_Prefetched.contains(key)) return;
+        s_Prefetched.emplace(key, promise.get_future().share());
+    }
+
+    promise.set_value(decode(path, tconf));
+}
+
+void Texture::clearPrefetched() {
+    std::lock_guard<std::mutex> lock(s_PrefetchMutex);
+
+    for (auto& [key, future] : s_Prefetched) {
+        DecodedImage image = future.get();
+        if (image.dataC) stbi_image_free(image.dataC);
+        if (image.dataF) stbi_image_free(image.dataF);
+    }
+
+    s_Prefetched.clear();
+}
+
+void Texture::genFromFile() {
+    std::shared_future<DecodedImage> prefetched;
+    {
+        std::lock_guard<std::mutex> lock(s_PrefetchMutex);
+
+        auto found = s_Prefetched.find(prefetchKey(m_Path, m_Config));
+        if (found != s_Prefetched.end()) {
+            prefetched = found->second;
+            s_Prefetched.erase(found);
+        }
+    }
+
+    const DecodedImage image = prefetched.valid() ? prefetched.get() : decode(m_Path, m_Config);
+
+    int nrComponents = image.components;
+    unsigned char* dataC = image.dataC;
+    float* dataF = image.dataF;
+
+    m_Width = image.width;
+    m_Height = image.height;
 
     if (dataC || dataF)
     {
@@ -160,6 +225,7 @@ void Texture::genFromFile() {
 }
 
 void Texture::bind() const {
+    RenderStats::s_Current.textureBinds++;
     glActiveTexture(GL_TEXTURE0 + m_Slot);
     glBindTexture(GL_TEXTURE_2D, m_TextureID);
 }
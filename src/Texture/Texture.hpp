@@ -7,7 +7,10 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include <future>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 
 struct TextureConfig {
@@ -76,14 +79,27 @@ enum class TextureType {
 };
 
 class Texture {
-    MAKE_MOVE_ONLY(Texture)
+    MAKE_NON_MOVABLE(Texture)
     GENERATE_PTR(Texture)
 
 private:
+    // file contents as stb_image returns them
+    struct DecodedImage {
+        int width = 0, height = 0, components = 0;
+        unsigned char* dataC = nullptr;
+        float* dataF = nullptr;
+    };
+
+    static std::mutex s_PrefetchMutex;
+    static std::unordered_map<std::string, std::shared_future<DecodedImage>> s_Prefetched;
+
+    static std::string prefetchKey(const std::string& path, const TextureConfig& tconf);
+    static DecodedImage decode(const std::string& path, const TextureConfig& tconf);
+
     const void* m_Pixels;
 protected:
     unsigned int m_Width, m_Height;
-    unsigned int m_Slot;
+    unsigned int m_Slot = 0;
     unsigned int m_TextureID;
 
     TextureType m_Type;
@@ -113,9 +129,17 @@ public:
         TextureConfig tconf = TextureConfig()
     );
 
+    virtual ~Texture();
+
     void genFromFile();
     void genFromPixels();
 
+    // Decodes the file on the calling thread, a later Texture of the same
+    // path and config only uploads it. Safe to call from worker threads.
+    static void prefetch(const std::string& path, const TextureConfig& tconf = TextureConfig());
+    // frees what was prefetched but never used
+    static void clearPrefetched();
+
     virtual void bind() const;
     virtual void unbind() const;
 
@@ -123,6 +147,9 @@ public:
 
     inline const std::string& getPath() const { return m_Path; }
 
+    inline unsigned int getWidth() const { return m_Width; }
+    inline unsigned int getHeight() const { return m_Height; }
+
     inline void setSlot(unsigned int slot) { m_Slot = slot; }
     inline unsigned int getSlot() const {return m_Slot;}
 
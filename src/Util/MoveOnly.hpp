@@ -7,4 +7,11 @@
                                 clazz(clazz&&) noexcept = default; \
                                 clazz& operator=(clazz&&) noexcept = default;
 
+// owners of a GL name or file descriptor, a moved-from copy would release it again
+#define MAKE_NON_MOVABLE(clazz) public: \
+                                clazz(const clazz&) = delete; \
+                                clazz& operator=(const clazz&) = delete; \
+                                clazz(clazz&&) = delete; \
+                                clazz& operator=(clazz&&) = delete;
+
 #endif
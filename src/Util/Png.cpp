@@ -0,0 +1,107 @@
+#include "Png.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+
+static uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+{
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t {};
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++)
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+        return t;
+    }();
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void putU32(std::vector<uint8_t>& out, uint32_t value)
+{
+    out.push_back(value >> 24);
+    out.push_back(value >> 16);
+    out.push_back(value >> 8);
+    out.push_back(value);
+}
+
+static void writeChunk(std::ofstream& file, const char* type, const std::vector<uint8_t>& data)
+{
+    std::vector<uint8_t> chunk;
+    putU32(chunk, data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    putU32(chunk, crc32(chunk.data() + 4, chunk.size() - 4));
+
+    file.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+}
+
+bool png::write(
+    const std::string& path,
+    unsigned int width,
+    unsigned int height,
+    unsigned int channels,
+    const std::vector<uint8_t>& pixels
+) {
+    constexpr uint8_t COLOR_TYPES[] = {0, 0, 4, 2, 6};
+    constexpr size_t MAX_STORED_BLOCK = 65535;
+
+    if (channels < 1 || channels > 4 || pixels.size() < size_t(width) * height * channels)
+        return false;
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    const uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+    std::vector<uint8_t> header;
+    putU32(header, width);
+    putU32(header, height);
+    header.insert(header.end(), {8, COLOR_TYPES[channels], 0, 0, 0});
+    writeChunk(file, "IHDR", header);
+
+    // every row starts with filter type 0
+    const size_t stride = size_t(width) * channels;
+    std::vector<uint8_t> raw;
+    raw.reserve((stride + 1) * height);
+    for (unsigned int y = 0; y < height; y++) {
+        raw.push_back(0);
+        raw.insert(raw.end(), pixels.begin() + y * stride, pixels.begin() + (y + 1) * stride);
+    }
+
+    // zlib stream made of stored deflate blocks
+    std::vector<uint8_t> data = {0x78, 0x01};
+    for (size_t offset = 0; offset < raw.size() || offset == 0; offset += MAX_STORED_BLOCK) {
+        const size_t size = std::min(MAX_STORED_BLOCK, raw.size() - offset);
+        const bool last = offset + size >= raw.size();
+
+        data.push_back(last ? 1 : 0);
+        data.push_back(size & 0xFF);
+        data.push_back(size >> 8);
+        data.push_back(~size & 0xFF);
+        data.push_back((~size >> 8) & 0xFF);
+        data.insert(data.end(), raw.begin() + offset, raw.begin() + offset + size);
+
+        if (last) break;
+    }
+
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : raw) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    putU32(data, (b << 16) | a);
+
+    writeChunk(file, "IDAT", data);
+    writeChunk(file, "IEND", {});
+
+    return file.good();
+}
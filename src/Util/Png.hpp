@@ -0,0 +1,21 @@
+#ifndef PNG_H
+#define PNG_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace png
+{
+// 8 bit gray, gray alpha, RGB or RGBA rows, top row first. The image data is
+// stored uncompressed, so no zlib is needed to write it.
+bool write(
+    const std::string& path,
+    unsigned int width,
+    unsigned int height,
+    unsigned int channels,
+    const std::vector<uint8_t>& pixels
+);
+}
+
+#endif
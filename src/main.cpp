@@ -1,34 +1,302 @@
+#include <algorithm>
 #include <iostream>
+#include <string>
+#include <vector>
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
+#include "Core/Capture.hpp"
+#include "Core/NullGL.hpp"
+#include "Core/Trace.hpp"
+#include "Renderer/Benchmark.hpp"
+#include "Renderer/Config.hpp"
+#include "Renderer/Golden.hpp"
+#include "Renderer/Stress.hpp"
+#include "Renderer/Sweep.hpp"
 #include "Renderer/Window.hpp"
 #include "Renderer/Renderer.hpp"
 
-int main()
+// --headless renders --frames N at --size WxH without a window and writes
+// them to --output, one file per frame if it holds a %d, else the last.
+// Nothing is written without an output
+static int run_headless(unsigned int frames, const std::string& output)
 {
-    if (window::init() != 0) {
+    // the frame number replaces a single %d, the path is never used as a format
+    const size_t frame_token = output.find("%d");
+    const bool per_frame = frame_token != std::string::npos;
+
+    if (output.find('%', per_frame ? frame_token + 2 : 0) != std::string::npos
+        || (per_frame && output.find('%') != frame_token)) {
+        std::cerr << "ERROR::HEADLESS::OUTPUT_PATTERN::" << output << "::only a single %d is allowed" << std::endl;
+        return -1;
+    }
+
+    for (unsigned int frame = 0; frame < frames; frame++)
+    {
+        {
+            Trace::Zone zone("Update State");
+            renderer::updateState();
+        }
+
+        renderer::render();
+
+        if (output.empty() || (!per_frame && frame + 1 < frames))
+            continue;
+
+        std::string path = output;
+        if (per_frame)
+            path.replace(frame_token, 2, std::to_string(frame));
+
+        Trace::Zone zone("Save Frame");
+        if (!renderer::saveFrame(path)) {
+            std::cerr << "Could not write " << path << std::endl;
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    std::string trace_path;
+    bool headless = false;
+    unsigned int frames = 1;
+    unsigned int width = window::WINDOW_WIDTH, height = window::WINDOW_HEIGHT;
+    std::string output = "frame.png";
+    bool output_set = false;
+
+    // --null-gl runs headless on NullGL and writes the GL calls per frame to gl-calls.json
+    bool null_gl = false;
+    const std::string gl_calls_path = "gl-calls.json";
+
+    // --benchmark <path file, .session or "default"> replays a camera path with a fixed timestep
+    bool benchmark = false;
+    bool frames_set = false;
+    renderer::benchmark::Options benchmark_options;
+    // --repeat N runs the benchmark N times, --store <file> or --no-store picks where the runs are kept
+    // for GLBenchCompare
+    // --record <file.session> keeps the camera and engine state of every frame for replays
+    std::string record_path;
+    // --golden <dir> compares the canonical views against <dir>/<view>.png, --golden-update rewrites them
+    bool golden = false;
+    renderer::golden::Options golden_options;
+    std::string report_path;
+    int warmup = -1;
+    // --capture <file> records the GL calls from startup through --capture-frames N, for GLReplay
+    std::string capture_path;
+    unsigned int capture_frames = 10;
+    // --config <file> and --set NAME=value set EngineState fields, in the order given
+    std::vector<std::pair<bool, std::string>> config_steps;
+    // --sweep <file> benchmarks every combination of the values listed per field
+    bool sweep = false;
+    renderer::sweep::Options sweep_options;
+    // --stress "<key=value ...>" draws a generated scene instead of the startup one, see stress::parse()
+    bool stress = false;
+    renderer::stress::Options stress_options;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        // --trace <file> writes the last frames as Chrome trace JSON on exit
+        if (arg == "--trace" && has_value)
+            trace_path = argv[++i];
+        else if (arg == "--headless")
+            headless = true;
+        else if (arg == "--null-gl")
+            headless = null_gl = true;
+        else if (arg == "--frames" && has_value) {
+            frames = std::stoul(argv[++i]);
+            frames_set = true;
+        }
+        else if (arg == "--benchmark" && has_value) {
+            benchmark = true;
+            benchmark_options.source = argv[++i];
+            if (benchmark_options.source == "default")
+                benchmark_options.source.clear();
+        }
+        else if (arg == "--golden" && has_value) {
+            golden = true;
+            golden_options.directory = argv[++i];
+        }
+        else if (arg == "--golden-update")
+            golden_options.update = true;
+        else if (arg == "--golden-filter" && has_value)
+            golden_options.filter = argv[++i];
+        else if (arg == "--warmup" && has_value)
+            warmup = std::stoi(argv[++i]);
+        else if (arg == "--report" && has_value)
+            report_path = argv[++i];
+        else if (arg == "--repeat" && has_value)
+            benchmark_options.repeat = std::max(1ul, std::stoul(argv[++i]));
+        else if (arg == "--store" && has_value)
+            benchmark_options.store = argv[++i];
+        else if (arg == "--no-store")
+            benchmark_options.store.clear();
+        else if (arg == "--record" && has_value)
+            record_path = argv[++i];
+        else if (arg == "--capture" && has_value)
+            capture_path = argv[++i];
+        else if (arg == "--capture-frames" && has_value)
+            capture_frames = std::stoul(argv[++i]);
+        else if (arg == "--config" && has_value)
+            config_steps.push_back({true, argv[++i]});
+        else if (arg == "--set" && has_value)
+            config_steps.push_back({false, argv[++i]});
+        else if (arg == "--sweep" && has_value) {
+            sweep = true;
+            if (!renderer::sweep::loadAxes(argv[++i], sweep_options.axes))
+                return -1;
+        }
+        else if (arg == "--stress" && has_value) {
+            stress = true;
+            if (!renderer::stress::parse(argv[++i], stress_options))
+                return -1;
+        }
+        else if (arg == "--output" && has_value) {
+            output = argv[++i];
+            output_set = true;
+        }
+        else if (arg == "--size" && has_value && std::sscanf(argv[i + 1], "%ux%u", &width, &height) == 2)
+            i++;
+        else
+            std::cerr << "Ignoring argument " << arg << std::endl;
+    }
+
+    Trace::nameThread("Main");
+
+    // null frames are all black, only save them when asked to
+    if (null_gl && !output_set)
+        output.clear();
+
+    renderer::ENGINE_STATE.RENDER_WIDTH = renderer::ENGINE_STATE.SCREEN_WIDTH = width;
+    renderer::ENGINE_STATE.RENDER_HEIGHT = renderer::ENGINE_STATE.SCREEN_HEIGHT = height;
+
+    for (const auto& [file, step] : config_steps) {
+        const bool valid = file
+            ? renderer::config::load(renderer::ENGINE_STATE, step)
+            : renderer::config::assign(renderer::ENGINE_STATE, step);
+        if (!valid)
+            return -1;
+    }
+
+    // the window follows a configured screen size
+    width = renderer::ENGINE_STATE.SCREEN_WIDTH;
+    height = renderer::ENGINE_STATE.SCREEN_HEIGHT;
+
+    if (!capture_path.empty() && !Capture::begin(capture_path, capture_frames, width, height))
+        std::cerr << "Could not capture to " << capture_path << std::endl;
+
+    if (window::init(headless, width, height, null_gl) != 0) {
         std::cerr << "Could not initialize window!" << std::endl;
         window::terminate();
+        if (headless) return -1;
     }
+
+    Capture::install();
+
+    renderer::g_Headless = headless;
+    renderer::ENGINE_STATE.UI_ENBL = renderer::ENGINE_STATE.UI_ENBL && !headless;
+    renderer::g_Engine = renderer::ENGINE_STATE;
+
     if (renderer::init() != 0) {
         std::cerr << "Could not initialize renderer!";
         renderer::terminate();
         window::terminate();
+        if (headless) return -1;
     }
     std::cout << "AFTER_RENDERER_INIT" << std::endl;
-    while(!window::should_terminate())
+
+    if (stress) {
+        if (!renderer::stress::generate(stress_options)) {
+            renderer::terminate();
+            window::terminate();
+            return -1;
+        }
+        benchmark_options.scene = renderer::stress::describe(stress_options);
+    }
+
+    int result = 0;
+
+    renderer::benchmark::SessionRecorder recorder;
+    if (!record_path.empty() && !recorder.open(record_path))
+        std::cerr << "Could not record the session to " << record_path << std::endl;
+
+    if (sweep) {
+        benchmark_options.frames = frames_set ? frames : 300;
+        if (warmup >= 0)
+            benchmark_options.warmup = warmup;
+        if (!headless)
+            benchmark_options.present = window::swap_and_poll;
+
+        sweep_options.benchmark = benchmark_options;
+        if (!report_path.empty())
+            sweep_options.report = report_path;
+
+        result = renderer::sweep::run(sweep_options);
+    }
+    else if (golden) {
+        if (frames_set)
+            golden_options.frames = frames;
+        if (warmup >= 0)
+            golden_options.warmup = warmup;
+        if (!report_path.empty())
+            golden_options.report = report_path;
+        if (!headless)
+            golden_options.present = window::swap_and_poll;
+
+        result = renderer::golden::run(golden_options);
+    }
+    else if (benchmark) {
+        if (frames_set)
+            benchmark_options.frames = frames;
+        if (warmup >= 0)
+            benchmark_options.warmup = warmup;
+        if (!report_path.empty())
+            benchmark_options.report = report_path;
+        if (!headless)
+            benchmark_options.present = window::swap_and_poll;
+
+        result = renderer::benchmark::run(benchmark_options);
+    }
+    else if (headless)
+        result = run_headless(frames, output);
+
+    while(!headless && !benchmark && !golden && !sweep && !window::should_terminate())
     {
         window::handle_input();
+        recorder.record(window::get_delta_frame());
+
+        {
+            Trace::Zone zone("Update State");
+            renderer::updateState();
+        }
 
-        renderer::updateState();
         renderer::render();
 
-        window::render_gui();
+        {
+            Trace::Zone zone("GUI", true);
+            window::render_gui();
+        }
+
+        {
+            Trace::Zone zone("Swap", true);
+            window::swap_and_poll();
+        }
+    }
+
+    Capture::end();
+
+    if (!trace_path.empty() && !Trace::write(trace_path))
+        std::cerr << "Could not write trace to " << trace_path << std::endl;
 
-        window::swap_and_poll();
+    if (null_gl) {
+        NullGL::printSummary();
+        if (!NullGL::writeReport(gl_calls_path))
+            std::cerr << "Could not write GL calls to " << gl_calls_path << std::endl;
     }
 
     renderer::terminate();
     window::terminate();
-    return 0;
+    return result;
 }